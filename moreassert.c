@@ -12,9 +12,12 @@
 
 #include "moreassert.h"
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "zstrbuf.h"
+
 void _verbose_abort(char const*const filename, const int lineno, char const*const funcname, char const* msg) {
 	if (msg == NULL) { msg = ""; }
 	fprintf(stderr, "%s: %d: %s: %s", filename, lineno, funcname, msg);
@@ -119,3 +122,18 @@ void _verbose_abort10(char const*const filename, const int lineno, char const*co
 	fprintf(stderr, "%s: %d: %s: %s%s%s%s%s%s%s%s%s%s", filename, lineno, funcname, msg1, msg2, msg3, msg4, msg5, msg6, msg7, msg8, msg9, msg10);
 	exit(EXIT_FAILURE);
 }
+
+void _verbose_abortf(char const*const filename, const int lineno, char const*const funcname, char const*const expr, char const* fmt, ...) {
+	zstrbuf b = ZLIST_INITIALIZER;
+	va_list ap;
+	if (fmt == NULL) { fmt = ""; }
+	zprintf(&b, "%s: %d: %s: ", filename, lineno, funcname);
+	if (expr != NULL) {
+		zprintf(&b, "Assertion `%s' failed.; ", expr);
+	}
+	va_start(ap, fmt);
+	zvprintf(&b, fmt, ap);
+	va_end(ap);
+	fputs(zstrbuf_cstr(&b), stderr);
+	exit(EXIT_FAILURE);
+}
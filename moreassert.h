@@ -33,6 +33,11 @@
  * first it treats any NULL pointers as empty strings, second it concatenates 
  * all the msg arguments together.  It does not do any other interpolation or 
  * processing of their contents.
+ *
+ * verbose_abortf() takes a printf-style format and arguments instead, and 
+ * formats them with zprintf() (see zstrbuf.h):
+ *
+ * void verbose_abortf(const char* fmt, ...);
  */
 
 /**
@@ -61,6 +66,14 @@
  * all the msg arguments together, inserting a separator string ("; ") between 
  * each successive pair of msgs.  It does not do any other interpolation or 
  * processing of their contents.
+ *
+ * runtime_assertf() takes a printf-style format and arguments, which are 
+ * formatted with zprintf() (see zstrbuf.h), and evaluated only if the 
+ * assertion fails:
+ *
+ * void runtime_assertf(int condition, const char* fmt, ...);
+ *
+ * runtime_assertf(i < l.len, "index %zu is past the end of a list of %zu", i, l.len);
  */
 
 #endif /* #ifndef __INCL_moreassert_h */
@@ -22,6 +22,11 @@ void _verbose_abort7(char const* filename, int lineno, char const* funcname, cha
 void _verbose_abort8(char const* filename, int lineno, char const* funcname, char const* msg1, const char* msg2, const char* msg3, const char* msg4, const char* msg5, const char* msg6, const char* msg7, const char* msg8);
 void _verbose_abort9(char const* filename, int lineno, char const* funcname, char const* msg1, const char* msg2, const char* msg3, const char* msg4, const char* msg5, const char* msg6, const char* msg7, const char* msg8, const char* msg9);
 void _verbose_abort10(char const* filename, int lineno, char const* funcname, char const* msg1, const char* msg2, const char* msg3, const char* msg4, const char* msg5, const char* msg6, const char* msg7, const char* msg8, const char* msg9, const char* msg10);
+#ifdef __GNUC__
+void _verbose_abortf(char const* filename, int lineno, char const* funcname, char const* expr, char const* fmt, ...) __attribute__((format(printf, 5, 6)));
+#else
+void _verbose_abortf(char const* filename, int lineno, char const* funcname, char const* expr, char const* fmt, ...);
+#endif
 
 #define verbose_abort(msg) ((void)(_verbose_abort(__FILE__, __LINE__,  __func__, (msg))))
 #define verbose_abort2(msg1, msg2) ((void)(_verbose_abort2(__FILE__, __LINE__,  __func__, (msg1), (msg2))))
@@ -34,7 +39,10 @@ void _verbose_abort10(char const* filename, int lineno, char const* funcname, ch
 #define verbose_abort9(msg1, msg2, msg3, msg4, msg5, msg6, msg7, msg8, msg9) ((void)(_verbose_abort9(__FILE__, __LINE__,  __func__, (msg1), (msg2), (msg3), (msg4), (msg5), (msg6), (msg7), (msg8), (msg9))))
 #define verbose_abort10(msg1, msg2, msg3, msg4, msg5, msg6, msg7, msg8, msg9, msg10) ((void)(_verbose_abort8(__FILE__, __LINE__,  __func__, (msg1), (msg2), (msg3), (msg4), (msg5), (msg6), (msg7), (msg8), (msg9), (msg10))))
 
+#define verbose_abortf(...) ((void)(_verbose_abortf(__FILE__, __LINE__,  __func__, NULL, __VA_ARGS__)))
+
 #define runtime_assert(expr, msg) ((void)((expr) ? ((void)0) : verbose_abort4("Assertion `", #expr, "' failed.; ", msg)))
 #define runtime_assert2(expr, msg1, msg2) ((void)((expr) ? ((void)0) : verbose_abort6("Assertion `", #expr, "' failed.; ", (msg1), "; ", (msg2))))
 #define runtime_assert3(expr, msg1, msg2, msg3) ((void)((expr) ? ((void)0) : verbose_abort8("Assertion `", #expr, "' failed.; ", (msg1), "; ", (msg2), "; ", (msg3))))
 #define runtime_assert4(expr, msg1, msg2, msg3, msg4) ((void)((expr) ? ((void)0) : verbose_abort10("Assertion `", #expr, "' failed.; ", (msg1), "; ", (msg2), "; ", (msg3), "; ", (msg4))))
+#define runtime_assertf(expr, ...) ((void)((expr) ? ((void)0) : _verbose_abortf(__FILE__, __LINE__,  __func__, #expr, __VA_ARGS__)))
@@ -17,8 +17,161 @@
 #include <time.h>
 #include <assert.h>
 #include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "zutil.h"
+#include "zlist.h"
+#include "zarena.h"
+#include "zhash.h"
+#include "zring.h"
+#include "zqueue.h"
+#include "zcollect.h"
+#include "zroaring.h"
+#include "zheap.h"
+#include "zbtree.h"
+#include "zbloom.h"
+#include "zpipe.h"
+#include "zstrbuf.h"
+#include "zint.h"
+
+DECLARE_ZLIST(int, zlisti)
+DEFINE_ZLIST(int, zlisti)
+DECLARE_ZLIST_CONTAINS_ITEM(int, zlisti)
+DEFINE_ZLIST_CONTAINS_ITEM(int, zlisti)
+
+DECLARE_ZLIST(long, zliststatl)
+DECLARE_ZLIST_CONTAINS_ITEM(long, zliststatl)
+DEFINE_ZLIST(long, zliststatl)
+DEFINE_ZLIST_CONTAINS_ITEM(long, zliststatl)
+
+DECLARE_ZLIST_ALIGNED(int, zlistali)
+DEFINE_ZLIST_ALIGNED(int, zlistali, 256, 0)
+DECLARE_ZLIST_CONTAINS_ITEM(int, zlistali)
+DEFINE_ZLIST_CONTAINS_ITEM(int, zlistali)
+DECLARE_ZLIST_ALIGNED(long long, zlistalhuge)
+DEFINE_ZLIST_ALIGNED(long long, zlistalhuge, 64, 1 << 20)
+DECLARE_ZLIST_SERIAL(int, zlisti)
+DEFINE_ZLIST_SERIAL(int, zlisti)
+DECLARE_ZLIST_SORTED(int, zlisti)
+DEFINE_ZLIST_SORTED(int, zlisti)
+
+DECLARE_ZLIST_ARENA(int, zlistai)
+DEFINE_ZLIST_ARENA(int, zlistai)
+DECLARE_ZLIST_CONTAINS_ITEM(int, zlistai)
+DEFINE_ZLIST_CONTAINS_ITEM(int, zlistai)
+
+DECLARE_ZLIST_SBO(int, zlistsi, 8)
+DEFINE_ZLIST_SBO(int, zlistsi, 8)
+DECLARE_ZLIST_CONTAINS_ITEM(int, zlistsi)
+DEFINE_ZLIST_CONTAINS_ITEM(int, zlistsi)
+
+DECLARE_ZLIST(unsigned char, zlistuc)
+DEFINE_ZLIST(unsigned char, zlistuc)
+DECLARE_ZLIST_SCALAR_FIND(unsigned char, zlistuc)
+DEFINE_ZLIST_SCALAR_FIND(unsigned char, zlistuc)
+DECLARE_ZLIST_SERIAL(unsigned char, zlistuc)
+DEFINE_ZLIST_SERIAL(unsigned char, zlistuc)
+
+DECLARE_ZLIST(short, zlists)
+DEFINE_ZLIST(short, zlists)
+DECLARE_ZLIST_SCALAR_FIND(short, zlists)
+DEFINE_ZLIST_SCALAR_FIND(short, zlists)
+
+DECLARE_ZLIST(unsigned, zlistu)
+DEFINE_ZLIST(unsigned, zlistu)
+DECLARE_ZLIST_SCALAR_FIND(unsigned, zlistu)
+DEFINE_ZLIST_SCALAR_FIND(unsigned, zlistu)
+
+DECLARE_ZLIST(long long, zlistll)
+DEFINE_ZLIST(long long, zlistll)
+DECLARE_ZLIST_SCALAR_FIND(long long, zlistll)
+DEFINE_ZLIST_SCALAR_FIND(long long, zlistll)
+DECLARE_ZLIST_SERIAL(long long, zlistll)
+DEFINE_ZLIST_SERIAL(long long, zlistll)
+
+typedef void* voidp;
+DECLARE_ZLIST(voidp, zlistp)
+DEFINE_ZLIST(voidp, zlistp)
+DECLARE_ZLIST_SCALAR_FIND(voidp, zlistp)
+DEFINE_ZLIST_SCALAR_FIND(voidp, zlistp)
+
+DECLARE_ZLIST_RADIX_SORT(int, zlisti)
+DEFINE_ZLIST_RADIX_SORT(int, zlisti)
+DECLARE_ZLIST_RADIX_SORT(short, zlists)
+DEFINE_ZLIST_RADIX_SORT(short, zlists)
+DECLARE_ZLIST_RADIX_SORT(unsigned char, zlistuc)
+DEFINE_ZLIST_RADIX_SORT(unsigned char, zlistuc)
+DECLARE_ZLIST_RADIX_SORT(long long, zlistll)
+DEFINE_ZLIST_RADIX_SORT(long long, zlistll)
+DECLARE_ZLIST_SLICE(int, zlisti)
+DEFINE_ZLIST_SLICE(int, zlisti)
+DECLARE_ZLIST_SLICE(unsigned char, zlistuc)
+DEFINE_ZLIST_SLICE(unsigned char, zlistuc)
+DECLARE_ZLIST_SORT(unsigned, zlistu)
+DEFINE_ZLIST_SORT(unsigned, zlistu, ZLIST_LESS)
+
+typedef struct {
+	int key;
+	int seq;
+} _test_pair;
+#define _TEST_PAIR_GREATER(a, b) ((a).key > (b).key)
+DECLARE_ZLIST(_test_pair, zlistpair)
+DEFINE_ZLIST(_test_pair, zlistpair)
+DECLARE_ZLIST_SORT(_test_pair, zlistpair)
+DEFINE_ZLIST_SORT(_test_pair, zlistpair, _TEST_PAIR_GREATER)
+
+DECLARE_ZLIST_SEGMENTED(long, zlistsegl, 4)
+DEFINE_ZLIST_SEGMENTED(long, zlistsegl)
+#define _TEST_SOA_FIELDS(F) F(double, x) F(double, y) F(int, id) F(char, tag)
+DECLARE_ZLIST_SOA(_TEST_SOA_FIELDS, zlistsoa)
+DEFINE_ZLIST_SOA(_TEST_SOA_FIELDS, zlistsoa)
+DECLARE_ZLIST_MMAP(long, zlistml)
+DEFINE_ZLIST_MMAP(long, zlistml)
+
+DECLARE_ZRING(unsigned long, zringul)
+DEFINE_ZRING(unsigned long, zringul)
+DECLARE_ZQUEUE(unsigned long, zqueueul)
+DEFINE_ZQUEUE(unsigned long, zqueueul)
+DECLARE_ZCOLLECT(int, zlisti, zcollecti)
+DEFINE_ZCOLLECT(int, zlisti, zcollecti)
+DECLARE_ZHEAP(int, zheapi, 4)
+DEFINE_ZHEAP(int, zheapi, 4, ZHEAP_LESS)
+DECLARE_ZHEAP(int, zheapi2, 2)
+DEFINE_ZHEAP(int, zheapi2, 2, ZHEAP_LESS)
+#define _TEST_GREATER(a, b) ((a) > (b))
+DECLARE_ZHEAP(int, zheapmax8, 8)
+DEFINE_ZHEAP(int, zheapmax8, 8, _TEST_GREATER)
+
+typedef struct {
+	size_t id;
+	double dist;
+} _test_node;
+#define _TEST_NODE_LESS(a, b) ((a).dist < (b).dist)
+#define _TEST_NODE_ID(a) ((a).id)
+DECLARE_ZHEAP_INDEXED(_test_node, zheapnode, 4)
+DEFINE_ZHEAP_INDEXED(_test_node, zheapnode, 4, _TEST_NODE_LESS, _TEST_NODE_ID)
+DECLARE_ZBTREE(int, int, zbtreeii)
+DEFINE_ZBTREE(int, int, zbtreeii)
+DECLARE_ZBTREE(unsigned long long, int, zbtreeulli)
+DEFINE_ZBTREE(unsigned long long, int, zbtreeulli)
+DECLARE_ZBTREE(short, int, zbtreesi)
+DEFINE_ZBTREE(short, int, zbtreesi)
+
+#define ZHASH_TEST_HASH(k) zhash_u64(k)
+DECLARE_ZHASH(unsigned long, int, zhashuli)
+DEFINE_ZHASH(unsigned long, int, zhashuli, ZHASH_TEST_HASH, ZHASH_EQ)
+
+/* A deliberately terrible hash, to exercise long probe runs and wraparound. */
+#define ZHASH_TEST_BADHASH(k) ((size_t)((k) % 8) << 7 | ((k) % 3))
+DECLARE_ZHASHSET(int, zhashsetbad)
+DEFINE_ZHASHSET(int, zhashsetbad, ZHASH_TEST_BADHASH, ZHASH_EQ)
 
 #ifdef NDEBUG
 #warning You are compiling test.c with NDEBUG set, and since the tests use assert() to verify the results, this means the tests will pass even if the code is wrong.
@@ -1378,6 +1531,3347 @@ void print_morelimits() {
 	printf("Z_UINT64_MAX:                  %40llu\n", Z_UINT64_MAX);
 }
 
+int test_zlist_growth() {
+	zlisti l = ZLIST_INITIALIZER;
+	zlisti legacy;
+	int i;
+	int* oldarr;
+
+	for (i = 0; i < 1000; i++) {
+		zlisti_append(&l, i);
+	}
+	assert (l.len == 1000);
+	assert (l.cap >= l.len);
+	for (i = 0; i < 1000; i++) {
+		assert (l.arr[i] == i);
+	}
+	assert (zlisti_contains_item(l, 999));
+	assert (!zlisti_contains_item(l, 1000));
+
+	zlisti_clear(&l);
+	assert (l.len == 0);
+	assert (l.cap >= 1000);
+	oldarr = l.arr;
+	zlisti_append(&l, 7);
+	assert (l.arr == oldarr);
+	(void)oldarr;
+	assert (l.arr[0] == 7);
+
+	zlisti_shrink_to_fit(&l);
+	assert (l.cap == 1);
+	assert (l.arr[0] == 7);
+
+	zlisti_reserve(&l, 100);
+	assert (l.cap == 100);
+	assert (l.len == 1);
+	oldarr = l.arr;
+	for (i = 1; i < 100; i++) {
+		zlisti_append(&l, i);
+	}
+	assert (l.arr == oldarr);
+
+	zlisti_resize(&l, 10);
+	assert (l.len == 10);
+	assert (l.cap == 100);
+
+	zlisti_free(&l);
+	assert (l.arr == NULL);
+	assert (l.len == 0);
+	assert (l.cap == 0);
+	zlisti_free(&l);
+
+	/* Old-style initialization, leaving cap with a garbage value. */
+	legacy.cap = 12345;
+	legacy.len = 0;
+	legacy.arr = NULL;
+	zlisti_append(&legacy, 1);
+	zlisti_append(&legacy, 2);
+	assert (legacy.len == 2);
+	assert (legacy.arr[0] == 1 && legacy.arr[1] == 2);
+	zlisti_free(&legacy);
+
+	return 0;
+}
+
+int test_zlist_segmented() {
+	zlistsegl l = ZLIST_SEGMENTED_INITIALIZER;
+	long* first;
+	long* seventeenth;
+	long i;
+
+	zlistsegl_append(&l, 0);
+	first = zlistsegl_at(&l, 0);
+	for (i = 1; i < 1000; i++) {
+		zlistsegl_append(&l, i);
+		if (i == 16) {
+			seventeenth = zlistsegl_at(&l, 16);
+		}
+	}
+	assert (l.len == 1000);
+	assert (l.nchunks == 1000 / 16 + 1);
+	/* Growing never moved anything. */
+	assert (zlistsegl_at(&l, 0) == first);
+	assert (zlistsegl_at(&l, 16) == seventeenth);
+	for (i = 0; i < 1000; i++) {
+		assert (zlistsegl_get(&l, i) == i);
+		assert (*ZLIST_SEGMENTED_AT(zlistsegl, l, i) == i);
+	}
+	zlistsegl_set(&l, 999, -1);
+	assert (zlistsegl_get(&l, 999) == -1);
+
+	zlistsegl_clear(&l);
+	assert (l.len == 0 && l.nchunks > 0);
+	zlistsegl_append(&l, 5);
+	assert (zlistsegl_at(&l, 0) == first);
+
+	zlistsegl_resize(&l, 33);
+	assert (l.len == 33 && l.nchunks >= 3);
+	zlistsegl_free(&l);
+	assert (l.len == 0 && l.chunks == NULL);
+	zlistsegl_free(&l);
+	(void)first; (void)seventeenth;
+	return 0;
+}
+
+#define ZRING_TEST_N 1000000UL
+
+void* _test_zring_producer(void* arg) {
+	zringul* const r = (zringul*)arg;
+	unsigned long next = 0;
+	unsigned long batch[7];
+	size_t i, k, n;
+	while (next < ZRING_TEST_N) {
+		if (next % 3 == 0) {
+			for (k = 0; (k < 7) && (next + k < ZRING_TEST_N); k++) {
+				batch[k] = next + k;
+			}
+			i = 0;
+			while (i < k) {
+				n = zringul_push_n(r, batch + i, k - i);
+				if (n == 0) { sched_yield(); }
+				i += n;
+			}
+			next += k;
+		} else {
+			while (!zringul_try_push(r, next)) { sched_yield(); }
+			next++;
+		}
+	}
+	return NULL;
+}
+
+int test_zring() {
+	zringul r;
+	unsigned long x;
+	unsigned long items[10];
+	const unsigned long abc[] = { 1, 2, 3, 4, 5, 6 };
+	unsigned long expect;
+	size_t i, n;
+	int ok;
+	pthread_t t;
+
+	zringul_init(&r, 5);
+	assert (r.mask == 7);
+	assert (((size_t)&r.tail) - ((size_t)&r.head) >= ZRING_CACHELINE);
+	ok = zringul_try_pop(&r, &x);
+	assert (!ok);
+	for (i = 0; i < 8; i++) {
+		ok = zringul_try_push(&r, i);
+		assert (ok);
+	}
+	ok = zringul_try_push(&r, 8);
+	assert (!ok);
+	assert (zringul_size(&r) == 8);
+	for (i = 0; i < 5; i++) {
+		ok = zringul_try_pop(&r, &x);
+		assert (ok && x == i);
+	}
+	/* this batch wraps around the end of the buffer */
+	n = zringul_push_n(&r, abc, 6);
+	assert (n == 5);
+	n = zringul_pop_n(&r, items, 10);
+	assert (n == 8);
+	assert (items[0] == 5 && items[2] == 7 && items[3] == 1 && items[7] == 5);
+	n = zringul_pop_n(&r, items, 10);
+	assert (n == 0);
+	zringul_free(&r);
+	(void)ok;
+
+	zringul_init(&r, 64);
+	pthread_create(&t, NULL, _test_zring_producer, &r);
+	expect = 0;
+	while (expect < ZRING_TEST_N) {
+		if (expect % 2 == 0) {
+			n = zringul_pop_n(&r, items, 10);
+			for (i = 0; i < n; i++) {
+				assert (items[i] == expect);
+				expect++;
+			}
+			if (n == 0) { sched_yield(); }
+		} else if (zringul_try_pop(&r, &x)) {
+			assert (x == expect);
+			expect++;
+		} else {
+			sched_yield();
+		}
+	}
+	pthread_join(t, NULL);
+	assert (zringul_size(&r) == 0);
+	zringul_free(&r);
+	return 0;
+}
+
+#define ZQUEUE_TEST_THREADS 4
+#define ZQUEUE_TEST_N 100000UL
+
+typedef struct {
+	zqueueul* q;
+	unsigned long first;
+	unsigned char* seen;
+} _test_zqueue_args;
+
+void* _test_zqueue_producer(void* arg) {
+	_test_zqueue_args* const a = (_test_zqueue_args*)arg;
+	unsigned long i;
+	for (i = a->first; i < a->first + ZQUEUE_TEST_N; i++) {
+		if (i % 2) {
+			zqueueul_push(a->q, i);
+		} else {
+			while (!zqueueul_try_push(a->q, i)) { sched_yield(); }
+		}
+	}
+	return NULL;
+}
+
+void* _test_zqueue_consumer(void* arg) {
+	_test_zqueue_args* const a = (_test_zqueue_args*)arg;
+	unsigned long i, x;
+	for (i = 0; i < ZQUEUE_TEST_N; i++) {
+		zqueueul_pop(a->q, &x);
+		a->seen[x]++;
+	}
+	return NULL;
+}
+
+int test_zqueue() {
+	zqueueul q;
+	unsigned long x;
+	size_t i;
+	_test_zqueue_args args[ZQUEUE_TEST_THREADS];
+	pthread_t producers[ZQUEUE_TEST_THREADS];
+	pthread_t consumers[ZQUEUE_TEST_THREADS];
+	unsigned char* seen;
+	bool ok;
+
+	zqueueul_init(&q, 3);
+	assert (q.mask == 3);
+	assert (((size_t)&q.deq) - ((size_t)&q.enq) >= ZQUEUE_CACHELINE);
+	ok = zqueueul_try_pop(&q, &x);
+	assert (!ok);
+	for (i = 0; i < 4; i++) {
+		ok = zqueueul_try_push(&q, i);
+		assert (ok);
+	}
+	ok = zqueueul_try_push(&q, 4);
+	assert (!ok);
+	for (i = 0; i < 2; i++) {
+		zqueueul_pop(&q, &x);
+		assert (x == i);
+	}
+	zqueueul_push(&q, 4);
+	zqueueul_push(&q, 5);
+	for (i = 2; i < 6; i++) {
+		ok = zqueueul_try_pop(&q, &x);
+		assert (ok && x == i);
+	}
+	ok = zqueueul_try_pop(&q, &x);
+	assert (!ok);
+	zqueueul_free(&q);
+
+	/* a small queue, so that both sides keep going to sleep */
+	seen = (unsigned char*)calloc(ZQUEUE_TEST_THREADS * ZQUEUE_TEST_N, 1);
+	assert (seen != NULL);
+	zqueueul_init(&q, 8);
+	for (i = 0; i < ZQUEUE_TEST_THREADS; i++) {
+		args[i].q = &q;
+		args[i].first = i * ZQUEUE_TEST_N;
+		args[i].seen = seen;
+		pthread_create(&consumers[i], NULL, _test_zqueue_consumer, &args[i]);
+	}
+	for (i = 0; i < ZQUEUE_TEST_THREADS; i++) {
+		pthread_create(&producers[i], NULL, _test_zqueue_producer, &args[i]);
+	}
+	for (i = 0; i < ZQUEUE_TEST_THREADS; i++) {
+		pthread_join(producers[i], NULL);
+		pthread_join(consumers[i], NULL);
+	}
+	for (i = 0; i < ZQUEUE_TEST_THREADS * ZQUEUE_TEST_N; i++) {
+		assert (seen[i] == 1);
+	}
+	ok = zqueueul_try_pop(&q, &x);
+	assert (!ok);
+	zqueueul_free(&q);
+	free(seen);
+	(void)ok;
+	return 0;
+}
+
+#define ZCOLLECT_TEST_THREADS 4
+#define ZCOLLECT_TEST_N 5000
+
+typedef struct {
+	zcollecti* c;
+	size_t tid;
+} _test_zcollect_args;
+
+void* _test_zcollect_worker(void* arg) {
+	_test_zcollect_args* const a = (_test_zcollect_args*)arg;
+	int i;
+	for (i = 0; i < ZCOLLECT_TEST_N; i++) {
+		zcollecti_append(a->c, a->tid, (int)a->tid * 100000 + i);
+	}
+	return NULL;
+}
+
+/* Checks that l holds items from every thread, each thread's in order. */
+int _test_zcollect_check(const zlisti* l, size_t from) {
+	int next[ZCOLLECT_TEST_THREADS] = { 0 };
+	size_t i;
+	int t;
+	if (l->len != from + ZCOLLECT_TEST_THREADS * ZCOLLECT_TEST_N) { return 0; }
+	for (i = from; i < l->len; i++) {
+		t = l->arr[i] / 100000;
+		if ((t < 0) || (t >= ZCOLLECT_TEST_THREADS) || (l->arr[i] % 100000 != next[t]++)) { return 0; }
+	}
+	return 1;
+}
+
+void _test_zcollect_fill(zcollecti* c) {
+	_test_zcollect_args args[ZCOLLECT_TEST_THREADS];
+	pthread_t threads[ZCOLLECT_TEST_THREADS];
+	size_t i;
+	for (i = 0; i < ZCOLLECT_TEST_THREADS; i++) {
+		args[i].c = c;
+		args[i].tid = i;
+		pthread_create(&threads[i], NULL, _test_zcollect_worker, &args[i]);
+	}
+	for (i = 0; i < ZCOLLECT_TEST_THREADS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+}
+
+int test_zcollect() {
+	zcollecti c;
+	zlisti l = ZLIST_INITIALIZER;
+	size_t i;
+
+	zcollecti_init(&c, ZCOLLECT_TEST_THREADS);
+	assert (((size_t)zcollecti_local(&c, 1)) - ((size_t)zcollecti_local(&c, 0)) >= ZCOLLECT_CACHELINE);
+	assert (((size_t)c.slots) % ZCOLLECT_CACHELINE == 0);
+
+	/* ordered, onto a list which already has something in it */
+	zlisti_append(&l, -1);
+	_test_zcollect_fill(&c);
+	assert (zcollecti_len(&c) == ZCOLLECT_TEST_THREADS * ZCOLLECT_TEST_N);
+	zcollecti_merge(&c, &l, 1, 1);
+	assert (zcollecti_len(&c) == 0);
+	assert (l.arr[0] == -1);
+	assert (_test_zcollect_check(&l, 1));
+	for (i = 1; i < l.len; i++) {
+		assert (l.arr[i] == (int)((i - 1) / ZCOLLECT_TEST_N * 100000 + (i - 1) % ZCOLLECT_TEST_N));
+	}
+
+	/* ordered, copied by several threads */
+	zlisti_clear(&l);
+	_test_zcollect_fill(&c);
+	zcollecti_merge(&c, &l, 1, 3);
+	assert (_test_zcollect_check(&l, 0));
+	for (i = 0; i < l.len; i++) {
+		assert (l.arr[i] == (int)(i / ZCOLLECT_TEST_N * 100000 + i % ZCOLLECT_TEST_N));
+	}
+
+	/* unordered into an empty list adopts the biggest private array */
+	zlisti_clear(&l);
+	_test_zcollect_fill(&c);
+	zcollecti_append(&c, 2, 200000 + ZCOLLECT_TEST_N);
+	zcollecti_merge(&c, &l, 0, 2);
+	assert (l.len == ZCOLLECT_TEST_THREADS * ZCOLLECT_TEST_N + 1);
+	assert (l.arr[0] == 200000);
+	assert (zcollecti_local(&c, 2)->arr == NULL);
+
+	zcollecti_merge(&c, &l, 0, 1);
+	assert (l.len == ZCOLLECT_TEST_THREADS * ZCOLLECT_TEST_N + 1);
+	zcollecti_free(&c);
+	zlisti_free(&l);
+	return 0;
+}
+
+#define ZLIST_MMAP_TEST_FILE "test_zlist_mmap.tmp"
+
+int test_zlist_mmap() {
+	zlistml l, r;
+	long i;
+	const long more[] = { -1, -2, -3 };
+	bool ok;
+	FILE* f;
+
+	remove(ZLIST_MMAP_TEST_FILE);
+	ok = zlistml_open(&r, ZLIST_MMAP_TEST_FILE, 1);
+	assert (!ok); /* doesn't exist, and read-only doesn't create it */
+	ok = zlistml_open(&l, ZLIST_MMAP_TEST_FILE, 0);
+	assert (ok);
+	assert (l.len == 0);
+	for (i = 0; i < 100000; i++) {
+		zlistml_append(&l, i * 3);
+	}
+	zlistml_sync(&l);
+
+	/* a reader sees the checkpoint while the writer keeps going */
+	ok = zlistml_open(&r, ZLIST_MMAP_TEST_FILE, 1);
+	assert (ok);
+	assert (r.len == 100000);
+	assert (r.arr[0] == 0 && r.arr[99999] == 99999 * 3);
+#ifdef __linux__
+	{
+		/* changing a read-only list fails a runtime_assert, not a SIGSEGV */
+		int status;
+		pid_t pid;
+		fflush(stderr);
+		pid = fork();
+		if (pid == 0) {
+			freopen("/dev/null", "w", stderr);
+			zlistml_swap_remove(&r, 0);
+			_exit(0);
+		}
+		waitpid(pid, &status, 0);
+		assert (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_FAILURE));
+		(void)status;
+	}
+#endif
+	zlistml_close(&r);
+
+	zlistml_extend(&l, more, 3);
+	zlistml_erase_range(&l, 0, 1);
+	zlistml_close(&l);
+	zlistml_close(&l);
+
+	f = fopen(ZLIST_MMAP_TEST_FILE, "rb");
+	assert (f != NULL);
+	fseek(f, 0, SEEK_END);
+	assert (ftell(f) == (long)(ZLIST_MMAP_HEADER + 100002 * sizeof(long)));
+	fclose(f);
+
+	ok = zlistml_open(&l, ZLIST_MMAP_TEST_FILE, 0);
+	assert (ok);
+	assert (l.len == 100002);
+	assert (l.arr[0] == 3 && l.arr[99998] == 99999 * 3 && l.arr[100001] == -3);
+	zlistml_append(&l, 7);
+	assert (l.arr[100002] == 7);
+	zlistml_close(&l);
+
+	/* a file which isn't a list is refused */
+	ok = zlistml_open(&l, "GNUmakefile", 1);
+	assert (!ok);
+	remove(ZLIST_MMAP_TEST_FILE);
+	(void)ok;
+	return 0;
+}
+
+static int _test_cmp_int(const void* a, const void* b) {
+	const int x = *(const int*)a, y = *(const int*)b;
+	return (x > y) - (x < y);
+}
+
+static int _test_cmp_ll(const void* a, const void* b) {
+	const long long x = *(const long long*)a, y = *(const long long*)b;
+	return (x > y) - (x < y);
+}
+
+static int _test_cmp_unsigned(const void* a, const void* b) {
+	const unsigned x = *(const unsigned*)a, y = *(const unsigned*)b;
+	return (x > y) - (x < y);
+}
+
+int test_zlist_sort() {
+	const size_t sizes[] = { 0, 1, 2, 3, 7, 16, 17, 63, 64, 100, 1000, 200000 };
+	zlisti li = ZLIST_INITIALIZER;
+	zlistll lll = ZLIST_INITIALIZER;
+	zlistu lu = ZLIST_INITIALIZER;
+	zlists ls = ZLIST_INITIALIZER;
+	zlistuc luc = ZLIST_INITIALIZER;
+	zlistpair lp = ZLIST_INITIALIZER;
+	_test_pair pr;
+	int* expi;
+	long long* expll;
+	unsigned* expu;
+	unsigned long long x = 12345;
+	size_t si, i, n, dist, mt;
+
+	for (si = 0; si < sizeof(sizes) / sizeof(sizes[0]); si++) {
+		n = sizes[si];
+		/* uniform, narrow range, already sorted, all equal */
+		for (dist = 0; dist < 4; dist++) {
+			zlisti_resize(&li, n);
+			zlistll_resize(&lll, n);
+			zlistu_resize(&lu, n);
+			for (i = 0; i < n; i++) {
+				x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+				switch (dist) {
+				case 0: lll.arr[i] = (long long)x; break;
+				case 1: lll.arr[i] = (long long)(x >> 60) - 8; break;
+				case 2: lll.arr[i] = (long long)i; break;
+				default: lll.arr[i] = -5; break;
+				}
+				li.arr[i] = (int)lll.arr[i];
+				lu.arr[i] = (unsigned)lll.arr[i];
+			}
+			expi = (int*)malloc(sizeof(int) * n + 1);
+			expll = (long long*)malloc(sizeof(long long) * n + 1);
+			expu = (unsigned*)malloc(sizeof(unsigned) * n + 1);
+			assert (expi != NULL && expll != NULL && expu != NULL);
+			if (n > 0) {
+				memcpy(expi, li.arr, sizeof(int) * n);
+				memcpy(expll, lll.arr, sizeof(long long) * n);
+				memcpy(expu, lu.arr, sizeof(unsigned) * n);
+			}
+			qsort(expi, n, sizeof(int), _test_cmp_int);
+			qsort(expll, n, sizeof(long long), _test_cmp_ll);
+			qsort(expu, n, sizeof(unsigned), _test_cmp_unsigned);
+			mt = (n == 200000) ? 3 : 1;
+			zlisti_sort_mt(&li, mt);
+			zlistll_sort_mt(&lll, mt);
+			zlistu_sort(&lu);
+			assert ((n == 0) || (memcmp(li.arr, expi, sizeof(int) * n) == 0));
+			assert ((n == 0) || (memcmp(lll.arr, expll, sizeof(long long) * n) == 0));
+			assert ((n == 0) || (memcmp(lu.arr, expu, sizeof(unsigned) * n) == 0));
+			free(expi);
+			free(expll);
+			free(expu);
+		}
+	}
+
+	for (i = 0; i < 1000; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zlists_append(&ls, (short)(x >> 48));
+		zlistuc_append(&luc, (unsigned char)(x >> 56));
+	}
+	zlists_sort(&ls);
+	zlistuc_sort(&luc);
+	for (i = 1; i < 1000; i++) {
+		assert (ls.arr[i-1] <= ls.arr[i]);
+		assert (luc.arr[i-1] <= luc.arr[i]);
+	}
+	assert (ls.arr[0] < 0);
+
+	/* a struct, in descending order of key */
+	for (i = 0; i < 5000; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		pr.key = (int)(x >> 54);
+		pr.seq = (int)i;
+		zlistpair_append(&lp, pr);
+	}
+	zlistpair_sort(&lp);
+	for (i = 1; i < lp.len; i++) {
+		assert (lp.arr[i-1].key >= lp.arr[i].key);
+	}
+	/* just the middle of it, ascending this time */
+	zlistu_resize(&lu, 100);
+	for (i = 0; i < 100; i++) {
+		lu.arr[i] = (unsigned)(100 - i);
+	}
+	zlistu_sort_range(lu.arr + 10, 50);
+	assert (lu.arr[9] == 91 && lu.arr[10] == 41 && lu.arr[59] == 90 && lu.arr[60] == 40);
+
+	zlisti_free(&li);
+	zlistll_free(&lll);
+	zlistu_free(&lu);
+	zlists_free(&ls);
+	zlistuc_free(&luc);
+	zlistpair_free(&lp);
+	return 0;
+}
+
+int test_zlist_soa() {
+	zlistsoa l = ZLIST_SOA_INITIALIZER;
+	zlistsoa_row row;
+	size_t i;
+	double sum;
+
+	for (i = 0; i < 1000; i++) {
+		row.x = (double)i;
+		row.y = -(double)i;
+		row.id = (int)i * 2;
+		row.tag = (char)('a' + i % 26);
+		zlistsoa_append(&l, row);
+	}
+	assert (l.len == 1000 && l.cap >= 1000);
+	assert (l.x[10] == 10.0 && l.y[10] == -10.0 && l.id[10] == 20 && l.tag[10] == 'k');
+	row = zlistsoa_get(&l, 999);
+	assert (row.x == 999.0 && row.id == 1998 && row.tag == 'a' + 999 % 26);
+	row.id = -1;
+	zlistsoa_set(&l, 3, row);
+	assert (l.id[3] == -1 && l.x[3] == 999.0 && l.x[4] == 4.0);
+	zlistsoa_swap_remove(&l, 0);
+	assert (l.len == 999 && l.id[0] == 1998 && l.y[0] == -999.0);
+	sum = 0;
+	for (i = 0; i < l.len; i++) {
+		sum += l.x[i];
+	}
+	assert (sum == 999.0 * 1000 / 2 + 999.0 - 3.0);
+
+	zlistsoa_resize(&l, 5);
+	assert (l.len == 5 && l.tag[4] == 'e');
+	zlistsoa_reserve(&l, 5000);
+	assert (l.cap == 5000 && l.len == 5 && l.x[1] == 1.0);
+	zlistsoa_clear(&l);
+	assert (l.len == 0 && l.cap == 5000);
+	zlistsoa_free(&l);
+	assert (l.x == NULL && l.tag == NULL && l.cap == 0);
+	zlistsoa_free(&l);
+	return 0;
+}
+
+#define ZROARING_TEST_RANGE (1UL << 20)
+
+/* Checks that iterating r gives exactly the members of ref, in order. */
+int _test_zroaring_matches(const zroaring* r, const unsigned char* ref) {
+	zroaring_iter it;
+	uint32_t x, prev = 0;
+	unsigned long n = 0, expected = 0, i;
+	for (i = 0; i < ZROARING_TEST_RANGE; i++) {
+		expected += ref[i];
+	}
+	zroaring_iter_init(&it, r);
+	while (zroaring_iter_next(&it, &x)) {
+		if ((x >= ZROARING_TEST_RANGE) || !ref[x] || ((n > 0) && (x <= prev))) { return 0; }
+		prev = x;
+		n++;
+	}
+	return (n == expected) && (zroaring_cardinality(r) == expected);
+}
+
+int test_zroaring() {
+	zroaring a = ZROARING_INITIALIZER;
+	zroaring b = ZROARING_INITIALIZER;
+	zroaring c = ZROARING_INITIALIZER;
+	zroaring v;
+	unsigned char* ra = (unsigned char*)calloc(ZROARING_TEST_RANGE, 1);
+	unsigned char* rb = (unsigned char*)calloc(ZROARING_TEST_RANGE, 1);
+	unsigned char* rc = (unsigned char*)malloc(ZROARING_TEST_RANGE);
+	unsigned long long rnd = 7;
+	unsigned long i, rank, k;
+	uint32_t x;
+	zbyte* buf;
+	zbyte* unaligned;
+	size_t size;
+	int round, op;
+	bool added, ok;
+
+	assert (ra != NULL && rb != NULL && rc != NULL);
+	for (i = 0; i < ZROARING_TEST_RANGE; i++) {
+		rnd = rnd * 6364136223846793005ULL + 1442695040888963407ULL;
+		if (i < (4UL << 16)) {
+			/* sparse: array containers */
+			ra[i] = ((rnd >> 33) % 100) == 0;
+			rb[i] = ((rnd >> 45) % 50) == 0;
+		} else if (i < (8UL << 16)) {
+			/* dense: bitmap containers */
+			ra[i] = ((rnd >> 33) % 2) == 0;
+			rb[i] = ((rnd >> 45) % 3) != 0;
+		} else {
+			/* long stretches: run containers after run_optimize() */
+			ra[i] = ((i >> 9) % 3) == 0;
+			rb[i] = ((i >> 7) % 2) == 0;
+		}
+	}
+	for (i = 0; i < ZROARING_TEST_RANGE; i++) {
+		if (ra[i]) {
+			added = zroaring_add(&a, (uint32_t)i);
+			assert (added);
+		}
+		if (rb[i]) { zroaring_add(&b, (uint32_t)i); }
+	}
+	added = zroaring_add(&a, 3);
+	assert (added == !ra[3]);
+	ra[3] = 1;
+	assert (_test_zroaring_matches(&a, ra));
+	assert (_test_zroaring_matches(&b, rb));
+	assert (a.cs[0].type == ZROARING_ARRAY && a.cs[5].type == ZROARING_BITMAP);
+
+	for (round = 0; round < 2; round++) {
+		if (round == 1) {
+			zroaring_run_optimize(&a);
+			zroaring_run_optimize(&b);
+			assert (a.cs[10].type == ZROARING_RUN && b.cs[10].type == ZROARING_RUN);
+			assert (a.cs[0].type == ZROARING_ARRAY && a.cs[5].type == ZROARING_BITMAP);
+			assert (_test_zroaring_matches(&a, ra));
+		}
+		for (op = 0; op < 4; op++) {
+			for (i = 0; i < ZROARING_TEST_RANGE; i++) {
+				rc[i] = (op == 0) ? (ra[i] & rb[i]) : (op == 1) ? (ra[i] | rb[i]) : (op == 2) ? (ra[i] & !rb[i]) : (ra[i] ^ rb[i]);
+			}
+			switch (op) {
+			case 0: zroaring_and(&c, &a, &b); break;
+			case 1: zroaring_or(&c, &a, &b); break;
+			case 2: zroaring_andnot(&c, &a, &b); break;
+			default: zroaring_xor(&c, &a, &b); break;
+			}
+			assert (_test_zroaring_matches(&c, rc));
+			if (op == 0) {
+				assert (zroaring_and_cardinality(&a, &b) == zroaring_cardinality(&c));
+				assert (zroaring_and_cardinality(&b, &a) == zroaring_cardinality(&c));
+			}
+		}
+		/* rank and select against a running count */
+		rank = 0;
+		for (i = 0; i < ZROARING_TEST_RANGE; i++) {
+			rank += ra[i];
+			if (i % 997 == 0) {
+				assert (zroaring_rank(&a, (uint32_t)i) == rank);
+				assert (zroaring_contains(&a, (uint32_t)i) == ra[i]);
+				if (ra[i]) {
+					ok = zroaring_select(&a, rank - 1, &x);
+					assert (ok && x == i);
+				}
+			}
+		}
+		ok = zroaring_select(&a, rank, &x);
+		assert (!ok);
+	}
+
+	/* adding to a run container and emptying containers */
+	zroaring_add(&a, 8UL << 16 | 600);
+	ra[8UL << 16 | 600] = 1;
+	for (i = 4UL << 16; i < (5UL << 16); i++) {
+		zroaring_remove(&a, (uint32_t)i);
+		ra[i] = 0;
+	}
+	for (i = (5UL << 16); i < (5UL << 16) + 62000; i++) {
+		zroaring_remove(&a, (uint32_t)i);
+		ra[i] = 0;
+	}
+	ok = zroaring_remove(&a, 5UL << 16);
+	assert (!ok);
+	assert (_test_zroaring_matches(&a, ra));
+	assert (a.cs[4].key == 5 && a.cs[4].type == ZROARING_ARRAY);
+
+	/* serialize, and read it back in place and from an unaligned copy */
+	zroaring_run_optimize(&a);
+	size = zroaring_serialized_size(&a);
+	buf = (zbyte*)malloc(size + 1);
+	assert (buf != NULL);
+	zroaring_serialize(&a, buf);
+	ok = zroaring_view(&v, buf, size);
+	assert (ok);
+	assert (v.readonly && v.len == a.len && !v.cs[0].owned);
+	assert (_test_zroaring_matches(&v, ra));
+	zroaring_and(&c, &v, &b);
+	assert (zroaring_and_cardinality(&a, &b) == zroaring_cardinality(&c));
+	zroaring_free(&v);
+	unaligned = buf + 1;
+	memmove(unaligned, buf, size);
+	ok = zroaring_view(&v, unaligned, size);
+	assert (ok);
+	assert (v.cs[0].owned);
+	assert (_test_zroaring_matches(&v, ra));
+	zroaring_free(&v);
+	ok = zroaring_view(&v, unaligned, size - 1);
+	assert (!ok);
+	unaligned[0] ^= 1;
+	ok = zroaring_view(&v, unaligned, size);
+	assert (!ok);
+	free(buf);
+
+	/* containers whose contents disagree with the directory are refused */
+	zroaring_free(&a);
+	for (i = 0; i < 3; i++) {
+		zroaring_add(&a, (uint32_t)i * 2);
+	}
+	for (i = 0; i < 10; i++) {
+		zroaring_add(&a, (uint32_t)((1UL << 16) | i));
+		zroaring_add(&a, (uint32_t)((1UL << 16) | (i + 20)));
+	}
+	for (i = 0; i < 8192; i++) {
+		zroaring_add(&a, (uint32_t)((2UL << 16) | (i * 2)));
+	}
+	zroaring_run_optimize(&a);
+	assert (a.len == 3 && a.cs[0].type == ZROARING_ARRAY && a.cs[1].type == ZROARING_RUN && a.cs[2].type == ZROARING_BITMAP);
+	size = zroaring_serialized_size(&a);
+	buf = (zbyte*)malloc(size);
+	assert (buf != NULL);
+	for (k = 0; k < 6; k++) {
+		zroaring_serialize(&a, buf);
+		/* the payloads: array at 56, runs at 64, bitmap at 72 */
+		switch (k) {
+		case 0: break;
+		case 1: buf[56] = 4; break; /* array values out of order */
+		case 2: buf[58] = 0; break; /* array values repeated */
+		case 3: buf[68] = 5; break; /* second run overlaps the first */
+		case 4: buf[70] = 10; break; /* runs add up to more than card */
+		default: buf[72] ^= 2; break; /* bitmap has one more bit than card */
+		}
+		ok = zroaring_view(&v, buf, size);
+		assert (ok == (k == 0));
+		zroaring_free(&v);
+	}
+	zroaring_serialize(&a, buf);
+	buf[68] = 0xFA; buf[69] = 0xFF;
+	ok = zroaring_view(&v, buf, size);
+	assert (!ok); /* second run goes past 65535 */
+
+	/* the extremes */
+	zroaring_free(&a);
+	zroaring_add(&a, 0xFFFFFFFFUL);
+	zroaring_add(&a, 0);
+	assert (zroaring_contains(&a, 0xFFFFFFFFUL) && zroaring_rank(&a, 0xFFFFFFFFUL) == 2);
+	ok = zroaring_select(&a, 1, &x);
+	assert (ok && x == 0xFFFFFFFFUL);
+	for (k = 0; k < 65536; k++) {
+		zroaring_add(&a, 0xFFFF0000UL | k);
+	}
+	zroaring_run_optimize(&a);
+	assert (a.cs[1].type == ZROARING_RUN && a.cs[1].n == 1 && zroaring_cardinality(&a) == 65537);
+	assert (zroaring_rank(&a, 0xFFFFFFFEUL) == 65536);
+
+	free(buf);
+	free(ra);
+	free(rb);
+	free(rc);
+	zroaring_free(&a);
+	zroaring_free(&b);
+	zroaring_free(&c);
+	(void)ok; (void)added;
+	return 0;
+}
+
+int test_zheap() {
+	zheapi h = ZHEAP_INITIALIZER;
+	zheapi2 h2 = ZHEAP_INITIALIZER;
+	zheapmax8 h8 = ZHEAP_INITIALIZER;
+	zheapnode hn = ZHEAP_INITIALIZER;
+	_test_node node;
+	int items[1000];
+	unsigned long long x = 5;
+	int i, prev, v, w;
+
+	for (i = 0; i < 1000; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		items[i] = (int)(x >> 40) % 500;
+		zheapi_push(&h, items[i]);
+		zheapi2_push(&h2, items[i]);
+	}
+	zheapmax8_heapify(&h8, items, 1);
+	zheapmax8_heapify(&h8, items + 1, 999);
+	assert (h.len == 1000 && h8.len == 1000);
+	prev = zheapi_top(&h);
+	for (i = 0; i < 1000; i++) {
+		v = zheapi_pop(&h);
+		assert (v >= prev);
+		w = zheapi2_pop(&h2);
+		assert (v == w);
+		prev = v;
+	}
+	assert (h.len == 0);
+	prev = zheapmax8_pop(&h8);
+	for (i = 1; i < 1000; i++) {
+		v = zheapmax8_pop(&h8);
+		assert (v <= prev);
+		prev = v;
+	}
+
+	/* interleaved pushes and pops */
+	zheapi_heapify(&h, items, 10);
+	for (i = 10; i < 1000; i++) {
+		zheapi_push(&h, items[i]);
+		if (i % 3 == 0) {
+			v = zheapi_pop(&h);
+			assert (h.len == 0 || v <= zheapi_top(&h));
+		}
+	}
+	zheapi_clear(&h);
+	assert (h.len == 0);
+
+	/* indexed: change priorities in place */
+	for (i = 0; i < 100; i++) {
+		node.id = (size_t)i;
+		node.dist = 1000.0 + i;
+		zheapnode_push(&hn, node);
+	}
+	assert (zheapnode_contains_id(&hn, 99) && !zheapnode_contains_id(&hn, 100) && !zheapnode_contains_id(&hn, 100000));
+	node.id = 77;
+	node.dist = 5.0;
+	zheapnode_decrease_key(&hn, node);
+	node.id = 0;
+	node.dist = 5000.0;
+	zheapnode_update(&hn, node);
+	node.id = 50;
+	node.dist = 6.0;
+	zheapnode_update(&hn, node);
+	node = zheapnode_pop(&hn);
+	assert (node.id == 77 && node.dist == 5.0);
+	assert (!zheapnode_contains_id(&hn, 77));
+	node = zheapnode_pop(&hn);
+	assert (node.id == 50);
+	node = zheapnode_pop(&hn);
+	assert (node.id == 1);
+	while (hn.len > 0) {
+		node = zheapnode_pop(&hn);
+	}
+	assert (node.id == 0 && hn.len == 0);
+	/* an id can come back after it was popped */
+	zheapnode_push(&hn, node);
+	assert (zheapnode_contains_id(&hn, 0));
+	zheapnode_clear(&hn);
+	assert (!zheapnode_contains_id(&hn, 0));
+
+	zheapi_free(&h);
+	zheapi2_free(&h2);
+	zheapmax8_free(&h8);
+	zheapnode_free(&hn);
+	(void)prev; (void)w;
+	return 0;
+}
+
+#define TEST_ZBTREE_SPAN 20000
+
+/* Check every range query of t against have[]/vals[], which say which of 
+   the keys lo..lo+TEST_ZBTREE_SPAN-1 are present and with what value.  The 
+   tree's keys are (base + offset), as the given type. */
+#define _TEST_ZBTREE_RANGES(nam, ktyp, t, base) do { \
+	nam##_iter it; \
+	ktyp k; \
+	int v; \
+	size_t a, b, j, q; \
+	for (q = 0; q < 50; q++) { \
+		a = (q * 7919) % TEST_ZBTREE_SPAN; \
+		b = a + (q * 104729) % 3000; \
+		if (b >= TEST_ZBTREE_SPAN) { b = TEST_ZBTREE_SPAN - 1; } \
+		nam##_range(&(t), (ktyp)((base) + a), (ktyp)((base) + b), &it); \
+		for (j = a; j <= b; j++) { \
+			if (!have[j]) { continue; } \
+			ok = nam##_iter_next(&it, &k, &v); \
+			assert (ok && (k == (ktyp)((base) + j)) && (v == vals[j])); \
+		} \
+		ok = nam##_iter_next(&it, NULL, NULL); \
+		assert (!ok); \
+		nam##_range_rev(&(t), (ktyp)((base) + a), (ktyp)((base) + b), &it); \
+		for (j = b + 1; j-- > a; ) { \
+			if (!have[j]) { continue; } \
+			ok = nam##_iter_next(&it, &k, &v); \
+			assert (ok && (k == (ktyp)((base) + j)) && (v == vals[j])); \
+		} \
+		ok = nam##_iter_next(&it, NULL, NULL); \
+		assert (!ok); \
+	} \
+} while (0)
+
+int test_zbtree() {
+	zbtreeii t = ZBTREE_INITIALIZER;
+	zbtreeulli tu = ZBTREE_INITIALIZER;
+	zbtreesi ts = ZBTREE_INITIALIZER;
+	zbtreeii_iter it;
+	static bool have[TEST_ZBTREE_SPAN];
+	static int vals[TEST_ZBTREE_SPAN];
+	int* keys = (int*)malloc(sizeof(int) * TEST_ZBTREE_SPAN);
+	int* pv;
+	unsigned long long x = 3;
+	const unsigned long long ubase = 0x8000000000000000ULL - TEST_ZBTREE_SPAN / 2;
+	const int base = -TEST_ZBTREE_SPAN / 2;
+	size_t i, j, n, len = 0;
+	bool ok;
+	int k;
+
+	assert (!zbtreeii_contains(&t, 5));
+	ok = zbtreeii_remove(&t, 5);
+	assert (!ok);
+	zbtreeii_range(&t, 0, 10, &it);
+	ok = zbtreeii_iter_next(&it, NULL, NULL);
+	assert (!ok);
+
+	/* random puts and removes, with the same keys in all three trees */
+	memset(have, 0, sizeof(have));
+	for (i = 0; i < 60000; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		j = (size_t)(x >> 33) % TEST_ZBTREE_SPAN;
+		if ((i % 4 == 3) || ((i > 40000) && (i % 2 == 1))) {
+			ok = zbtreeii_remove(&t, base + (int)j);
+			assert (ok == have[j]);
+			ok = zbtreeulli_remove(&tu, ubase + j);
+			assert (ok == have[j]);
+			ok = zbtreesi_remove(&ts, (short)(base + (int)j));
+			assert (ok == have[j]);
+			len -= have[j];
+			have[j] = 0;
+		} else {
+			vals[j] = (int)i;
+			ok = zbtreeii_put(&t, base + (int)j, (int)i);
+			assert (ok == !have[j]);
+			ok = zbtreeulli_put(&tu, ubase + j, (int)i);
+			assert (ok == !have[j]);
+			ok = zbtreesi_put(&ts, (short)(base + (int)j), (int)i);
+			assert (ok == !have[j]);
+			len += !have[j];
+			have[j] = 1;
+		}
+	}
+	assert (t.len == len && tu.len == len && ts.len == len && t.height >= 2);
+	for (j = 0; j < TEST_ZBTREE_SPAN; j++) {
+		pv = zbtreeii_get(&t, base + (int)j);
+		assert (have[j] ? (pv != NULL && *pv == vals[j]) : (pv == NULL));
+		assert (zbtreeulli_contains(&tu, ubase + j) == have[j]);
+		assert (zbtreesi_contains(&ts, (short)(base + (int)j)) == have[j]);
+	}
+	assert (!zbtreeii_contains(&t, base - 1) && !zbtreeii_contains(&t, -base));
+	_TEST_ZBTREE_RANGES(zbtreeii, int, t, base);
+	_TEST_ZBTREE_RANGES(zbtreeulli, unsigned long long, tu, ubase);
+	_TEST_ZBTREE_RANGES(zbtreesi, short, ts, base);
+
+	/* an empty range, and the whole tree backwards */
+	zbtreeii_range(&t, 10, 9, &it);
+	ok = zbtreeii_iter_next(&it, NULL, NULL);
+	assert (!ok);
+	zbtreeii_range_rev(&t, INT_MIN, INT_MAX, &it);
+	n = 0;
+	while (zbtreeii_iter_next(&it, NULL, NULL)) {
+		n++;
+	}
+	assert (n == len);
+
+	/* bulk loading what's left over */
+	n = 0;
+	for (j = 0; j < TEST_ZBTREE_SPAN; j++) {
+		if (have[j]) {
+			keys[n] = base + (int)j;
+			vals[n] = (int)j * 3;
+			n++;
+		}
+	}
+	zbtreeii_bulk_load(&t, keys, vals, n);
+	assert (t.len == n);
+	zbtreeii_range(&t, INT_MIN, INT_MAX, &it);
+	for (i = 0; i < n; i++) {
+		ok = zbtreeii_iter_next(&it, &k, NULL);
+		assert (ok && k == keys[i]);
+		pv = zbtreeii_get(&t, keys[i]);
+		assert (pv != NULL && *pv == (int)(keys[i] - base) * 3);
+	}
+	/* and carrying on with puts into the packed tree */
+	for (j = 0; j < TEST_ZBTREE_SPAN; j++) {
+		zbtreeii_put(&t, base + (int)j, (int)j);
+	}
+	assert (t.len == TEST_ZBTREE_SPAN);
+	for (j = 0; j < TEST_ZBTREE_SPAN; j++) {
+		pv = zbtreeii_get(&t, base + (int)j);
+		assert (pv != NULL && *pv == (int)j);
+	}
+	for (n = 0; n <= 130; n += 13) {
+		zbtreeii_bulk_load(&t, keys, vals, n);
+		assert (t.len == n && zbtreeii_contains(&t, keys[0]) == (n > 0));
+	}
+
+	zbtreeii_free(&t);
+	zbtreeii_free(&t);
+	zbtreeulli_free(&tu);
+	zbtreesi_free(&ts);
+	free(keys);
+	(void)ok; (void)pv;
+	return 0;
+}
+
+int test_zbloom() {
+	zbloom b;
+	zbloom b2 = ZBLOOM_INITIALIZER;
+	const size_t n = 20000;
+	uint64_t* hs = (uint64_t*)malloc(sizeof(uint64_t) * 2 * n);
+	bool* out = (bool*)malloc(sizeof(bool) * 2 * n);
+	zbyte* buf;
+	size_t i, fp, size;
+	bool ok;
+
+	for (i = 0; i < 2 * n; i++) {
+		hs[i] = zhash_u64(i);
+	}
+	zbloom_init(&b, n, 0.01);
+	/* about 10 bits per value, and not too far off the unblocked optimum */
+	assert (b.nblocks * 256 > 9 * n && b.nblocks * 256 < 14 * n);
+	for (i = 0; i < n; i++) {
+		assert (!zbloom_contains(&b, hs[i]) || i > 0);
+		zbloom_add(&b, hs[i]);
+	}
+	assert (b.len == n);
+	for (i = 0; i < n; i++) {
+		assert (zbloom_contains(&b, hs[i]));
+	}
+	fp = 0;
+	for (i = n; i < 2 * n; i++) {
+		fp += zbloom_contains(&b, hs[i]);
+	}
+	assert (fp < n / 50);
+
+	/* batches agree with one at a time */
+	zbloom_init(&b2, n, 0.01);
+	zbloom_add_batch(&b2, hs, n);
+	assert (b2.len == n && memcmp(b.words, b2.words, 32 * b.nblocks) == 0);
+	i = zbloom_contains_batch(&b, hs, 2 * n, out);
+	assert (i == n + fp);
+	for (i = 0; i < 2 * n; i++) {
+		assert (out[i] == zbloom_contains(&b, hs[i]));
+	}
+	zbloom_free(&b2);
+
+	/* serialization round trip, and rejecting bad input */
+	size = zbloom_serialized_size(&b);
+	assert (size == 24 + 32 * b.nblocks);
+	buf = (zbyte*)malloc(size);
+	zbloom_serialize(&b, buf);
+	assert (uint32_decode(buf) == 0x5a424631UL && uint64_decode(buf + 8) == b.nblocks);
+	ok = zbloom_deserialize(&b2, buf, size);
+	assert (ok && b2.len == n && b2.nblocks == b.nblocks);
+	for (i = 0; i < 2 * n; i++) {
+		assert (zbloom_contains(&b2, hs[i]) == zbloom_contains(&b, hs[i]));
+	}
+	zbloom_free(&b2);
+	ok = zbloom_deserialize(&b2, buf, size - 1);
+	assert (!ok && b2.words == NULL);
+	ok = zbloom_deserialize(&b2, buf, 10);
+	assert (!ok);
+	buf[0] ^= 1;
+	ok = zbloom_deserialize(&b2, buf, size);
+	assert (!ok);
+
+	zbloom_clear(&b);
+	assert (b.len == 0 && !zbloom_contains(&b, hs[0]));
+	zbloom_free(&b);
+	zbloom_free(&b);
+
+	/* a tiny filter still works */
+	zbloom_init(&b, 0, 0.5);
+	assert (b.nblocks == 1);
+	zbloom_add(&b, hs[0]);
+	assert (zbloom_contains(&b, hs[0]));
+	zbloom_free(&b);
+
+	free(buf);
+	free(hs);
+	free(out);
+	(void)ok;
+	return 0;
+}
+
+int test_zpipe() {
+	zlisti src = ZLIST_INITIALIZER;
+	zlisti empty = ZLIST_INITIALIZER;
+	zlistll dst = ZLIST_INITIALIZER;
+	zlisti odd = ZLIST_INITIALIZER;
+	size_t seen = 0;
+	int i;
+
+	for (i = 0; i < 1000; i++) {
+		zlisti_append(&src, i);
+	}
+
+	ZPIPE_BEGIN(int, x, &src)
+		ZPIPE_FILTER(x % 2 == 0)
+		ZPIPE_MAP(long long, sq, (long long)x * x)
+		ZPIPE_TAKE(10)
+		ZPIPE_INTO(zlistll, &dst, sq)
+	ZPIPE_END
+	assert (dst.len == 10 && dst.cap == 10);
+	for (i = 0; i < 10; i++) {
+		assert (dst.arr[i] == (long long)(2 * i) * (2 * i));
+	}
+
+	/* no take: appends after what's there, reserving once for the rest of 
+	   the source */
+	ZPIPE_BEGIN(int, x, &src)
+		ZPIPE_MAP(int, y, x * 3)
+		ZPIPE_FILTER(y % 2 == 1)
+		ZPIPE_INTO(zlisti, &odd, y)
+		seen++;
+	ZPIPE_END
+	assert (odd.len == 500 && seen == 500 && odd.cap == 999);
+	for (i = 0; i < 500; i++) {
+		assert (odd.arr[i] == (2 * i + 1) * 3);
+	}
+	ZPIPE_BEGIN(int, x, &src)
+		ZPIPE_FILTER(x >= 995)
+		ZPIPE_INTO(zlisti, &odd, -x)
+	ZPIPE_END
+	assert (odd.len == 505 && odd.arr[504] == -999);
+
+	/* a take before a filter, a take of 0, and an empty source */
+	seen = 0;
+	ZPIPE_BEGIN(int, x, &src)
+		ZPIPE_TAKE(100)
+		ZPIPE_FILTER(x % 10 == 0)
+		seen++;
+	ZPIPE_END
+	assert (seen == 10);
+	ZPIPE_BEGIN(int, x, &src)
+		ZPIPE_TAKE(0)
+		ZPIPE_INTO(zlistll, &dst, x)
+	ZPIPE_END
+	assert (dst.len == 10);
+	ZPIPE_BEGIN(int, x, &empty)
+		ZPIPE_INTO(zlistll, &dst, x)
+	ZPIPE_END
+	assert (dst.len == 10);
+
+	zlisti_free(&src);
+	zlisti_free(&odd);
+	zlistll_free(&dst);
+	return 0;
+}
+
+/* This passes whether or not Z_ZLIST_STATS is defined; it checks the counts 
+   only if it is. */
+int test_zlist_stats() {
+	zliststatl l = ZLIST_INITIALIZER;
+	FILE* f;
+	char buf[1024];
+	size_t n;
+	long i;
+
+	zlist_stats_reset();
+	for (i = 0; i < 100; i++) {
+		zliststatl_append(&l, i);
+	}
+	assert (zliststatl_contains_item(l, 9));
+	assert (!zliststatl_contains_item(l, 100));
+	zliststatl_clear(&l);
+	zliststatl_append(&l, 5);
+#ifdef Z_ZLIST_STATS
+	/* capacities 4, 8, 16, 32, 64, 128 */
+	assert (zliststatl_stats.resizes == 6);
+	assert (zliststatl_stats.bytes_copied == sizeof(long) * (4 + 8 + 16 + 32 + 64));
+	assert (zliststatl_stats.peak_len == 100);
+	assert (zliststatl_stats.contains_calls == 2 && zliststatl_stats.elements_scanned == 110);
+#endif
+
+	f = tmpfile();
+	assert (f != NULL);
+	zlist_stats_dump(f, 1);
+	rewind(f);
+	n = fread(buf, 1, sizeof(buf) - 1, f);
+	buf[n] = '\0';
+	fclose(f);
+#ifdef Z_ZLIST_STATS
+	assert (strcmp(buf, "{\"zliststatl\": {\"resizes\": 6, \"bytes_copied\": 992, \"peak_len\": 100, \"contains_calls\": 2, \"elements_scanned\": 110}}\n") == 0 || sizeof(long) != 8);
+#else
+	assert (strcmp(buf, "{}\n") == 0);
+#endif
+
+	zlist_stats_reset();
+	f = tmpfile();
+	assert (f != NULL);
+	zliststatl_append(&l, 6);
+	zlist_stats_dump(f, 0);
+	rewind(f);
+	n = fread(buf, 1, sizeof(buf) - 1, f);
+	buf[n] = '\0';
+	fclose(f);
+#ifdef Z_ZLIST_STATS
+	assert (strcmp(buf, "zliststatl: resizes 0, bytes copied 0, peak len 2, contains_item calls 0, elements scanned 0\n") == 0);
+#else
+	assert (n == 0);
+#endif
+	zliststatl_free(&l);
+	return 0;
+}
+
+int test_zlist_aligned() {
+	zlistali l = ZLIST_INITIALIZER;
+	zlistali l2 = ZLIST_INITIALIZER;
+	zlistalhuge h = ZLIST_INITIALIZER;
+	int items[3] = { -1, -2, -3 };
+	long long i;
+
+	for (i = 0; i < 1000; i++) {
+		zlistali_append(&l, (int)i);
+		assert (((uintptr_t)l.arr & 255) == 0);
+	}
+	zlistali_insert_range(&l, 10, items, 3);
+	assert (l.len == 1003 && l.arr[9] == 9 && l.arr[11] == -2 && l.arr[13] == 10);
+	assert (zlistali_contains_item(l, 999) && !zlistali_contains_item(l, 1000));
+	zlistali_copy(&l2, &l);
+	assert (l2.len == 1003 && ((uintptr_t)l2.arr & 255) == 0 && l2.arr[1002] == 999);
+	zlistali_shrink_to_fit(&l);
+	assert (l.cap == 1003 && ((uintptr_t)l.arr & 255) == 0 && l.arr[1002] == 999);
+	zlistali_clear(&l);
+	zlistali_shrink_to_fit(&l);
+	assert (l.arr == NULL && l.cap == 0);
+
+	/* growing past hugebytes (1 MB) moves to huge-page-aligned mappings, and 
+	   then grows those in place or by moving the pages */
+	for (i = 0; i < 1000000; i++) {
+		zlistalhuge_append(&h, i * 3);
+		if (h.cap * sizeof(long long) >= (1 << 20)) {
+			assert (((uintptr_t)h.arr & (ZLIST_HUGE_PAGE - 1)) == 0);
+		} else {
+			assert (((uintptr_t)h.arr & 63) == 0);
+		}
+	}
+	for (i = 0; i < 1000000; i++) {
+		assert (h.arr[i] == i * 3);
+	}
+	zlistalhuge_resize(&h, 200000);
+	zlistalhuge_shrink_to_fit(&h);
+	assert (h.cap == 200000 && ((uintptr_t)h.arr & (ZLIST_HUGE_PAGE - 1)) == 0 && h.arr[199999] == 199999 * 3);
+	zlistalhuge_resize(&h, 1000);
+	zlistalhuge_shrink_to_fit(&h);
+	assert (h.cap == 1000 && ((uintptr_t)h.arr & 63) == 0 && h.arr[999] == 999 * 3);
+	zlistalhuge_reserve(&h, 3000000);
+	assert (h.arr[999] == 999 * 3);
+	zlistalhuge_free(&h);
+	zlistalhuge_free(&h);
+	zlistali_free(&l);
+	zlistali_free(&l2);
+	return 0;
+}
+
+int test_zlist_serial() {
+	zlisti l = ZLIST_INITIALIZER;
+	zlisti l2 = ZLIST_INITIALIZER;
+	zlistll ll = ZLIST_INITIALIZER;
+	zlistll ll2 = ZLIST_INITIALIZER;
+	zlistuc uc = ZLIST_INITIALIZER;
+	zlisti_readonly v;
+	zlistll_readonly vll;
+	zlistuc_readonly vuc;
+	zbyte* buf;
+	zbyte* foreign;
+	size_t size, i, k;
+	bool ok;
+
+	for (i = 0; i < 1000; i++) {
+		zlisti_append(&l, (int)i * 7 - 3000);
+		zlistll_append(&ll, ((long long)i << 40) - 5);
+	}
+	size = zlisti_serialized_size(&l);
+	assert (size == ZLIST_SERIAL_HEADER + 4000);
+	/* malloc() memory is aligned for anything, so the view works in place */
+	buf = (zbyte*)malloc(size + 1);
+	zlisti_serialize(&l, buf);
+	assert (uint32_decode(buf) == 0x5a4c5331UL && buf[5] == 4 && uint64_decode(buf + 8) == 1000);
+	ok = zlisti_deserialize(&l2, buf, size);
+	assert (ok && l2.len == 1000 && memcmp(l.arr, l2.arr, 4000) == 0);
+	ok = zlisti_view(&v, buf, size, 1);
+	assert (ok && v.len == 1000 && v.arr == (const int*)(const void*)(buf + ZLIST_SERIAL_HEADER) && v.arr[999] == 999 * 7 - 3000);
+	ok = zlisti_view(&v, buf, size + 1, 0);
+	assert (ok);
+
+	/* bad input: too short, the wrong width, a flipped bit in the items or 
+	   in the header, a misaligned view */
+	ok = zlisti_deserialize(&l2, buf, size - 1);
+	assert (!ok && l2.len == 1000);
+	ok = zlisti_deserialize(&l2, buf, 10);
+	assert (!ok);
+	ok = zlistll_deserialize(&ll2, buf, size);
+	assert (!ok);
+	buf[ZLIST_SERIAL_HEADER + 123] ^= 0x10;
+	ok = zlisti_deserialize(&l2, buf, size);
+	assert (!ok);
+	ok = zlisti_view(&v, buf, size, 1);
+	assert (!ok);
+	ok = zlisti_view(&v, buf, size, 0);
+	assert (ok);
+	buf[ZLIST_SERIAL_HEADER + 123] ^= 0x10;
+	buf[9] ^= 1;
+	ok = zlisti_view(&v, buf, size, 0);
+	assert (!ok);
+	buf[9] ^= 1;
+	memmove(buf + 1, buf, size);
+	ok = zlisti_view(&v, buf + 1, size, 1);
+	assert (!ok);
+	ok = zlisti_deserialize(&l2, buf + 1, size);
+	assert (ok && l2.len == 1000 && memcmp(l.arr, l2.arr, 4000) == 0);
+	free(buf);
+
+	/* as written by a machine of the other byte order */
+	size = zlistll_serialized_size(&ll);
+	buf = (zbyte*)malloc(size);
+	foreign = (zbyte*)malloc(size);
+	zlistll_serialize(&ll, buf);
+	memcpy(foreign, buf, ZLIST_SERIAL_HEADER);
+	foreign[4] = (buf[4] == 1) ? 2 : 1;
+	for (i = 0; i < ll.len; i++) {
+		for (k = 0; k < 8; k++) {
+			foreign[ZLIST_SERIAL_HEADER + 8 * i + k] = buf[ZLIST_SERIAL_HEADER + 8 * i + 7 - k];
+		}
+	}
+	uint32_encode(zcrc32c(0, foreign + ZLIST_SERIAL_HEADER, size - ZLIST_SERIAL_HEADER), foreign + 16);
+	uint32_encode(zcrc32c(0, foreign, 20), foreign + 20);
+	ok = zlistll_view(&vll, foreign, size, 1);
+	assert (!ok);
+	ok = zlistll_deserialize(&ll2, foreign, size);
+	assert (ok && ll2.len == 1000 && memcmp(ll.arr, ll2.arr, 8000) == 0);
+	free(buf);
+	free(foreign);
+
+	/* empty lists and one-byte items */
+	zlistuc_append(&uc, 200);
+	zlistuc_clear(&uc);
+	buf = (zbyte*)malloc(zlistuc_serialized_size(&uc));
+	zlistuc_serialize(&uc, buf);
+	ok = zlistuc_view(&vuc, buf, ZLIST_SERIAL_HEADER, 1);
+	assert (ok && vuc.len == 0);
+	zlistuc_append(&uc, 1);
+	ok = zlistuc_deserialize(&uc, buf, ZLIST_SERIAL_HEADER);
+	assert (ok && uc.len == 0);
+	free(buf);
+
+	zlisti_free(&l);
+	zlisti_free(&l2);
+	zlistll_free(&ll);
+	zlistll_free(&ll2);
+	zlistuc_free(&uc);
+	(void)ok;
+	return 0;
+}
+
+int test_zlist_slice() {
+	zlisti l = ZLIST_INITIALIZER;
+	zlistuc text = ZLIST_INITIALIZER;
+	zlisti_slice s, t, head, tail;
+	zlistuc_slice rest, field;
+	const char* input = "ab\n\nc,d\n";
+	int lo, hi;
+	size_t i;
+	bool ok;
+
+	for (i = 0; i < 100; i++) {
+		zlisti_append(&l, 100 - (int)i);
+	}
+	s = zlisti_slice_of(&l, 10, 20);
+	assert (s.len == 20 && s.arr == l.arr + 10 && s.arr[0] == 90);
+	ok = zlisti_slice_minmax(s, &lo, &hi);
+	assert (ok && lo == 71 && hi == 90);
+	assert (zlisti_slice_find(s, 80) == 10 && zlisti_slice_find(s, 91) == 20);
+	assert (zlisti_slice_contains(s, 71) && !zlisti_slice_contains(s, 70));
+	assert (zlisti_slice_count(s, 75) == 1);
+	/* sorting a slice sorts just that part of the list */
+	zlisti_slice_sort(s);
+	assert (l.arr[9] == 91 && l.arr[10] == 71 && l.arr[29] == 90 && l.arr[30] == 70);
+	t = zlisti_subslice(s, 5, 3);
+	assert (t.len == 3 && t.arr[0] == 76 && t.arr[2] == 78);
+	t = zlisti_subslice(s, 20, 0);
+	assert (t.len == 0);
+	ok = zlisti_slice_minmax(t, &lo, &hi);
+	assert (!ok && lo == 71);
+	s = zlisti_slice_of(&l, 100, 0);
+	assert (s.len == 0 && zlisti_slice_find(s, 1) == 0);
+
+	s = zlisti_slice_of(&l, 0, 10);
+	zlisti_split_at(s, 4, &head, &tail);
+	assert (head.len == 4 && head.arr == l.arr && tail.len == 6 && tail.arr == l.arr + 4);
+	zlisti_split_at(s, 10, &head, &tail);
+	assert (head.len == 10 && tail.len == 0);
+	assert (zlisti_chunk_count(s, 3) == 4 && zlisti_chunk_count(s, 10) == 1 && zlisti_chunk_count(s, 20) == 1);
+	t = zlisti_chunk(s, 3, 3);
+	assert (t.len == 1 && t.arr == l.arr + 9);
+	t = zlisti_chunk(s, 3, 1);
+	assert (t.len == 3 && t.arr == l.arr + 3);
+	assert (zlisti_window_count(s, 3) == 8 && zlisti_window_count(s, 10) == 1 && zlisti_window_count(s, 11) == 0);
+	t = zlisti_window(s, 3, 7);
+	assert (t.len == 3 && t.arr == l.arr + 7);
+
+	/* splitting on a separator, as a parser would split lines */
+	zlistuc_extend(&text, (const unsigned char*)input, strlen(input));
+	rest = zlistuc_slice_of(&text, 0, text.len);
+	ok = zlistuc_split_next(&rest, '\n', &field);
+	assert (ok && field.len == 2 && field.arr[1] == 'b');
+	ok = zlistuc_split_next(&rest, '\n', &field);
+	assert (ok && field.len == 0);
+	ok = zlistuc_split_next(&rest, '\n', &field);
+	assert (ok && field.len == 3 && zlistuc_slice_count(field, ',') == 1);
+	ok = zlistuc_split_next(&rest, '\n', &field);
+	assert (!ok && rest.len == 0);
+	rest = zlistuc_slice_of(&text, 5, 2);
+	ok = zlistuc_split_next(&rest, ',', &field);
+	assert (ok && field.len == 0 && rest.len == 1);
+	ok = zlistuc_split_next(&rest, ',', &field);
+	assert (ok && field.len == 1 && field.arr[0] == 'd' && rest.len == 0);
+
+	zlisti_free(&l);
+	zlistuc_free(&text);
+	(void)ok;
+	return 0;
+}
+
+/* zprintf() has to give exactly what snprintf() gives. */
+#define _TEST_ZPRINTF(...) do { \
+	zstrbuf_clear(&b); \
+	n = zprintf(&b, __VA_ARGS__); \
+	snprintf(ref, sizeof(ref), __VA_ARGS__); \
+	assert ((n == strlen(ref)) && (strcmp(b.arr, ref) == 0)); \
+} while (0)
+
+int test_zstrbuf() {
+	zstrbuf b = ZLIST_INITIALIZER;
+	char ref[1024];
+	const char* volatile nullstr = NULL;
+	size_t n, i;
+	int side = 0;
+
+	_TEST_ZPRINTF("plain text, no conversions");
+	_TEST_ZPRINTF("%d %d %d %d", 0, 7, -7, INT_MAX);
+	_TEST_ZPRINTF("%d %i", INT_MIN, INT_MIN + 1);
+	_TEST_ZPRINTF("%lld %llu %lli", LLONG_MIN, ULLONG_MAX, LLONG_MAX);
+	_TEST_ZPRINTF("%ld %lu %lx", LONG_MIN, ULONG_MAX, ULONG_MAX);
+	_TEST_ZPRINTF("%hhd %hhu %hd %hu", 300, 300, 70000, 70000);
+	_TEST_ZPRINTF("%zu %zd %jd %ju %td", (size_t)12345678, (ptrdiff_t)-5, (intmax_t)-99, (uintmax_t)99, (ptrdiff_t)-42);
+	_TEST_ZPRINTF("[%+d] [% d] [%+d] [% d]", 5, 5, -5, -5);
+	_TEST_ZPRINTF("[%8d] [%-8d] [%08d] [%+08d] [%08d]", 123, 123, 123, 123, -123);
+	_TEST_ZPRINTF("[%.3d] [%8.3d] [%-8.3d] [%.0d] [%5.0d] [%.0u]", 7, -7, 7, 0, 0, 0U);
+	_TEST_ZPRINTF("[%o] [%#o] [%#o] [%#.0o] [%#.5o] [%#o]", 8U, 8U, 0U, 0U, 8U, 01234567U);
+	_TEST_ZPRINTF("[%x] [%X] [%#x] [%#X] [%#x] [%#010x] [%#.6x]", 0xdeadU, 0xbeefU, 0U, 255U, 255U, 255U, 255U);
+	_TEST_ZPRINTF("[%*d] [%*d] [%.*d] [%.*d] [%*.*d]", 6, 42, -6, 42, 4, 42, -1, 42, 7, 3, 42);
+	_TEST_ZPRINTF("[%c] [%3c] [%-3c] [%%]", 'x', 'y', 'z');
+	_TEST_ZPRINTF("[%s] [%10s] [%-10s] [%.2s] [%10.2s] [%.*s] [%.10s]", "hello", "hello", "hello", "hello", "hello", 3, "hello", "hi");
+	_TEST_ZPRINTF("[%s] [%8s]", nullstr, nullstr);
+	_TEST_ZPRINTF("[%p] [%p] [%20p] [%-20p]", (void*)&b, (void*)NULL, (void*)&b, (void*)&n);
+	_TEST_ZPRINTF("[%f] [%.3f] [%10.2f] [%-+12.5e] [%g] [%G] [%#g] [%a] [%08.3f]", 3.14159, -2.5, 1e6, 12345.678, 1e-10, 1e20, 2.0, 1.0, -3.5);
+	_TEST_ZPRINTF("[%Lf] [%.3Le] [%*.*f]", 1.5L, 123456.789L, 12, 4, 0.1);
+	_TEST_ZPRINTF("[%300d] [%.300d]", 1, -2);
+	_TEST_ZPRINTF("[%400.300f]", 1.0 / 3.0);
+
+	/* appending keeps what was there, and the result stays NUL-terminated */
+	zstrbuf_clear(&b);
+	zstrbuf_append_str(&b, "a=");
+	n = zprintf(&b, "%d", 1);
+	assert (n == 1 && b.len == 3 && strcmp(b.arr, "a=1") == 0);
+	zstrbuf_append(&b, ',');
+	assert (strcmp(zstrbuf_cstr(&b), "a=1,") == 0);
+	for (i = 0; i < 1000; i++) {
+		zprintf(&b, "%zu,", i);
+	}
+	n = b.len;
+	assert (b.arr[n] == '\0' && strncmp(b.arr + n - 4, "999,", 4) == 0);
+	zstrbuf_free(&b);
+	assert (strcmp(zstrbuf_cstr(&b), "") == 0);
+	zstrbuf_free(&b);
+
+	/* runtime_assertf() evaluates its arguments only if it fails */
+	runtime_assertf(side == 0, "side %d", ++side);
+	assert (side == 0);
+#ifdef __linux__
+	{
+		int fds[2], status;
+		pid_t pid;
+		ssize_t got;
+		if (pipe(fds) == 0) {
+			fflush(stderr);
+			pid = fork();
+			if (pid == 0) {
+				close(fds[0]);
+				dup2(fds[1], 2);
+				runtime_assertf(side > 1, "side is %d, want %s", side, "more");
+				_exit(0);
+			}
+			close(fds[1]);
+			got = read(fds[0], ref, sizeof(ref) - 1);
+			ref[(got > 0) ? got : 0] = '\0';
+			close(fds[0]);
+			waitpid(pid, &status, 0);
+			assert (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_FAILURE));
+			assert (strstr(ref, "test_zstrbuf: Assertion `side > 1' failed.; side is 0, want more") != NULL);
+		}
+	}
+#endif
+	return 0;
+}
+
+/* xorshift64*, for test values spread over every number of digits */
+static unsigned long long _test_zint_rand(unsigned long long*const state) {
+	unsigned long long x = *state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	return (x * 2685821657736338717ULL) >> (x % 64);
+}
+
+int test_zint() {
+	static const unsigned long long edges[] = { 0ULL, 1ULL, 9ULL, 10ULL, 99ULL, 100ULL, 255ULL, 256ULL, 4294967295ULL, 4294967296ULL, 999999999999999999ULL, 1000000000000000000ULL, 9999999999999999999ULL, 10000000000000000000ULL, 18446744073709551615ULL };
+	char buf[64], ref[64];
+	unsigned long long state = 88172645463325252ULL, v, u;
+	long long ll;
+	unsigned long ul;
+	unsigned ui;
+	long l;
+	int i;
+	size_t k, n;
+
+	for (k = 0; k < 100000 + sizeof(edges) / sizeof(edges[0]); k++) {
+		v = (k < sizeof(edges) / sizeof(edges[0])) ? edges[k] : _test_zint_rand(&state);
+		n = zint_format_ullong(v, buf);
+		assert (n == (size_t)snprintf(ref, sizeof(ref), "%llu", v) && memcmp(buf, ref, n) == 0);
+		n = zint_format_llong((long long)v, buf);
+		assert (n == (size_t)snprintf(ref, sizeof(ref), "%lld", (long long)v) && memcmp(buf, ref, n) == 0);
+		n = zint_format_uint((unsigned)v, buf);
+		assert (n == (size_t)snprintf(ref, sizeof(ref), "%u", (unsigned)v) && memcmp(buf, ref, n) == 0);
+		n = zint_format_int((int)v, buf);
+		assert (n == (size_t)snprintf(ref, sizeof(ref), "%d", (int)v) && memcmp(buf, ref, n) == 0);
+		n = zint_format_long((long)v, buf);
+		assert (n == (size_t)snprintf(ref, sizeof(ref), "%ld", (long)v) && memcmp(buf, ref, n) == 0);
+		n = zint_format_hex_ullong(v, buf, 0);
+		assert (n == (size_t)snprintf(ref, sizeof(ref), "%llx", v) && memcmp(buf, ref, n) == 0);
+		n = zint_format_hex_uint((unsigned)v, buf, 1);
+		assert (n == (size_t)snprintf(ref, sizeof(ref), "%X", (unsigned)v) && memcmp(buf, ref, n) == 0);
+
+		/* and back again, with something after the number */
+		n = (size_t)snprintf(ref, sizeof(ref), "%llu,", v);
+		u = 1;
+		assert (zint_parse_ullong(ref, n, &u) == n - 1 && u == v);
+		assert (zint_parse_ullong(ref, n - 1, &u) == n - 1 && u == v);
+		n = (size_t)snprintf(ref, sizeof(ref), "%lld ", (long long)v);
+		assert (zint_parse_llong(ref, n, &ll) == n - 1 && ll == (long long)v);
+		n = (size_t)snprintf(ref, sizeof(ref), "%llX", v);
+		assert (zint_parse_hex_ullong(ref, n, &u) == n && u == v);
+		n = (size_t)snprintf(ref, sizeof(ref), "%d", (int)v);
+		assert (zint_parse_int(ref, n, &i) == n && i == (int)v);
+		/* with plenty after it, as in the middle of a buffer */
+		n = (size_t)snprintf(ref, sizeof(ref), "%llu 1234567890123456789012345", v);
+		assert (zint_parse_ullong(ref, n, &u) == n - 26 && u == v);
+		n = (size_t)snprintf(ref, sizeof(ref), "%lld\n1234567890123456789012345", (long long)v);
+		assert (zint_parse_llong(ref, n, &ll) == n - 26 && ll == (long long)v);
+	}
+	n = zint_format_llong(LLONG_MIN, buf);
+	assert (n == ZINT_DEC_MAX && memcmp(buf, "-9223372036854775808", n) == 0);
+	n = zint_format_int(INT_MIN, buf);
+	assert (n == 11 && memcmp(buf, "-2147483648", n) == 0);
+	n = zint_format_hex_ullong(0xdeadbeefULL, buf, 1);
+	assert (n == 8 && memcmp(buf, "DEADBEEF", n) == 0);
+	n = zint_format_hex_ulong(0, buf, 0);
+	assert (n == 1 && buf[0] == '0');
+
+	/* overflow, at the edge of each type */
+	assert (zint_parse_ullong("18446744073709551615", 20, &u) == 20 && u == ULLONG_MAX);
+	u = 7;
+	assert (zint_parse_ullong("18446744073709551616", 20, &u) == 0 && u == 7);
+	assert (zint_parse_ullong("99999999999999999999", 20, &u) == 0);
+	assert (zint_parse_ullong("100000000000000000000", 21, &u) == 0);
+	assert (zint_parse_ullong("000000000000000000000000018446744073709551615x", 46, &u) == 45 && u == ULLONG_MAX);
+	assert (zint_parse_ullong("18446744073709551615,                    ", 41, &u) == 20 && u == ULLONG_MAX);
+	assert (zint_parse_ullong("18446744073709551616,                    ", 41, &u) == 0);
+	assert (zint_parse_ullong("000000000000000000001,                   ", 41, &u) == 21 && u == 1);
+	assert (zint_parse_ullong("1234567890123456789012345678901234567890", 40, &u) == 0);
+	assert (zint_parse_ullong("9999999999999999999,                     ", 41, &u) == 19 && u == 9999999999999999999ULL);
+	assert (zint_parse_ullong("x23456789012345678901234", 24, &u) == 0);
+	assert (zint_parse_llong("9223372036854775807", 19, &ll) == 19 && ll == LLONG_MAX);
+	assert (zint_parse_llong("9223372036854775808", 19, &ll) == 0);
+	assert (zint_parse_llong("-9223372036854775808", 20, &ll) == 20 && ll == LLONG_MIN);
+	assert (zint_parse_llong("-9223372036854775809", 20, &ll) == 0);
+	assert (zint_parse_int("2147483647", 10, &i) == 10 && i == INT_MAX);
+	assert (zint_parse_int("2147483648", 10, &i) == 0);
+	assert (zint_parse_int("-2147483648", 11, &i) == 11 && i == INT_MIN);
+	assert (zint_parse_int("+42", 3, &i) == 3 && i == 42);
+	assert (zint_parse_uint("4294967295", 10, &ui) == 10 && ui == UINT_MAX);
+	assert (zint_parse_uint("4294967296", 10, &ui) == 0);
+	assert (zint_parse_ulong("12", 2, &ul) == 2 && ul == 12);
+	assert (zint_parse_long("-12", 3, &l) == 3 && l == -12);
+	assert (zint_parse_hex_ullong("FFFFffffFFFFffff", 16, &u) == 16 && u == ULLONG_MAX);
+	assert (zint_parse_hex_ullong("10000000000000000", 17, &u) == 0);
+	assert (zint_parse_hex_ullong("00000000000000000001g", 21, &u) == 20 && u == 1);
+	assert (zint_parse_hex_uint("100000000", 9, &ui) == 0);
+	assert (zint_parse_hex_ulong("7f", 2, &ul) == 2 && ul == 127);
+
+	/* not a number: nothing used, *out untouched */
+	u = 7;
+	assert (zint_parse_ullong("", 0, &u) == 0 && u == 7);
+	assert (zint_parse_ullong(NULL, 0, &u) == 0);
+	assert (zint_parse_ullong("x1", 2, &u) == 0);
+	assert (zint_parse_ullong("-1", 2, &u) == 0);
+	assert (zint_parse_ullong("+1", 2, &u) == 0);
+	assert (zint_parse_ullong(" 1", 2, &u) == 0 && u == 7);
+	assert (zint_parse_llong("-", 1, &ll) == 0);
+	assert (zint_parse_llong("-x", 2, &ll) == 0);
+	assert (zint_parse_hex_ullong("x", 1, &u) == 0 && u == 7);
+	/* len is respected even mid-number */
+	assert (zint_parse_ullong("12345678901234567890", 9, &u) == 9 && u == 123456789ULL);
+	assert (zint_parse_ullong("000", 3, &u) == 3 && u == 0);
+	(void)u; (void)ll; (void)ul; (void)ui; (void)l; (void)i; (void)n;
+	return 0;
+}
+
+int _test_zlist_matches(const int* arr, size_t len, const int* expected, size_t n) {
+	return (len == n) && ((n == 0) || (memcmp(arr, expected, sizeof(int) * n) == 0));
+}
+
+int test_zlist_bulk() {
+	zlisti l = ZLIST_INITIALIZER;
+	zlisti c = ZLIST_INITIALIZER;
+	zlistsi sl = ZLIST_INITIALIZER;
+	zlistsi sc = ZLIST_INITIALIZER;
+	zarena a = ZARENA_INITIALIZER;
+	zlistai al;
+	const int abc[] = { 1, 2, 3 };
+	const int xy[] = { 8, 9 };
+	const int e1[] = { 1, 2, 3, 1, 2, 3 };
+	const int e2[] = { 8, 9, 1, 2, 8, 9, 3, 1, 2, 3, 8, 9 };
+	const int e3[] = { 8, 9, 1, 3, 1, 2, 3, 8, 9 };
+	const int e4[] = { 8, 9, 1, 3, 1, 2, 3 };
+	int x;
+
+	/* Nothing to erase from a list that was never allocated. */
+	zlisti_erase_range(&l, 0, 0);
+	assert (l.arr == NULL);
+	zlisti_extend(&l, abc, 3);
+	zlisti_extend(&l, NULL, 0);
+	zlisti_extend(&l, abc, 3);
+	assert (_test_zlist_matches(l.arr, l.len, e1, 6));
+	zlisti_insert_range(&l, 0, xy, 2);
+	zlisti_insert_range(&l, 4, xy, 2);
+	zlisti_insert_range(&l, l.len, xy, 2);
+	assert (_test_zlist_matches(l.arr, l.len, e2, 12));
+	zlisti_erase_range(&l, 3, 3);
+	assert (_test_zlist_matches(l.arr, l.len, e3, 9));
+	zlisti_erase_range(&l, 0, 0);
+	x = zlisti_pop(&l);
+	assert (x == 9);
+	zlisti_swap_remove(&l, 0);
+	assert (_test_zlist_matches(l.arr, l.len, e4, 7));
+	zlisti_swap_remove(&l, l.len - 1);
+	assert (l.len == 6);
+
+	zlisti_append(&c, 42);
+	zlisti_copy(&c, &l);
+	assert (_test_zlist_matches(c.arr, c.len, l.arr, l.len));
+	assert (c.arr != l.arr);
+	zlisti_erase_range(&l, 0, l.len);
+	assert (l.len == 0);
+
+	zlistsi_extend(&sl, abc, 3);
+	assert (sl.arr == sl.buf);
+	zlistsi_extend(&sl, e2, 12);
+	zlistsi_erase_range(&sl, 3, 12);
+	assert (_test_zlist_matches(sl.arr, sl.len, abc, 3));
+	zlistsi_copy(&sc, &sl);
+	assert (sc.arr == sc.buf);
+	assert (_test_zlist_matches(sc.arr, sc.len, abc, 3));
+
+	zlistai_init(&al, &a);
+	zlistai_extend(&al, e2, 12);
+	zlistai_insert_range(&al, 0, abc, 3);
+	assert (_test_zlist_matches(al.arr + 3, al.len - 3, e2, 12));
+	x = zlistai_pop(&al);
+	assert (x == 9);
+
+	zlisti_free(&l);
+	zlisti_free(&c);
+	zlistsi_free(&sl);
+	zlistsi_free(&sc);
+	zarena_free(&a);
+	(void)e1; (void)e3; (void)e4; (void)x;
+	return 0;
+}
+
+static double _bench_secs(clock_t start) {
+	return ((double)(clock() - start)) / CLOCKS_PER_SEC;
+}
+
+void bench_zlist_append() {
+	const size_t n = 10000000;
+	size_t i;
+	unsigned long reallocs;
+	clock_t start;
+	zlisti l = ZLIST_INITIALIZER;
+	size_t oldcap;
+	int* arr;
+
+	/* What zlisti_append() used to do: realloc() to exactly len+1 each time. */
+	start = clock();
+	arr = NULL;
+	reallocs = 0;
+	for (i = 0; i < n; i++) {
+		arr = (int*)realloc(arr, sizeof(int) * (i+1));
+		runtime_assert(arr != NULL, "memory exhaustion");
+		reallocs++;
+		arr[i] = (int)i;
+	}
+	printf("zlist append %lu items, exact growth:     %10lu reallocs %8.3f s\n", (unsigned long)n, reallocs, _bench_secs(start));
+	free(arr);
+
+	start = clock();
+	reallocs = 0;
+	oldcap = l.cap;
+	for (i = 0; i < n; i++) {
+		zlisti_append(&l, (int)i);
+		if (l.cap != oldcap) {
+			reallocs++;
+			oldcap = l.cap;
+		}
+	}
+	printf("zlist append %lu items, geometric growth: %10lu reallocs %8.3f s\n", (unsigned long)n, reallocs, _bench_secs(start));
+	zlisti_free(&l);
+}
+
+int test_zarena() {
+	zarena a;
+	zarena_mark m;
+	char* p;
+	char* q;
+	char* big;
+	int i;
+
+	zarena_init(&a, 256);
+	p = (char*)zarena_alloc(&a, 10);
+	assert (((size_t)p) % ZARENA_ALIGN == 0);
+	memcpy(p, "abcdefghi", 10);
+
+	/* The most recent allocation grows in place. */
+	q = (char*)zarena_realloc(&a, p, 10, 100);
+	assert (q == p);
+	assert (strcmp(q, "abcdefghi") == 0);
+
+	m = zarena_get_mark(&a);
+	for (i = 0; i < 100; i++) {
+		q = (char*)zarena_alloc(&a, 33);
+		assert (((size_t)q) % ZARENA_ALIGN == 0);
+		memset(q, i, 33);
+	}
+	big = (char*)zarena_alloc(&a, 10000);
+	memset(big, 'x', 10000);
+	zarena_reset(&a, m);
+	assert (strcmp(p, "abcdefghi") == 0);
+
+	/* After the reset the next allocation comes right after p again. */
+	q = (char*)zarena_alloc(&a, 1);
+	assert (q == p + 112);
+
+	/* Something which isn't the last allocation gets copied. */
+	q = (char*)zarena_realloc(&a, p, 100, 200);
+	assert (q != p);
+	assert (strcmp(q, "abcdefghi") == 0);
+
+	/* A 0-byte allocation is distinct from the next one, and growing it 
+	   doesn't run over that one. */
+	p = (char*)zarena_alloc(&a, 0);
+	q = (char*)zarena_alloc(&a, 16);
+	assert (p != q);
+	memset(q, 'q', 16);
+	p = (char*)zarena_realloc(&a, p, 0, 32);
+	memset(p, 'p', 32);
+	assert (q[0] == 'q' && q[15] == 'q');
+
+	zarena_clear(&a);
+	assert (a.head != NULL);
+	zarena_free(&a);
+	assert (a.head == NULL);
+	zarena_free(&a);
+	return 0;
+}
+
+int test_zlist_arena() {
+	zarena a = ZARENA_INITIALIZER;
+	zlistai l1, l2;
+	int i;
+
+	zlistai_init(&l1, &a);
+	zlistai_init(&l2, &a);
+	for (i = 0; i < 1000; i++) {
+		zlistai_append(&l1, i);
+		zlistai_append(&l2, -i);
+	}
+	assert (l1.len == 1000 && l2.len == 1000);
+	for (i = 0; i < 1000; i++) {
+		assert (l1.arr[i] == i);
+		assert (l2.arr[i] == -i);
+	}
+	assert (zlistai_contains_item(l1, 500));
+	assert (!zlistai_contains_item(l1, -500));
+	assert (zlistai_contains_item(l2, -500));
+
+	zlistai_free(&l1);
+	assert (l1.arr == NULL && l1.len == 0);
+	zlistai_append(&l1, 3);
+	assert (l1.len == 1 && l1.arr[0] == 3);
+
+	zarena_free(&a);
+	return 0;
+}
+
+void bench_zlist_arena() {
+	const int requests = 200000;
+	const int lists = 8;
+	const int items = 20;
+	int r, j, i;
+	clock_t start;
+	zlisti hl[8];
+	zlistai al[8];
+	zarena a = ZARENA_INITIALIZER;
+
+	start = clock();
+	for (r = 0; r < requests; r++) {
+		for (j = 0; j < lists; j++) {
+			hl[j].len = 0; hl[j].arr = NULL; hl[j].cap = 0;
+			for (i = 0; i < items; i++) {
+				zlisti_append(&hl[j], i);
+			}
+		}
+		for (j = 0; j < lists; j++) {
+			zlisti_free(&hl[j]);
+		}
+	}
+	printf("%d requests of %d lists of %d items, heap:  %8.3f s\n", requests, lists, items, _bench_secs(start));
+
+	start = clock();
+	for (r = 0; r < requests; r++) {
+		for (j = 0; j < lists; j++) {
+			zlistai_init(&al[j], &a);
+			for (i = 0; i < items; i++) {
+				zlistai_append(&al[j], i);
+			}
+		}
+		zarena_clear(&a);
+	}
+	printf("%d requests of %d lists of %d items, arena: %8.3f s\n", requests, lists, items, _bench_secs(start));
+	zarena_free(&a);
+}
+
+int test_zlist_sbo() {
+	zlistsi l = ZLIST_INITIALIZER;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		zlistsi_append(&l, i);
+		assert (l.arr == l.buf);
+	}
+	assert (l.cap == 8);
+	assert (zlistsi_contains_item(l, 7));
+	assert (!zlistsi_contains_item(l, 8));
+
+	zlistsi_append(&l, 8);
+	assert (l.arr != l.buf);
+	assert (l.cap >= 9);
+	for (i = 9; i < 100; i++) {
+		zlistsi_append(&l, i);
+	}
+	for (i = 0; i < 100; i++) {
+		assert (l.arr[i] == i);
+	}
+	assert (zlistsi_contains_item(l, 99));
+
+	zlistsi_resize(&l, 5);
+	zlistsi_shrink_to_fit(&l);
+	assert (l.arr == l.buf);
+	assert (l.cap == 8);
+	for (i = 0; i < 5; i++) {
+		assert (l.arr[i] == i);
+	}
+
+	zlistsi_free(&l);
+	assert (l.arr == NULL && l.len == 0 && l.cap == 0);
+	zlistsi_free(&l);
+
+	zlistsi_reserve(&l, 3);
+	assert (l.arr == l.buf);
+	zlistsi_reserve(&l, 20);
+	assert (l.arr != l.buf && l.cap == 20);
+	zlistsi_free(&l);
+	return 0;
+}
+
+void bench_zlist_sbo() {
+	const int n = 2000000;
+	const int items = 5;
+	int r, i;
+	long sum;
+	clock_t start;
+	zlisti hl;
+	zlistsi sl;
+
+	start = clock();
+	sum = 0;
+	for (r = 0; r < n; r++) {
+		hl.len = 0; hl.arr = NULL; hl.cap = 0;
+		for (i = 0; i < items; i++) {
+			zlisti_append(&hl, r+i);
+		}
+		sum += zlisti_contains_item(hl, r+items);
+		zlisti_free(&hl);
+	}
+	printf("%d lists of %d items, heap:   %8.3f s (%ld)\n", n, items, _bench_secs(start), sum);
+
+	start = clock();
+	sum = 0;
+	for (r = 0; r < n; r++) {
+		sl.len = 0; sl.arr = NULL; sl.cap = 0;
+		for (i = 0; i < items; i++) {
+			zlistsi_append(&sl, r+i);
+		}
+		sum += zlistsi_contains_item(sl, r+items);
+		zlistsi_free(&sl);
+	}
+	printf("%d lists of %d items, inline: %8.3f s (%ld)\n", n, items, _bench_secs(start), sum);
+}
+
+int test_zhash() {
+	zhashuli h = ZHASH_INITIALIZER;
+	zhashsetbad bs = ZHASH_INITIALIZER;
+	static int ref[4096];
+	unsigned long k;
+	unsigned long seed = 12345;
+	size_t i, n, reflen;
+	int* v;
+	int r;
+
+	assert (zhashuli_get(&h, 1) == NULL);
+	r = zhashuli_remove(&h, 1);
+	assert (!r);
+	assert (zhashuli_next(&h, 0) == h.cap);
+
+	/* random puts and removes, checked against a plain array */
+	memset(ref, 0, sizeof(ref));
+	reflen = 0;
+	for (i = 0; i < 200000; i++) {
+		seed = seed * 1103515245 + 12345;
+		k = (seed >> 8) % 4096;
+		if ((seed >> 4) % 3 == 0) {
+			r = zhashuli_remove(&h, k);
+			assert (r == (ref[k] != 0));
+			if (ref[k] != 0) { reflen--; }
+			ref[k] = 0;
+		} else {
+			r = zhashuli_put(&h, k, (int)i + 1);
+			assert (r == (ref[k] == 0));
+			if (ref[k] == 0) { reflen++; }
+			ref[k] = (int)i + 1;
+		}
+		assert (h.len == reflen);
+	}
+	for (k = 0; k < 4096; k++) {
+		v = zhashuli_get(&h, k);
+		if (ref[k] == 0) {
+			assert (v == NULL);
+			assert (!zhashuli_contains(&h, k));
+		} else {
+			assert (v != NULL && *v == ref[k]);
+			assert (zhashuli_contains(&h, k));
+		}
+	}
+	n = 0;
+	for (i = zhashuli_next(&h, 0); i < h.cap; i = zhashuli_next(&h, i+1)) {
+		assert (ref[h.slots[i].key] == h.slots[i].val);
+		n++;
+	}
+	assert (n == h.len);
+
+	zhashuli_clear(&h);
+	assert (h.len == 0);
+	assert (!zhashuli_contains(&h, 7));
+	zhashuli_reserve(&h, 10000);
+	assert (h.cap >= 10000);
+	zhashuli_free(&h);
+	zhashuli_free(&h);
+
+	for (i = 0; i < 1000; i++) {
+		r = zhashsetbad_add(&bs, (int)i);
+		assert (r);
+		r = zhashsetbad_add(&bs, (int)i);
+		assert (!r);
+	}
+	for (i = 0; i < 1000; i += 2) {
+		r = zhashsetbad_remove(&bs, (int)i);
+		assert (r);
+	}
+	for (i = 0; i < 1000; i++) {
+		assert (zhashsetbad_contains(&bs, (int)i) == (i % 2 == 1));
+	}
+	assert (bs.len == 500);
+	zhashsetbad_free(&bs);
+	(void)v;
+	(void)r;
+	return 0;
+}
+
+void bench_zhash() {
+	const unsigned long n = 5000;
+	const int rounds = 20;
+	unsigned long i;
+	int r;
+	long hits;
+	clock_t start;
+	zlisti l = ZLIST_INITIALIZER;
+	zhashuli h = ZHASH_INITIALIZER;
+
+	for (i = 0; i < n; i++) {
+		zlisti_append(&l, (int)(i * 7));
+		zhashuli_put(&h, i * 7, 0);
+	}
+	start = clock();
+	hits = 0;
+	for (r = 0; r < rounds; r++) {
+		for (i = 0; i < n; i++) {
+			hits += zlisti_contains_item(l, (int)(i * 3));
+		}
+	}
+	printf("%d x %lu lookups in %lu items, zlist contains_item: %8.3f s (%ld)\n", rounds, n, n, _bench_secs(start), hits);
+	start = clock();
+	hits = 0;
+	for (r = 0; r < rounds; r++) {
+		for (i = 0; i < n; i++) {
+			hits += zhashuli_contains(&h, i * 3);
+		}
+	}
+	printf("%d x %lu lookups in %lu items, zhash contains:      %8.3f s (%ld)\n", rounds, n, n, _bench_secs(start), hits);
+	zlisti_free(&l);
+	zhashuli_free(&h);
+}
+
+/* For every length up to 100 and every position, the item is found there, 
+   and values that differ only in the upper bytes are not mistaken for it. */
+#define _TEST_SCALAR_FIND(typ, nam, target, other) do { \
+	nam l = ZLIST_INITIALIZER; \
+	size_t len, pos, k; \
+	for (len = 0; len < 100; len++) { \
+		for (pos = 0; pos <= len; pos++) { \
+			nam##_clear(&l); \
+			for (k = 0; k < len; k++) { \
+				nam##_append(&l, (k == pos) ? (target) : (other)); \
+			} \
+			assert (nam##_find(l, (target)) == pos); \
+			assert (nam##_contains_item(l, (target)) == (pos < len)); \
+			assert (nam##_count(l, (target)) == (pos < len)); \
+			assert (nam##_count(l, (other)) == len - (pos < len)); \
+		} \
+	} \
+	nam##_free(&l); \
+} while (0)
+
+int test_zlist_scalar_find() {
+	int x, y;
+	_TEST_SCALAR_FIND(unsigned char, zlistuc, 0xFF, 0x7F);
+	_TEST_SCALAR_FIND(short, zlists, -2, 0x7FFE);
+	_TEST_SCALAR_FIND(unsigned, zlistu, 0x01020304, 0x01020305);
+	_TEST_SCALAR_FIND(long long, zlistll, 0x1LL << 40, 0x1LL << 41);
+	_TEST_SCALAR_FIND(long long, zlistll, 7LL, 7LL | (1LL << 32));
+	_TEST_SCALAR_FIND(voidp, zlistp, (voidp)&x, (voidp)&y);
+	return 0;
+}
+
+void bench_zlist_scalar_find() {
+	const int lookups = 20000000;
+	const unsigned n = 64;
+	unsigned i;
+	int r;
+	long hits;
+	clock_t start;
+	zlisti li = ZLIST_INITIALIZER;
+	zlistu lu = ZLIST_INITIALIZER;
+
+	for (i = 0; i < n; i++) {
+		zlisti_append(&li, (int)(i * 2));
+		zlistu_append(&lu, i * 2);
+	}
+	start = clock();
+	hits = 0;
+	for (r = 0; r < lookups; r++) {
+		hits += zlisti_contains_item(li, r % (2 * n));
+	}
+	printf("%d lookups in %u items, plain contains_item: %8.3f s (%ld)\n", lookups, n, _bench_secs(start), hits);
+	start = clock();
+	hits = 0;
+	for (r = 0; r < lookups; r++) {
+		hits += zlistu_contains_item(lu, r % (2 * n));
+	}
+	printf("%d lookups in %u items, SIMD contains_item:  %8.3f s (%ld)\n", lookups, n, _bench_secs(start), hits);
+	zlisti_free(&li);
+	zlistu_free(&lu);
+}
+
+int test_zlist_sorted() {
+	zlisti l = ZLIST_INITIALIZER;
+	zlisti_index ix = { 0, NULL };
+	unsigned long seed = 42;
+	size_t n, i, lb;
+	int x;
+	const int* p;
+
+	for (n = 0; n < 300; n++) {
+		zlisti_build_index(l, &ix);
+		for (i = 0; i < l.len; i++) {
+			assert ((i == 0) || (l.arr[i-1] <= l.arr[i]));
+		}
+		for (x = -2; x < 2 * 300 + 2; x++) {
+			lb = zlisti_lower_bound(l, x);
+			assert (lb <= l.len);
+			assert ((lb == l.len) || (l.arr[lb] >= x));
+			assert ((lb == 0) || (l.arr[lb-1] < x));
+			p = zlisti_index_lower_bound(&ix, x);
+			if (lb == l.len) {
+				assert (p == NULL);
+			} else {
+				assert (p != NULL && *p == l.arr[lb]);
+			}
+		}
+		seed = seed * 1103515245 + 12345;
+		zlisti_insert_sorted(&l, (int)((seed >> 8) % (2 * 300)));
+	}
+	zlisti_index_free(&ix);
+	zlisti_index_free(&ix);
+	zlisti_free(&l);
+	(void)p;
+	return 0;
+}
+
+static size_t _bench_plain_lower_bound(const int* const arr, const size_t len, const int x) {
+	size_t lo = 0, hi = len, mid;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (arr[mid] < x) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+void bench_zlist_sorted() {
+	const size_t queries = 2000000;
+	size_t n, i;
+	size_t sum;
+	unsigned long seed;
+	clock_t start;
+	zlisti l = ZLIST_INITIALIZER;
+	zlisti_index ix = { 0, NULL };
+	const int* p;
+
+	for (n = 1000; n <= 100000000; n *= 10) {
+		zlisti_resize(&l, n);
+		for (i = 0; i < n; i++) {
+			l.arr[i] = (int)(2 * i);
+		}
+		zlisti_build_index(l, &ix);
+
+		start = clock();
+		seed = 1; sum = 0;
+		for (i = 0; i < queries; i++) {
+			seed = seed * 1103515245 + 12345;
+			sum += _bench_plain_lower_bound(l.arr, n, (int)((seed >> 4) % (2 * n)));
+		}
+		printf("%9lu items, plain binary search:      %8.3f s (%lu)\n", (unsigned long)n, _bench_secs(start), (unsigned long)sum);
+
+		start = clock();
+		seed = 1; sum = 0;
+		for (i = 0; i < queries; i++) {
+			seed = seed * 1103515245 + 12345;
+			sum += zlisti_lower_bound(l, (int)((seed >> 4) % (2 * n)));
+		}
+		printf("%9lu items, branchless binary search: %8.3f s (%lu)\n", (unsigned long)n, _bench_secs(start), (unsigned long)sum);
+
+		start = clock();
+		seed = 1; sum = 0;
+		for (i = 0; i < queries; i++) {
+			seed = seed * 1103515245 + 12345;
+			p = zlisti_index_lower_bound(&ix, (int)((seed >> 4) % (2 * n)));
+			sum += (p == NULL) ? n : (size_t)(*p / 2);
+		}
+		printf("%9lu items, Eytzinger index:          %8.3f s (%lu)\n", (unsigned long)n, _bench_secs(start), (unsigned long)sum);
+	}
+	zlisti_index_free(&ix);
+	zlisti_free(&l);
+}
+
+static double _bench_wall_secs(const struct timespec* start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+#define BENCH_ZRING_N 20000000UL
+#define BENCH_ZRING_BATCH 64
+#define BENCH_ZRING_PINGS 1000000UL
+
+typedef struct {
+	zringul* there;
+	zringul* back;
+	int batched;
+} _bench_zring_args;
+
+void* _bench_zring_producer(void* arg) {
+	_bench_zring_args* const a = (_bench_zring_args*)arg;
+	unsigned long batch[BENCH_ZRING_BATCH];
+	unsigned long i;
+	size_t k, sent;
+	if (a->batched) {
+		for (i = 0; i < BENCH_ZRING_N; i += BENCH_ZRING_BATCH) {
+			for (k = 0; k < BENCH_ZRING_BATCH; k++) {
+				batch[k] = i + k;
+			}
+			for (sent = 0; sent < BENCH_ZRING_BATCH; ) {
+				k = zringul_push_n(a->there, batch + sent, BENCH_ZRING_BATCH - sent);
+				if (k == 0) { sched_yield(); }
+				sent += k;
+			}
+		}
+	} else {
+		for (i = 0; i < BENCH_ZRING_N; i++) {
+			while (!zringul_try_push(a->there, i)) { sched_yield(); }
+		}
+	}
+	return NULL;
+}
+
+void* _bench_zring_echo(void* arg) {
+	_bench_zring_args* const a = (_bench_zring_args*)arg;
+	unsigned long i, x;
+	for (i = 0; i < BENCH_ZRING_PINGS; i++) {
+		while (!zringul_try_pop(a->there, &x)) { sched_yield(); }
+		while (!zringul_try_push(a->back, x)) { sched_yield(); }
+	}
+	return NULL;
+}
+
+void bench_zring() {
+	zringul there, back;
+	_bench_zring_args args;
+	unsigned long batch[BENCH_ZRING_BATCH];
+	unsigned long got, x, sum;
+	struct timespec start;
+	double secs;
+	pthread_t t;
+	int batched;
+	size_t k;
+
+	zringul_init(&there, 4096);
+	zringul_init(&back, 4096);
+	args.there = &there;
+	args.back = &back;
+	for (batched = 0; batched <= 1; batched++) {
+		args.batched = batched;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		pthread_create(&t, NULL, _bench_zring_producer, &args);
+		got = 0; sum = 0;
+		while (got < BENCH_ZRING_N) {
+			if (batched) {
+				k = zringul_pop_n(&there, batch, BENCH_ZRING_BATCH);
+				got += k;
+				if (k > 0) { sum += batch[k-1]; } else { sched_yield(); }
+			} else if (zringul_try_pop(&there, &x)) {
+				got++;
+				sum += x;
+			} else {
+				sched_yield();
+			}
+		}
+		pthread_join(t, NULL);
+		secs = _bench_wall_secs(&start);
+		printf("zring %s: %lu items in %8.3f s, %8.1f M items/s (%lu)\n", batched ? "batches of 64" : "one at a time", BENCH_ZRING_N, secs, BENCH_ZRING_N / secs / 1e6, sum);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_create(&t, NULL, _bench_zring_echo, &args);
+	for (got = 0; got < BENCH_ZRING_PINGS; got++) {
+		while (!zringul_try_push(&there, got)) { sched_yield(); }
+		while (!zringul_try_pop(&back, &x)) { sched_yield(); }
+	}
+	pthread_join(t, NULL);
+	secs = _bench_wall_secs(&start);
+	printf("zring ping-pong: %lu round trips, %8.1f ns per round trip\n", BENCH_ZRING_PINGS, secs / BENCH_ZRING_PINGS * 1e9);
+	zringul_free(&there);
+	zringul_free(&back);
+}
+
+#define BENCH_ZQUEUE_N 4000000UL
+#define BENCH_ZQUEUE_MAXTHREADS 8
+
+typedef struct {
+	zqueueul* q;
+	unsigned long n;
+	unsigned long sum;
+} _bench_zqueue_args;
+
+void* _bench_zqueue_producer(void* arg) {
+	_bench_zqueue_args* const a = (_bench_zqueue_args*)arg;
+	unsigned long i;
+	for (i = 0; i < a->n; i++) {
+		zqueueul_push(a->q, i);
+	}
+	return NULL;
+}
+
+void* _bench_zqueue_consumer(void* arg) {
+	_bench_zqueue_args* const a = (_bench_zqueue_args*)arg;
+	unsigned long i, x;
+	a->sum = 0;
+	for (i = 0; i < a->n; i++) {
+		zqueueul_pop(a->q, &x);
+		a->sum += x;
+	}
+	return NULL;
+}
+
+/* Throughput with P producers and P consumers, all using the blocking calls. */
+void bench_zqueue() {
+	zqueueul q;
+	_bench_zqueue_args args[BENCH_ZQUEUE_MAXTHREADS];
+	pthread_t producers[BENCH_ZQUEUE_MAXTHREADS];
+	pthread_t consumers[BENCH_ZQUEUE_MAXTHREADS];
+	struct timespec start;
+	unsigned long sum;
+	double secs;
+	size_t p, i;
+
+	zqueueul_init(&q, 4096);
+	for (p = 1; p <= BENCH_ZQUEUE_MAXTHREADS; p *= 2) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (i = 0; i < p; i++) {
+			args[i].q = &q;
+			args[i].n = BENCH_ZQUEUE_N / p;
+			pthread_create(&consumers[i], NULL, _bench_zqueue_consumer, &args[i]);
+			pthread_create(&producers[i], NULL, _bench_zqueue_producer, &args[i]);
+		}
+		sum = 0;
+		for (i = 0; i < p; i++) {
+			pthread_join(producers[i], NULL);
+			pthread_join(consumers[i], NULL);
+			sum += args[i].sum;
+		}
+		secs = _bench_wall_secs(&start);
+		printf("zqueue %2lu producers, %2lu consumers: %lu items in %8.3f s, %8.1f M items/s (%lu)\n", (unsigned long)p, (unsigned long)p, BENCH_ZQUEUE_N, secs, BENCH_ZQUEUE_N / secs / 1e6, sum);
+	}
+	zqueueul_free(&q);
+}
+
+#define BENCH_ZCOLLECT_N 8000000
+#define BENCH_ZCOLLECT_MAXTHREADS 8
+
+typedef struct {
+	zcollecti* c;
+	zlisti* shared;
+	pthread_mutex_t* lock;
+	size_t tid;
+	int n;
+} _bench_zcollect_args;
+
+void* _bench_zcollect_locked(void* arg) {
+	_bench_zcollect_args* const a = (_bench_zcollect_args*)arg;
+	int i;
+	for (i = 0; i < a->n; i++) {
+		pthread_mutex_lock(a->lock);
+		zlisti_append(a->shared, i);
+		pthread_mutex_unlock(a->lock);
+	}
+	return NULL;
+}
+
+void* _bench_zcollect_local(void* arg) {
+	_bench_zcollect_args* const a = (_bench_zcollect_args*)arg;
+	int i;
+	for (i = 0; i < a->n; i++) {
+		zcollecti_append(a->c, a->tid, i);
+	}
+	return NULL;
+}
+
+/* Many threads appending to one logical list: a mutex around append() versus 
+   a collector, including the final merge. */
+void bench_zcollect() {
+	zcollecti c;
+	zlisti l = ZLIST_INITIALIZER;
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	_bench_zcollect_args args[BENCH_ZCOLLECT_MAXTHREADS];
+	pthread_t threads[BENCH_ZCOLLECT_MAXTHREADS];
+	struct timespec start;
+	double locked, collected;
+	size_t p, i;
+
+	zcollecti_init(&c, BENCH_ZCOLLECT_MAXTHREADS);
+	for (p = 1; p <= BENCH_ZCOLLECT_MAXTHREADS; p *= 2) {
+		for (i = 0; i < p; i++) {
+			args[i].c = &c;
+			args[i].shared = &l;
+			args[i].lock = &lock;
+			args[i].tid = i;
+			args[i].n = BENCH_ZCOLLECT_N / p;
+		}
+		zlisti_free(&l);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (i = 0; i < p; i++) {
+			pthread_create(&threads[i], NULL, _bench_zcollect_locked, &args[i]);
+		}
+		for (i = 0; i < p; i++) {
+			pthread_join(threads[i], NULL);
+		}
+		locked = _bench_wall_secs(&start);
+
+		zlisti_free(&l);
+		zcollecti_free(&c);
+		zcollecti_init(&c, BENCH_ZCOLLECT_MAXTHREADS);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (i = 0; i < p; i++) {
+			pthread_create(&threads[i], NULL, _bench_zcollect_local, &args[i]);
+		}
+		for (i = 0; i < p; i++) {
+			pthread_join(threads[i], NULL);
+		}
+		zcollecti_merge(&c, &l, 1, p);
+		collected = _bench_wall_secs(&start);
+		printf("zcollect %lu threads: %d appends, locked %8.3f s, collector %8.3f s (%lu)\n", (unsigned long)p, BENCH_ZCOLLECT_N, locked, collected, (unsigned long)l.len);
+	}
+	zcollecti_free(&c);
+	zlisti_free(&l);
+}
+
+#define BENCH_ZLIST_MMAP_N 50000000UL
+#define BENCH_ZLIST_MMAP_FILE "bench_zlist_mmap.tmp"
+
+/* Building a 400 MB list on the heap versus in a file, and reopening it. */
+void bench_zlist_mmap() {
+	zlistml m;
+	zlistll h = ZLIST_INITIALIZER;
+	struct timespec start;
+	unsigned long i;
+	long long sum;
+	bool ok;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < BENCH_ZLIST_MMAP_N; i++) {
+		zlistll_append(&h, (long long)i);
+	}
+	printf("zlist append %lu items, heap:          %8.3f s\n", BENCH_ZLIST_MMAP_N, _bench_wall_secs(&start));
+	zlistll_free(&h);
+
+	remove(BENCH_ZLIST_MMAP_FILE);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ok = zlistml_open(&m, BENCH_ZLIST_MMAP_FILE, 0);
+	runtime_assert(ok, "couldn't create the benchmark file");
+	for (i = 0; i < BENCH_ZLIST_MMAP_N; i++) {
+		zlistml_append(&m, (long)i);
+	}
+	printf("zlist append %lu items, mapped file:   %8.3f s\n", BENCH_ZLIST_MMAP_N, _bench_wall_secs(&start));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	zlistml_close(&m);
+	printf("zlist close (msync + trim) of the mapped file: %8.3f s\n", _bench_wall_secs(&start));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ok = zlistml_open(&m, BENCH_ZLIST_MMAP_FILE, 1);
+	runtime_assert(ok, "couldn't reopen the benchmark file");
+	printf("zlist reopen of %lu items read-only:  %8.6f s\n", (unsigned long)m.len, _bench_wall_secs(&start));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	sum = 0;
+	for (i = 0; i < m.len; i += 512) {
+		sum += m.arr[i];
+	}
+	printf("zlist touch every page after reopening:        %8.3f s (%lld)\n", _bench_wall_secs(&start), sum);
+	zlistml_close(&m);
+	remove(BENCH_ZLIST_MMAP_FILE);
+}
+
+static int _bench_cmp_int(const void* a, const void* b) {
+	const int x = *(const int*)a, y = *(const int*)b;
+	return (x > y) - (x < y);
+}
+
+/* qsort() versus the inlined introsort versus radix sort, on uniformly random 
+   31-bit keys, keys in 0..999, and already sorted keys. */
+void bench_zlist_sort() {
+	const size_t sizes[] = { 1000, 100000, 10000000 };
+	const char*const dists[] = { "random", "0..999", "sorted" };
+	zlisti l = ZLIST_INITIALIZER;
+	zlistu lu = ZLIST_INITIALIZER;
+	int* orig;
+	unsigned long long x = 1;
+	struct timespec start;
+	double qs, intro, radix, radix4;
+	size_t si, dist, i, n, reps, r;
+
+	for (si = 0; si < sizeof(sizes) / sizeof(sizes[0]); si++) {
+		n = sizes[si];
+		reps = 10000000 / n;
+		orig = (int*)malloc(sizeof(int) * n);
+		runtime_assert(orig != NULL, "memory exhaustion");
+		zlisti_resize(&l, n);
+		zlistu_resize(&lu, n);
+		for (dist = 0; dist < 3; dist++) {
+			for (i = 0; i < n; i++) {
+				x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+				orig[i] = (dist == 0) ? (int)(x >> 33) : (dist == 1) ? (int)((x >> 33) % 1000) : (int)i;
+			}
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			for (r = 0; r < reps; r++) {
+				memcpy(l.arr, orig, sizeof(int) * n);
+				qsort(l.arr, n, sizeof(int), _bench_cmp_int);
+			}
+			qs = _bench_wall_secs(&start);
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			for (r = 0; r < reps; r++) {
+				memcpy(lu.arr, orig, sizeof(int) * n);
+				zlistu_sort(&lu);
+			}
+			intro = _bench_wall_secs(&start);
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			for (r = 0; r < reps; r++) {
+				memcpy(l.arr, orig, sizeof(int) * n);
+				zlisti_sort(&l);
+			}
+			radix = _bench_wall_secs(&start);
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			for (r = 0; r < reps; r++) {
+				memcpy(l.arr, orig, sizeof(int) * n);
+				zlisti_sort_mt(&l, 4);
+			}
+			radix4 = _bench_wall_secs(&start);
+			printf("zlist sort %8lu ints (%s) x %5lu: qsort %7.3f s, introsort %7.3f s, radix %7.3f s, radix 4 threads %7.3f s\n", (unsigned long)n, dists[dist], (unsigned long)reps, qs, intro, radix, radix4);
+		}
+		free(orig);
+	}
+	zlisti_free(&l);
+	zlistu_free(&lu);
+}
+
+#define BENCH_SOA_N 4000000
+#define BENCH_SOA_REPS 20
+#define _BENCH_SOA_FIELDS(F) F(double, price) F(double, qty) F(long long, ts) F(int, account) F(int, flags) F(double, fee) F(double, tax)
+
+typedef struct {
+	_BENCH_SOA_FIELDS(_ZLIST_SOA_ROW_FIELD)
+} _bench_aos_row;
+DECLARE_ZLIST(_bench_aos_row, zlistaos)
+DEFINE_ZLIST(_bench_aos_row, zlistaos)
+DECLARE_ZLIST_SOA(_BENCH_SOA_FIELDS, zlistbsoa)
+DEFINE_ZLIST_SOA(_BENCH_SOA_FIELDS, zlistbsoa)
+
+/* Summing one field of a 48-byte record: a zlist of structs versus a 
+   structure-of-arrays zlist. */
+void bench_zlist_soa() {
+	zlistaos a = ZLIST_INITIALIZER;
+	zlistbsoa s = ZLIST_SOA_INITIALIZER;
+	zlistbsoa_row row;
+	_bench_aos_row arow;
+	struct timespec start;
+	double sum, aos, soa;
+	size_t i, r;
+
+	memset(&row, 0, sizeof(row));
+	for (i = 0; i < BENCH_SOA_N; i++) {
+		row.price = (double)(i % 1000);
+		row.qty = 1.0;
+		row.ts = (long long)i;
+		zlistbsoa_append(&s, row);
+		memcpy(&arow, &row, sizeof(arow));
+		zlistaos_append(&a, arow);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	sum = 0;
+	for (r = 0; r < BENCH_SOA_REPS; r++) {
+		for (i = 0; i < a.len; i++) {
+			sum += a.arr[i].price;
+		}
+	}
+	aos = _bench_wall_secs(&start);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (r = 0; r < BENCH_SOA_REPS; r++) {
+		for (i = 0; i < s.len; i++) {
+			sum += s.price[i];
+		}
+	}
+	soa = _bench_wall_secs(&start);
+	printf("zlist sum one field of %d %lu-byte rows x %d: array of structs %7.3f s, structure of arrays %7.3f s (%g)\n", BENCH_SOA_N, (unsigned long)sizeof(_bench_aos_row), BENCH_SOA_REPS, aos, soa, sum);
+	zlistaos_free(&a);
+	zlistbsoa_free(&s);
+}
+
+#define BENCH_ZROARING_SMALL 20000
+#define BENCH_ZROARING_BIG 5000000
+
+/* Intersecting sets of 32-bit ids: a zlist probed with contains_item() versus 
+   zroaring, plus how big each representation is. */
+void bench_zroaring() {
+	zlistll l = ZLIST_INITIALIZER;
+	zroaring a = ZROARING_INITIALIZER;
+	zroaring b = ZROARING_INITIALIZER;
+	zroaring c = ZROARING_INITIALIZER;
+	unsigned long long x = 3;
+	unsigned long long* other;
+	struct timespec start;
+	unsigned long i, hits;
+	double secs;
+
+	other = (unsigned long long*)malloc(sizeof(unsigned long long) * BENCH_ZROARING_SMALL);
+	runtime_assert(other != NULL, "memory exhaustion");
+	for (i = 0; i < BENCH_ZROARING_SMALL; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zlistll_append(&l, (long long)((x >> 33) % (BENCH_ZROARING_SMALL * 8)));
+		zroaring_add(&a, (uint32_t)l.arr[i]);
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		other[i] = (x >> 33) % (BENCH_ZROARING_SMALL * 8);
+		zroaring_add(&b, (uint32_t)other[i]);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0, hits = 0; i < BENCH_ZROARING_SMALL; i++) {
+		hits += zlistll_contains_item(l, (long long)other[i]);
+	}
+	secs = _bench_wall_secs(&start);
+	printf("zroaring %d x %d ids: zlist contains_item() %8.3f s (%lu)", BENCH_ZROARING_SMALL, BENCH_ZROARING_SMALL, secs, hits);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	zroaring_and(&c, &a, &b);
+	secs = _bench_wall_secs(&start);
+	printf(", zroaring_and() %8.6f s (%lu)\n", secs, (unsigned long)zroaring_cardinality(&c));
+	free(other);
+	zlistll_free(&l);
+	zroaring_free(&a);
+	zroaring_free(&b);
+
+	/* two big sets: one random over 2^26, one of runs of consecutive ids */
+	for (i = 0; i < BENCH_ZROARING_BIG; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zroaring_add(&a, (uint32_t)((x >> 33) & ((1UL << 26) - 1)));
+		zroaring_add(&b, (uint32_t)((i / 1000) * 13000 + i % 1000));
+	}
+	zroaring_run_optimize(&a);
+	zroaring_run_optimize(&b);
+	printf("zroaring %d ids: %lu and %lu bytes serialized, versus %lu bytes as zlists of unsigned long\n", BENCH_ZROARING_BIG, (unsigned long)zroaring_serialized_size(&a), (unsigned long)zroaring_serialized_size(&b), (unsigned long)(sizeof(unsigned long) * BENCH_ZROARING_BIG));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < 100; i++) {
+		zroaring_and(&c, &a, &b);
+	}
+	secs = _bench_wall_secs(&start);
+	printf("zroaring and of %d random and %d clustered ids: %8.6f s each (%lu)", BENCH_ZROARING_BIG, BENCH_ZROARING_BIG, secs / 100, (unsigned long)zroaring_cardinality(&c));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0, hits = 0; i < 100; i++) {
+		hits += (unsigned long)zroaring_and_cardinality(&a, &b);
+	}
+	secs = _bench_wall_secs(&start);
+	printf(", and_cardinality %8.6f s each\n", secs / 100);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < 100; i++) {
+		zroaring_or(&c, &a, &b);
+	}
+	secs = _bench_wall_secs(&start);
+	printf("zroaring or: %8.6f s each (%lu)\n", secs / 100, (unsigned long)zroaring_cardinality(&c));
+	zroaring_free(&a);
+	zroaring_free(&b);
+	zroaring_free(&c);
+}
+
+#define BENCH_ZHEAP_N 2000000
+#define BENCH_ZHEAP_RESORT_N 5000
+
+/* A scheduler-like load: fill the queue, then pop one and push one many 
+   times, then drain it. */
+void bench_zheap() {
+	zheapi h4 = ZHEAP_INITIALIZER;
+	zheapi2 h2 = ZHEAP_INITIALIZER;
+	zlistu l = ZLIST_INITIALIZER;
+	unsigned long long x = 9;
+	struct timespec start;
+	long long sum;
+	int v;
+	size_t i;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	sum = 0;
+	for (i = 0; i < BENCH_ZHEAP_N; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zheapi_push(&h4, (int)(x >> 33));
+	}
+	for (i = 0; i < BENCH_ZHEAP_N; i++) {
+		v = zheapi_pop(&h4);
+		sum += v;
+		zheapi_push(&h4, v + (int)(i % 1000));
+	}
+	while (h4.len > 0) {
+		sum += zheapi_pop(&h4);
+	}
+	printf("zheap %d pushes, %d pop+push, %d pops: 4-ary heap %8.3f s (%lld)", BENCH_ZHEAP_N, BENCH_ZHEAP_N, BENCH_ZHEAP_N, _bench_wall_secs(&start), sum);
+
+	x = 9;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	sum = 0;
+	for (i = 0; i < BENCH_ZHEAP_N; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zheapi2_push(&h2, (int)(x >> 33));
+	}
+	for (i = 0; i < BENCH_ZHEAP_N; i++) {
+		v = zheapi2_pop(&h2);
+		sum += v;
+		zheapi2_push(&h2, v + (int)(i % 1000));
+	}
+	while (h2.len > 0) {
+		sum += zheapi2_pop(&h2);
+	}
+	printf(", binary heap %8.3f s (%lld)\n", _bench_wall_secs(&start), sum);
+
+	/* What the schedulers do now: append and re-sort, take the first item. */
+	x = 9;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	sum = 0;
+	for (i = 0; i < BENCH_ZHEAP_RESORT_N; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zlistu_append(&l, (unsigned)(x >> 33));
+		zlistu_sort(&l);
+	}
+	for (i = 0; i < BENCH_ZHEAP_RESORT_N; i++) {
+		v = (int)l.arr[0];
+		zlistu_erase_range(&l, 0, 1);
+		sum += v;
+		zlistu_append(&l, (unsigned)(v + (int)(i % 1000)));
+		zlistu_sort(&l);
+	}
+	printf("zheap %d pushes and %d pop+push: re-sorted zlist %8.3f s (%lld)", BENCH_ZHEAP_RESORT_N, BENCH_ZHEAP_RESORT_N, _bench_wall_secs(&start), sum);
+	x = 9;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	sum = 0;
+	for (i = 0; i < BENCH_ZHEAP_RESORT_N; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zheapi_push(&h4, (int)(x >> 33));
+	}
+	for (i = 0; i < BENCH_ZHEAP_RESORT_N; i++) {
+		v = zheapi_pop(&h4);
+		sum += v;
+		zheapi_push(&h4, v + (int)(i % 1000));
+	}
+	printf(", 4-ary heap %8.6f s (%lld)\n", _bench_wall_secs(&start), sum);
+	zheapi_free(&h4);
+	zheapi2_free(&h2);
+	zlistu_free(&l);
+}
+
+#define BENCH_ZBTREE_N 2000000
+#define BENCH_ZBTREE_SORTED_N 200000
+
+static size_t _bench_lower_bound(const long long* arr, size_t n, long long k) {
+	size_t lo = 0, hi = n, mid;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (arr[mid] < k) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+DECLARE_ZBTREE(long long, long long, zbtreell)
+DEFINE_ZBTREE(long long, long long, zbtreell)
+
+void bench_zbtree() {
+	zbtreell t = ZBTREE_INITIALIZER;
+	zbtreell_iter it;
+	zlistll l = ZLIST_INITIALIZER;
+	long long* keys = (long long*)malloc(sizeof(long long) * BENCH_ZBTREE_N);
+	long long k, v, sum;
+	unsigned long long x;
+	struct timespec start;
+	size_t i, pos;
+
+	x = 11;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < BENCH_ZBTREE_SORTED_N; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		k = (long long)(x >> 20);
+		pos = _bench_lower_bound(l.arr, l.len, k);
+		if ((pos == l.len) || (l.arr[pos] != k)) {
+			zlistll_insert_range(&l, pos, &k, 1);
+		}
+	}
+	printf("zbtree %d random inserts: sorted zlist %8.3f s", BENCH_ZBTREE_SORTED_N, _bench_wall_secs(&start));
+	x = 11;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < BENCH_ZBTREE_SORTED_N; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zbtreell_put(&t, (long long)(x >> 20), (long long)i);
+	}
+	printf(", zbtree %8.3f s\n", _bench_wall_secs(&start));
+	zbtreell_free(&t);
+
+	x = 11;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < BENCH_ZBTREE_N; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		zbtreell_put(&t, (long long)(x >> 20), (long long)i);
+	}
+	printf("zbtree %d random puts %8.3f s", BENCH_ZBTREE_N, _bench_wall_secs(&start));
+	for (i = 0; i < BENCH_ZBTREE_N; i++) {
+		keys[i] = (long long)i * 3;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	zbtreell_bulk_load(&t, keys, keys, BENCH_ZBTREE_N);
+	printf(", bulk load %8.3f s", _bench_wall_secs(&start));
+	x = 11;
+	sum = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < BENCH_ZBTREE_N; i++) {
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+		sum += zbtreell_contains(&t, (long long)((x >> 33) % (3 * BENCH_ZBTREE_N)));
+	}
+	printf(", random gets %8.3f s (%lld hits)", _bench_wall_secs(&start), sum);
+	sum = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	zbtreell_range(&t, 0, 3 * BENCH_ZBTREE_N, &it);
+	while (zbtreell_iter_next(&it, &k, &v)) {
+		sum += v;
+	}
+	zbtreell_range_rev(&t, 0, 3 * BENCH_ZBTREE_N, &it);
+	while (zbtreell_iter_next(&it, &k, &v)) {
+		sum -= v;
+	}
+	printf(", full scans both ways %8.3f s (%lld)\n", _bench_wall_secs(&start), sum);
+	zbtreell_free(&t);
+	zlistll_free(&l);
+	free(keys);
+}
+
+#define BENCH_ZBLOOM_N 1000000
+
+/* Lookups of which 1 in 100 hit, with and without a zbloom in front: a zhash 
+   too big for the cache, and a zlist small enough to scan. */
+void bench_zbloom() {
+	zhashuli h = ZHASH_INITIALIZER;
+	zlisti l = ZLIST_INITIALIZER;
+	zbloom b;
+	zbloom bl;
+	uint64_t* hs = (uint64_t*)malloc(sizeof(uint64_t) * BENCH_ZBLOOM_N);
+	bool* out = (bool*)malloc(sizeof(bool) * BENCH_ZBLOOM_N);
+	unsigned long key;
+	struct timespec start;
+	long hits;
+	size_t i;
+
+	zbloom_init(&b, BENCH_ZBLOOM_N, 0.01);
+	for (i = 0; i < BENCH_ZBLOOM_N; i++) {
+		zhashuli_put(&h, i * 100, 0);
+		zbloom_add(&b, zhash_u64(i * 100));
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	hits = 0;
+	for (i = 0; i < BENCH_ZBLOOM_N; i++) {
+		hits += zhashuli_contains(&h, i * 101 + 1);
+	}
+	printf("zbloom %d lookups in a %d-entry zhash: zhash alone %8.3f s (%ld)", BENCH_ZBLOOM_N, BENCH_ZBLOOM_N, _bench_wall_secs(&start), hits);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	hits = 0;
+	for (i = 0; i < BENCH_ZBLOOM_N; i++) {
+		key = i * 101 + 1;
+		if (zbloom_contains(&b, zhash_u64(key))) {
+			hits += zhashuli_contains(&h, key);
+		}
+	}
+	printf(", zbloom first %8.3f s (%ld)", _bench_wall_secs(&start), hits);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < BENCH_ZBLOOM_N; i++) {
+		hs[i] = zhash_u64(i * 101 + 1);
+	}
+	zbloom_contains_batch(&b, hs, BENCH_ZBLOOM_N, out);
+	hits = 0;
+	for (i = 0; i < BENCH_ZBLOOM_N; i++) {
+		if (out[i]) {
+			hits += zhashuli_contains(&h, i * 101 + 1);
+		}
+	}
+	printf(", zbloom batch first %8.3f s (%ld)\n", _bench_wall_secs(&start), hits);
+
+	zbloom_init(&bl, 2000, 0.01);
+	for (i = 0; i < 2000; i++) {
+		zlisti_append(&l, (int)(i * 100));
+		zbloom_add(&bl, zhash_u64(i * 100));
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	hits = 0;
+	for (i = 0; i < BENCH_ZBLOOM_N / 10; i++) {
+		hits += zlisti_contains_item(l, (int)(i * 101 + 1));
+	}
+	printf("zbloom %d lookups in a 2000-item zlist: contains_item alone %8.3f s (%ld)", BENCH_ZBLOOM_N / 10, _bench_wall_secs(&start), hits);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	hits = 0;
+	for (i = 0; i < BENCH_ZBLOOM_N / 10; i++) {
+		if (zbloom_contains(&bl, zhash_u64(i * 101 + 1))) {
+			hits += zlisti_contains_item(l, (int)(i * 101 + 1));
+		}
+	}
+	printf(", zbloom first %8.3f s (%ld)\n", _bench_wall_secs(&start), hits);
+	zbloom_free(&b);
+	zbloom_free(&bl);
+	zhashuli_free(&h);
+	zlisti_free(&l);
+	free(hs);
+	free(out);
+}
+
+#define BENCH_ZPIPE_N 10000000
+
+/* Keep the items divisible by 3, square them, keep the squares ending in 6 
+   and take the first quarter of the list's worth: step by step, building a 
+   zlist per step, and as one zpipe. */
+void bench_zpipe() {
+	zlisti src = ZLIST_INITIALIZER;
+	zlisti f1 = ZLIST_INITIALIZER;
+	zlistll m = ZLIST_INITIALIZER;
+	zlistll f2 = ZLIST_INITIALIZER;
+	zlistll out = ZLIST_INITIALIZER;
+	const size_t want = BENCH_ZPIPE_N / 4;
+	struct timespec start;
+	size_t i;
+
+	for (i = 0; i < BENCH_ZPIPE_N; i++) {
+		zlisti_append(&src, (int)i);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < src.len; i++) {
+		if (src.arr[i] % 3 == 0) {
+			zlisti_append(&f1, src.arr[i]);
+		}
+	}
+	for (i = 0; i < f1.len; i++) {
+		zlistll_append(&m, (long long)f1.arr[i] * f1.arr[i]);
+	}
+	for (i = 0; i < m.len; i++) {
+		if (m.arr[i] % 10 == 6) {
+			zlistll_append(&f2, m.arr[i]);
+		}
+	}
+	for (i = 0; (i < f2.len) && (i < want); i++) {
+		zlistll_append(&out, f2.arr[i]);
+	}
+	printf("zpipe filter/map/filter/take over %d ints: a zlist per step %8.3f s (%lu)", BENCH_ZPIPE_N, _bench_wall_secs(&start), (unsigned long)out.len);
+	zlisti_free(&f1);
+	zlistll_free(&m);
+	zlistll_free(&f2);
+	zlistll_free(&out);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ZPIPE_BEGIN(int, x, &src)
+		ZPIPE_FILTER(x % 3 == 0)
+		ZPIPE_MAP(long long, sq, (long long)x * x)
+		ZPIPE_FILTER(sq % 10 == 6)
+		ZPIPE_TAKE(want)
+		ZPIPE_INTO(zlistll, &out, sq)
+	ZPIPE_END
+	printf(", zpipe %8.3f s (%lu)\n", _bench_wall_secs(&start), (unsigned long)out.len);
+	zlisti_free(&src);
+	zlistll_free(&out);
+}
+
+/* The bench for aligned lists scans this many megabytes; raise it to see 
+   multi-gigabyte lists. */
+#define BENCH_ZLIST_ALIGNED_MB 1024
+#define BENCH_ZLIST_ALIGNED_PROBES 20000000
+
+DECLARE_ZLIST_ALIGNED(long long, zlistalbench)
+DEFINE_ZLIST_ALIGNED(long long, zlistalbench, 64, 32 << 20)
+
+/* A counter of this process's data-TLB read misses, or -1 where there is no 
+   such thing (no PMU, as in most VMs, or not Linux). */
+static int _bench_dtlb_open() {
+#ifdef __linux__
+	struct perf_event_attr a;
+	memset(&a, 0, sizeof(a));
+	a.size = sizeof(a);
+	a.type = PERF_TYPE_HW_CACHE;
+	a.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	a.exclude_kernel = 1;
+	a.exclude_hv = 1;
+	return (int)syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+#else
+	return -1;
+#endif
+}
+
+static long long _bench_dtlb_read(int fd) {
+	long long n = -1;
+#ifdef __linux__
+	if ((fd >= 0) && (read(fd, &n, sizeof(n)) != sizeof(n))) {
+		n = -1;
+	}
+#endif
+	return n;
+}
+
+/* How much of the process is in transparent huge pages, in kB, or -1. */
+static long _bench_anon_huge_kb() {
+	FILE* f = fopen("/proc/self/smaps_rollup", "r");
+	char line[256];
+	long kb = -1;
+	if (f == NULL) {
+		return -1;
+	}
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) {
+			break;
+		}
+	}
+	fclose(f);
+	return kb;
+}
+
+#define _BENCH_ZLIST_ALIGNED_RUN(nam, label) do { \
+	nam l = ZLIST_INITIALIZER; \
+	const size_t n = (size_t)BENCH_ZLIST_ALIGNED_MB * (1 << 20) / sizeof(long long); \
+	unsigned long long x = 13; \
+	long long sum = 0; \
+	long long tlb0; \
+	long huge; \
+	double fill, scan, probe; \
+	size_t i; \
+	clock_gettime(CLOCK_MONOTONIC, &start); \
+	for (i = 0; i < n; i++) { \
+		nam##_append(&l, (long long)i); \
+	} \
+	fill = _bench_wall_secs(&start); \
+	huge = _bench_anon_huge_kb(); \
+	clock_gettime(CLOCK_MONOTONIC, &start); \
+	for (i = 0; i < n; i++) { \
+		sum += l.arr[i]; \
+	} \
+	scan = _bench_wall_secs(&start); \
+	tlb0 = _bench_dtlb_read(tlbfd); \
+	clock_gettime(CLOCK_MONOTONIC, &start); \
+	for (i = 0; i < BENCH_ZLIST_ALIGNED_PROBES; i++) { \
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL; \
+		sum += l.arr[(x >> 20) % n]; \
+	} \
+	probe = _bench_wall_secs(&start); \
+	printf("zlist %d MB, %-22s: append %6.3f s, scan %6.3f s, %d random reads %6.3f s, dTLB misses %lld, huge pages %ld kB (%lld)\n", BENCH_ZLIST_ALIGNED_MB, label, fill, scan, BENCH_ZLIST_ALIGNED_PROBES, probe, (tlb0 < 0) ? -1 : _bench_dtlb_read(tlbfd) - tlb0, huge, sum); \
+	nam##_free(&l); \
+} while (0)
+
+void bench_zlist_aligned() {
+	struct timespec start;
+	const int tlbfd = _bench_dtlb_open();
+
+	_BENCH_ZLIST_ALIGNED_RUN(zlistll, "zlist (realloc)");
+	_BENCH_ZLIST_ALIGNED_RUN(zlistalbench, "aligned, MADV_HUGEPAGE");
+#ifdef __linux__
+	if (tlbfd >= 0) {
+		close(tlbfd);
+	}
+#endif
+}
+
+#define BENCH_ZLIST_SERIAL_N 20000000
+
+void bench_zlist_serial() {
+	zlisti l = ZLIST_INITIALIZER;
+	zlisti l2 = ZLIST_INITIALIZER;
+	zlisti_readonly v;
+	zbyte* buf = (zbyte*)malloc(ZLIST_SERIAL_HEADER + 4 * (size_t)BENCH_ZLIST_SERIAL_N);
+	struct timespec start;
+	long long sum;
+	size_t i;
+	bool ok;
+
+	for (i = 0; i < BENCH_ZLIST_SERIAL_N; i++) {
+		zlisti_append(&l, (int)(i * 2654435761U));
+	}
+	memset(buf, 0, ZLIST_SERIAL_HEADER + 4 * (size_t)BENCH_ZLIST_SERIAL_N);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < l.len; i++) {
+		uint32_encode((unsigned long)(unsigned)l.arr[i], buf + 4 * i);
+	}
+	zlisti_resize(&l2, 0);
+	for (i = 0; i < l.len; i++) {
+		zlisti_append(&l2, (int)uint32_decode(buf + 4 * i));
+	}
+	printf("zlist serialize+read back %d ints: uint32_encode/decode loops %8.3f s", BENCH_ZLIST_SERIAL_N, _bench_wall_secs(&start));
+	zlisti_free(&l2);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	zlisti_serialize(&l, buf);
+	ok = zlisti_deserialize(&l2, buf, ZLIST_SERIAL_HEADER + 4 * (size_t)BENCH_ZLIST_SERIAL_N);
+	printf(", serialize+deserialize %8.3f s", _bench_wall_secs(&start));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ok = ok && zlisti_view(&v, buf, ZLIST_SERIAL_HEADER + 4 * (size_t)BENCH_ZLIST_SERIAL_N, 1);
+	printf(", verified view %8.3f s", _bench_wall_secs(&start));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ok = ok && zlisti_view(&v, buf, ZLIST_SERIAL_HEADER + 4 * (size_t)BENCH_ZLIST_SERIAL_N, 0);
+	printf(", unverified view %8.6f s", _bench_wall_secs(&start));
+	sum = 0;
+	for (i = 0; ok && (i < v.len); i++) {
+		sum += v.arr[i] - l2.arr[i];
+	}
+	printf(" (%d %lld)\n", ok, sum);
+	zlisti_free(&l);
+	zlisti_free(&l2);
+	free(buf);
+}
+
+#define BENCH_ZLIST_SLICE_BYTES (64 << 20)
+
+/* Split a buffer of CSV-ish lines and count the fields on each line, once by 
+   copying every line into a list of its own and once with slices. */
+void bench_zlist_slice() {
+	zlistuc text = ZLIST_INITIALIZER;
+	zlistuc line = ZLIST_INITIALIZER;
+	zlistuc_slice rest, field;
+	const unsigned char nl = '\n';
+	struct timespec start;
+	size_t i, n, fields;
+
+	srand(48);
+	for (i = 0; i < BENCH_ZLIST_SLICE_BYTES; i++) {
+		n = (size_t)rand() % 256;
+		zlistuc_append(&text, (n == 0) ? '\n' : ((n < 16) ? ',' : (unsigned char)('a' + n % 26)));
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	fields = 0;
+	for (i = 0; i < text.len; i += n + 1) {
+		n = zscan_find(text.arr + i, text.len - i, &nl, 1);
+		zlistuc_clear(&line);
+		zlistuc_extend(&line, text.arr + i, n);
+		fields += zlistuc_count(line, ',') + 1;
+	}
+	printf("zlist count fields on %d MB of lines: copying each line %8.3f s", BENCH_ZLIST_SLICE_BYTES >> 20, _bench_wall_secs(&start));
+	n = fields;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	fields = 0;
+	rest = zlistuc_slice_of(&text, 0, text.len);
+	while (zlistuc_split_next(&rest, '\n', &field)) {
+		fields += zlistuc_slice_count(field, ',') + 1;
+	}
+	printf(", slices %8.3f s (%lu %lu)\n", _bench_wall_secs(&start), (unsigned long)n, (unsigned long)fields);
+	zlistuc_free(&text);
+	zlistuc_free(&line);
+}
+
+#define BENCH_ZPRINTF_N 2000000
+
+/* Format a typical log line, and a line of nothing but integers, over and 
+   over: snprintf() into a fixed buffer against zprintf() into a reused 
+   zstrbuf. */
+void bench_zprintf() {
+	zstrbuf b = ZLIST_INITIALIZER;
+	char buf[256];
+	clock_t start;
+	unsigned long long sum;
+	size_t i;
+
+	sum = 0;
+	start = clock();
+	for (i = 0; i < BENCH_ZPRINTF_N; i++) {
+		sum += (unsigned)snprintf(buf, sizeof(buf), "%s %d: user=%s id=%llu bytes=%zu flags=%#x\n", "INFO", (int)(i % 1000), "zooko", (unsigned long long)i * 2654435761ULL, i * 13, (unsigned)i & 0xffU);
+	}
+	printf("format %d log lines: snprintf %8.3f s", BENCH_ZPRINTF_N, _bench_secs(start));
+	start = clock();
+	for (i = 0; i < BENCH_ZPRINTF_N; i++) {
+		zstrbuf_clear(&b);
+		sum -= zprintf(&b, "%s %d: user=%s id=%llu bytes=%zu flags=%#x\n", "INFO", (int)(i % 1000), "zooko", (unsigned long long)i * 2654435761ULL, i * 13, (unsigned)i & 0xffU);
+	}
+	printf(", zprintf %8.3f s", _bench_secs(start));
+	start = clock();
+	for (i = 0; i < BENCH_ZPRINTF_N; i++) {
+		sum += (unsigned)snprintf(buf, sizeof(buf), "%d %u %lld %zu\n", (int)i - 1000000, (unsigned)i * 7U, (long long)i * -123456789LL, i);
+	}
+	printf("; integers: snprintf %8.3f s", _bench_secs(start));
+	start = clock();
+	for (i = 0; i < BENCH_ZPRINTF_N; i++) {
+		zstrbuf_clear(&b);
+		sum -= zprintf(&b, "%d %u %lld %zu\n", (int)i - 1000000, (unsigned)i * 7U, (long long)i * -123456789LL, i);
+	}
+	printf(", zprintf %8.3f s (%llu)\n", _bench_secs(start), sum);
+	zstrbuf_free(&b);
+}
+
+#define BENCH_ZINT_N 5000000
+
+/* Format a lot of integers of all sizes and parse them back, with libc and 
+   with zint. */
+void bench_zint() {
+	unsigned long long* vals = (unsigned long long*)malloc(sizeof(unsigned long long) * BENCH_ZINT_N);
+	char* text = (char*)malloc((size_t)(ZINT_DEC_MAX + 1) * BENCH_ZINT_N + 1);
+	unsigned long long state = 88172645463325252ULL, sum, v;
+	const char* p;
+	char* q;
+	clock_t start;
+	size_t i, n, len;
+
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		vals[i] = _test_zint_rand(&state);
+	}
+	start = clock();
+	q = text;
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		q += sprintf(q, "%llu ", vals[i]);
+	}
+	printf("%d integers: sprintf %8.3f s", BENCH_ZINT_N, _bench_secs(start));
+	start = clock();
+	q = text;
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		q += zint_format_ullong(vals[i], q);
+		*q++ = ' ';
+	}
+	*q = '\0';
+	len = (size_t)(q - text);
+	printf(", zint_format_ullong %8.3f s", _bench_secs(start));
+	start = clock();
+	sum = 0;
+	p = text;
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		sum += strtoull(p, (char**)&q, 10);
+		p = q + 1;
+	}
+	printf("; strtoull %8.3f s", _bench_secs(start));
+	start = clock();
+	p = text;
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		n = zint_parse_ullong(p, len - (size_t)(p - text), &v);
+		sum -= v;
+		p += n + 1;
+	}
+	printf(", zint_parse_ullong %8.3f s (%llu)\n", _bench_secs(start), sum);
+	start = clock();
+	q = text;
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		q += sprintf(q, "%llx ", vals[i]);
+	}
+	printf("%d integers in hex: sprintf %8.3f s", BENCH_ZINT_N, _bench_secs(start));
+	start = clock();
+	q = text;
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		q += zint_format_hex_ullong(vals[i], q, 0);
+		*q++ = ' ';
+	}
+	*q = '\0';
+	len = (size_t)(q - text);
+	printf(", zint_format_hex_ullong %8.3f s", _bench_secs(start));
+	start = clock();
+	sum = 0;
+	p = text;
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		sum += strtoull(p, (char**)&q, 16);
+		p = q + 1;
+	}
+	printf("; strtoull %8.3f s", _bench_secs(start));
+	start = clock();
+	p = text;
+	for (i = 0; i < BENCH_ZINT_N; i++) {
+		n = zint_parse_hex_ullong(p, len - (size_t)(p - text), &v);
+		sum -= v;
+		p += n + 1;
+	}
+	printf(", zint_parse_hex_ullong %8.3f s (%llu)\n", _bench_secs(start), sum);
+	free(vals);
+	free(text);
+}
+
+int bench_zlists() {
+	bench_zlist_append();
+	bench_zlist_arena();
+	bench_zlist_sbo();
+	bench_zhash();
+	bench_zlist_scalar_find();
+	bench_zlist_sorted();
+	bench_zring();
+	bench_zqueue();
+	bench_zcollect();
+	bench_zlist_mmap();
+	bench_zlist_sort();
+	bench_zlist_soa();
+	bench_zroaring();
+	bench_zheap();
+	bench_zbtree();
+	bench_zbloom();
+	bench_zpipe();
+	bench_zlist_aligned();
+	bench_zlist_serial();
+	bench_zlist_slice();
+	bench_zprintf();
+	bench_zint();
+	return 0;
+}
+
 int test() {
 	/*print_morelimits();*/
 	test_uint32_encode();
@@ -1391,6 +4885,32 @@ int test() {
 	test_MAX();
 	test_minmax_fast();
 	/*test_exhausterr();*/
+	test_zlist_growth();
+	test_zarena();
+	test_zlist_arena();
+	test_zlist_sbo();
+	test_zhash();
+	test_zlist_scalar_find();
+	test_zlist_sorted();
+	test_zlist_bulk();
+	test_zlist_segmented();
+	test_zring();
+	test_zqueue();
+	test_zcollect();
+	test_zlist_mmap();
+	test_zlist_sort();
+	test_zlist_soa();
+	test_zroaring();
+	test_zheap();
+	test_zbtree();
+	test_zbloom();
+	test_zpipe();
+	test_zlist_stats();
+	test_zlist_aligned();
+	test_zlist_serial();
+	test_zlist_slice();
+	test_zstrbuf();
+	test_zint();
 	return 0;
 }
 
@@ -1403,6 +4923,9 @@ int bench() {
 }
 
 int main(int argv, char**argc) {
+	if ((argv > 1) && (strcmp(argc[1], "bench") == 0)) {
+		return bench_zlists();
+	}
 	return test();
 }
 
@@ -0,0 +1,140 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#include "zarena.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct zarena_chunk {
+	zarena_chunk* prev;
+	size_t size; /* bytes of data */
+	size_t used; /* bytes of data handed out so far */
+	size_t last; /* offset of the most recent allocation */
+};
+
+/* The size of the chunk header, rounded up so that data stays aligned. */
+#define _ZARENA_HDR (((sizeof(zarena_chunk) + ZARENA_ALIGN - 1) / ZARENA_ALIGN) * ZARENA_ALIGN)
+#define _ZARENA_DATA(c) (((char*)(c)) + _ZARENA_HDR)
+/* Even a request for 0 bytes takes ZARENA_ALIGN of them, so that no two 
+   allocations share an address. */
+#define _ZARENA_ROUNDUP(x) (((x) == 0) ? (size_t)ZARENA_ALIGN : (((x) + ZARENA_ALIGN - 1) & ~((size_t)ZARENA_ALIGN - 1)))
+
+void zarena_init(zarena* const a, const size_t chunksize)
+{
+	runtime_assert(a != NULL, "You are required to pass a non-NULL pointer.");
+	a->head = NULL;
+	a->chunksize = (chunksize == 0) ? ZARENA_DEFAULT_CHUNKSIZE : chunksize;
+}
+
+static zarena_chunk* _zarena_new_chunk(zarena* const a, const size_t needed)
+{
+	size_t size = a->chunksize;
+	zarena_chunk* c;
+	if (size < needed) { size = needed; }
+	runtime_assert(size <= Z_SIZE_T_MAX - _ZARENA_HDR, "memory exhaustion");
+	c = (zarena_chunk*)malloc(_ZARENA_HDR + size);
+	runtime_assert(c != NULL, "memory exhaustion");
+	c->prev = a->head;
+	c->size = size;
+	c->used = 0;
+	c->last = 0;
+	a->head = c;
+	return c;
+}
+
+void* zarena_alloc(zarena* const a, const size_t size)
+{
+	zarena_chunk* c;
+	size_t rsize;
+	runtime_assert(a != NULL, "You are required to pass a non-NULL pointer.");
+	runtime_assert(size <= Z_SIZE_T_MAX - ZARENA_ALIGN, "memory exhaustion");
+	rsize = _ZARENA_ROUNDUP(size);
+	c = a->head;
+	if ((c == NULL) || (c->size - c->used < rsize)) {
+		c = _zarena_new_chunk(a, rsize);
+	}
+	c->last = c->used;
+	c->used += rsize;
+	return _ZARENA_DATA(c) + c->last;
+}
+
+void* zarena_realloc(zarena* const a, void* const p, const size_t oldsize, const size_t newsize)
+{
+	zarena_chunk* c;
+	void* np;
+	runtime_assert(a != NULL, "You are required to pass a non-NULL pointer.");
+	if (p == NULL) {
+		return zarena_alloc(a, newsize);
+	}
+	c = a->head;
+	runtime_assert(newsize <= Z_SIZE_T_MAX - ZARENA_ALIGN, "memory exhaustion");
+	if ((c != NULL) && (p == _ZARENA_DATA(c) + c->last) && (_ZARENA_ROUNDUP(newsize) <= c->size - c->last)) {
+		c->used = c->last + _ZARENA_ROUNDUP(newsize);
+		return p;
+	}
+	np = zarena_alloc(a, newsize);
+	memcpy(np, p, (oldsize < newsize) ? oldsize : newsize);
+	return np;
+}
+
+zarena_mark zarena_get_mark(const zarena* const a)
+{
+	zarena_mark m;
+	runtime_assert(a != NULL, "You are required to pass a non-NULL pointer.");
+	m.chunk = a->head;
+	m.used = (a->head == NULL) ? 0 : a->head->used;
+	return m;
+}
+
+void zarena_reset(zarena* const a, const zarena_mark m)
+{
+	zarena_chunk* prev;
+	runtime_assert(a != NULL, "You are required to pass a non-NULL pointer.");
+	while (a->head != m.chunk) {
+		runtime_assert(a->head != NULL, "That mark does not belong to this arena (or it was already reset past).");
+		prev = a->head->prev;
+		free(a->head);
+		a->head = prev;
+	}
+	if (a->head != NULL) {
+		a->head->used = m.used;
+		a->head->last = m.used;
+	}
+}
+
+void zarena_clear(zarena* const a)
+{
+	zarena_chunk* prev;
+	runtime_assert(a != NULL, "You are required to pass a non-NULL pointer.");
+	if (a->head == NULL) {
+		return;
+	}
+	while (a->head->prev != NULL) {
+		prev = a->head->prev;
+		a->head->prev = prev->prev;
+		free(prev);
+	}
+	a->head->used = 0;
+	a->head->last = 0;
+}
+
+void zarena_free(zarena* const a)
+{
+	zarena_mark empty;
+	empty.chunk = NULL;
+	empty.used = 0;
+	zarena_reset(a, empty);
+}
@@ -0,0 +1,92 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#ifndef __INCL_zarena_h
+#define __INCL_zarena_h
+
+#include <stddef.h>
+
+/**
+ * A zarena is a region allocator.  Allocating from it just bumps a pointer 
+ * inside the current chunk; when the chunk is used up a new chunk is malloc()'d.
+ * Nothing allocated from an arena is ever freed individually -- instead you 
+ * free everything at once with zarena_free(), or roll back to an earlier point 
+ * with zarena_reset().
+ *
+ * This is good for things which all die at the same time, such as everything 
+ * that was allocated while handling one request.
+ *
+ * Every pointer returned is aligned to ZARENA_ALIGN bytes.
+ */
+
+#define ZARENA_ALIGN 16
+#define ZARENA_DEFAULT_CHUNKSIZE (64 * 1024)
+
+typedef struct zarena_chunk zarena_chunk;
+
+typedef struct {
+	zarena_chunk* head; /* the chunk currently being allocated from */
+	size_t chunksize;
+} zarena;
+
+typedef struct {
+	zarena_chunk* chunk;
+	size_t used;
+} zarena_mark;
+
+#define ZARENA_INITIALIZER { NULL, ZARENA_DEFAULT_CHUNKSIZE }
+
+/**
+ * Initialize an empty arena.  No memory is allocated until the first 
+ * zarena_alloc().  chunksize is the size of each chunk of memory that the 
+ * arena gets from malloc(); 0 means ZARENA_DEFAULT_CHUNKSIZE.  Requests 
+ * larger than a chunk get a chunk of their own.
+ */
+void zarena_init(zarena* a, size_t chunksize);
+
+/**
+ * Returns a pointer to size bytes of uninitialized memory.  Aborts (via 
+ * runtime_assert()) on memory exhaustion.  If size is 0 the pointer is still 
+ * unique (it takes up ZARENA_ALIGN bytes of the arena), and it can be passed 
+ * to zarena_realloc() like any other.
+ */
+void* zarena_alloc(zarena* a, size_t size);
+
+/**
+ * Returns a pointer to newsize bytes whose first MIN(oldsize, newsize) bytes 
+ * are the same as those at p.  p must be NULL or the result of an allocation 
+ * from this arena of oldsize bytes.  If p was the most recent allocation and 
+ * there is room in its chunk, it is grown or shrunk in place; otherwise new 
+ * space is allocated and the old space is simply abandoned.
+ */
+void* zarena_realloc(zarena* a, void* p, size_t oldsize, size_t newsize);
+
+/**
+ * Returns a marker for the current state of the arena.  Passing it to 
+ * zarena_reset() later frees everything allocated after the mark was taken.
+ */
+zarena_mark zarena_get_mark(const zarena* a);
+void zarena_reset(zarena* a, zarena_mark m);
+
+/**
+ * Forget all allocations, but keep the most recent chunk around so that the 
+ * next round of allocations doesn't need to go to malloc().
+ */
+void zarena_clear(zarena* a);
+
+/**
+ * Free all of the memory of the arena.  The arena is left empty and ready for 
+ * reuse.  Okay to call this on an already-freed arena.
+ */
+void zarena_free(zarena* a);
+
+#endif /* #ifndef __INCL_zarena_h */
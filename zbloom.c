@@ -0,0 +1,244 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zbloom.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define ZBLOOM_MAGIC 0x5a424631UL /* "ZBF1" */
+#define _ZBLOOM_HEADER 24
+#define _ZBLOOM_BLOCK_BYTES (4 * ZBLOOM_BLOCK_WORDS)
+#define _ZBLOOM_PREFETCH 8 /* how many hashes ahead the batch functions fetch */
+
+/* Odd constants, one per word, from the Parquet spec; word i of a block gets 
+   bit ((h * salt[i]) >> 27), where h is the low half of the hash. */
+static const uint32_t _zbloom_salt[ZBLOOM_BLOCK_WORDS] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+/* The high half of the hash picks the block: (hi * nblocks) / 2^32 is 
+   uniform over the blocks without a division. */
+static uint32_t* _zbloom_block(const zbloom* const b, const uint64_t hash)
+{
+	return b->words + ZBLOOM_BLOCK_WORDS * (size_t)(((hash >> 32) * (uint64_t)b->nblocks) >> 32);
+}
+
+#if defined(__AVX2__)
+static __m256i _zbloom_mask(const uint32_t h)
+{
+	const __m256i salt = _mm256_loadu_si256((const __m256i*)_zbloom_salt);
+	const __m256i bit = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)h), salt), 27);
+	return _mm256_sllv_epi32(_mm256_set1_epi32(1), bit);
+}
+#endif
+
+static void _zbloom_set(uint32_t* const block, const uint32_t h)
+{
+#if defined(__AVX2__)
+	const __m256i v = _mm256_load_si256((const __m256i*)block);
+	_mm256_store_si256((__m256i*)block, _mm256_or_si256(v, _zbloom_mask(h)));
+#else
+	size_t i;
+	for (i = 0; i < ZBLOOM_BLOCK_WORDS; i++) {
+		block[i] |= (uint32_t)1 << ((h * _zbloom_salt[i]) >> 27);
+	}
+#endif
+}
+
+static bool _zbloom_test(const uint32_t* const block, const uint32_t h)
+{
+#if defined(__AVX2__)
+	return _mm256_testc_si256(_mm256_load_si256((const __m256i*)block), _zbloom_mask(h));
+#else
+	uint32_t miss = 0;
+	size_t i;
+	for (i = 0; i < ZBLOOM_BLOCK_WORDS; i++) {
+		miss |= ~block[i] & ((uint32_t)1 << ((h * _zbloom_salt[i]) >> 27));
+	}
+	return miss == 0;
+#endif
+}
+
+static void _zbloom_prefetch(const void* const p)
+{
+#ifdef __GNUC__
+	__builtin_prefetch(p);
+#else
+	(void)p;
+#endif
+}
+
+/* The false-positive rate with an average of lambda values per block: the 
+   number of values in a block is Poisson distributed, and with i values in 
+   it each bit of a word is set with probability 1 - (31/32)^i. */
+static double _zbloom_fpr(const double lambda)
+{
+	double p, q, fpr = 0;
+	size_t i, last;
+	if (lambda > 500) { return 1; }
+	last = (size_t)(lambda + 12 * sqrt(lambda) + 20);
+	p = exp(-lambda);
+	q = 1;
+	for (i = 0; i <= last; i++) {
+		fpr += p * pow(1 - q, ZBLOOM_BLOCK_WORDS);
+		p *= lambda / (double)(i + 1);
+		q *= 31.0 / 32.0;
+	}
+	return fpr;
+}
+
+static void _zbloom_alloc(zbloom* const b, const size_t nblocks)
+{
+	/* aligned_alloc() wants a multiple of the alignment; round up to an even 
+	   number of blocks */
+	const size_t bytes = _ZBLOOM_BLOCK_BYTES * (nblocks + (nblocks & 1));
+	runtime_assert((nblocks > 0) && (nblocks <= 0xFFFFFFFFUL) && (nblocks < Z_SIZE_T_MAX / _ZBLOOM_BLOCK_BYTES / 2), "memory exhaustion");
+	b->words = (uint32_t*)aligned_alloc(64, bytes);
+	runtime_assert(b->words != NULL, "memory exhaustion");
+	memset(b->words, 0, bytes);
+	b->nblocks = nblocks;
+	b->len = 0;
+}
+
+void zbloom_init(zbloom* const b, size_t n, const double fpr)
+{
+	size_t lo, hi, mid;
+	runtime_assert(b != NULL, "You are required to pass a non-NULL pointer.");
+	runtime_assert((fpr > 0) && (fpr < 1), "The false-positive rate must be between 0 and 1.");
+	if (n == 0) { n = 1; }
+	/* Find the fewest blocks which are good enough: double until it's 
+	   enough, then bisect. */
+	hi = 1;
+	while (_zbloom_fpr((double)n / (double)hi) > fpr) {
+		runtime_assert(hi <= 0x7FFFFFFFUL, "memory exhaustion");
+		hi *= 2;
+	}
+	lo = hi / 2;
+	while (lo + 1 < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (_zbloom_fpr((double)n / (double)mid) > fpr) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	_zbloom_alloc(b, hi);
+}
+
+void zbloom_free(zbloom* const b)
+{
+	runtime_assert(b != NULL, "You are required to pass a non-NULL pointer.");
+	free(b->words);
+	b->words = NULL;
+	b->nblocks = 0;
+	b->len = 0;
+}
+
+void zbloom_clear(zbloom* const b)
+{
+	runtime_assert(b != NULL, "You are required to pass a non-NULL pointer.");
+	if (b->words != NULL) {
+		memset(b->words, 0, _ZBLOOM_BLOCK_BYTES * b->nblocks);
+	}
+	b->len = 0;
+}
+
+void zbloom_add(zbloom* const b, const uint64_t hash)
+{
+	runtime_assert((b != NULL) && (b->words != NULL), "You are required to pass an initialized zbloom.");
+	_zbloom_set(_zbloom_block(b, hash), (uint32_t)hash);
+	b->len++;
+}
+
+bool zbloom_contains(const zbloom* const b, const uint64_t hash)
+{
+	runtime_assert((b != NULL) && (b->words != NULL), "You are required to pass an initialized zbloom.");
+	return _zbloom_test(_zbloom_block(b, hash), (uint32_t)hash);
+}
+
+void zbloom_add_batch(zbloom* const b, const uint64_t* const hashes, const size_t n)
+{
+	size_t i;
+	runtime_assert((b != NULL) && (b->words != NULL), "You are required to pass an initialized zbloom.");
+	runtime_assert((hashes != NULL) || (n == 0), "You are required to pass a non-NULL array.");
+	for (i = 0; i < n; i++) {
+		if (i + _ZBLOOM_PREFETCH < n) {
+			_zbloom_prefetch(_zbloom_block(b, hashes[i + _ZBLOOM_PREFETCH]));
+		}
+		_zbloom_set(_zbloom_block(b, hashes[i]), (uint32_t)hashes[i]);
+	}
+	b->len += n;
+}
+
+size_t zbloom_contains_batch(const zbloom* const b, const uint64_t* const hashes, const size_t n, bool* const out)
+{
+	size_t i, c = 0;
+	runtime_assert((b != NULL) && (b->words != NULL), "You are required to pass an initialized zbloom.");
+	runtime_assert(((hashes != NULL) && (out != NULL)) || (n == 0), "You are required to pass a non-NULL array.");
+	for (i = 0; i < n; i++) {
+		if (i + _ZBLOOM_PREFETCH < n) {
+			_zbloom_prefetch(_zbloom_block(b, hashes[i + _ZBLOOM_PREFETCH]));
+		}
+		out[i] = _zbloom_test(_zbloom_block(b, hashes[i]), (uint32_t)hashes[i]);
+		c += out[i];
+	}
+	return c;
+}
+
+size_t zbloom_serialized_size(const zbloom* const b)
+{
+	runtime_assert(b != NULL, "You are required to pass a non-NULL pointer.");
+	return _ZBLOOM_HEADER + _ZBLOOM_BLOCK_BYTES * b->nblocks;
+}
+
+void zbloom_serialize(const zbloom* const b, zbyte* const buf)
+{
+	size_t i;
+	runtime_assert((b != NULL) && (buf != NULL), "You are required to pass a non-NULL pointer.");
+	uint32_encode(ZBLOOM_MAGIC, buf);
+	uint32_encode(ZBLOOM_BLOCK_WORDS, buf + 4);
+	uint64_encode(b->nblocks, buf + 8);
+	uint64_encode(b->len, buf + 16);
+	for (i = 0; i < ZBLOOM_BLOCK_WORDS * b->nblocks; i++) {
+		uint32_encode(b->words[i], buf + _ZBLOOM_HEADER + 4 * i);
+	}
+}
+
+bool zbloom_deserialize(zbloom* const b, const zbyte* const buf, const size_t len)
+{
+	unsigned long long nblocks;
+	size_t i;
+	runtime_assert((b != NULL) && ((buf != NULL) || (len == 0)), "You are required to pass a non-NULL pointer.");
+	b->words = NULL;
+	b->nblocks = 0;
+	b->len = 0;
+	if ((len < _ZBLOOM_HEADER) || (uint32_decode(buf) != ZBLOOM_MAGIC) || (uint32_decode(buf + 4) != ZBLOOM_BLOCK_WORDS)) { return false; }
+	nblocks = uint64_decode(buf + 8);
+	if ((nblocks == 0) || (nblocks > (len - _ZBLOOM_HEADER) / _ZBLOOM_BLOCK_BYTES) || (nblocks * _ZBLOOM_BLOCK_BYTES != len - _ZBLOOM_HEADER)) { return false; }
+	_zbloom_alloc(b, (size_t)nblocks);
+	b->len = (size_t)uint64_decode(buf + 16);
+	for (i = 0; i < ZBLOOM_BLOCK_WORDS * b->nblocks; i++) {
+		b->words[i] = (uint32_t)uint32_decode(buf + _ZBLOOM_HEADER + 4 * i);
+	}
+	return true;
+}
@@ -0,0 +1,98 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zbloom_h
+#define __INCL_zbloom_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "zutil.h"
+
+/**
+ * A zbloom is a Bloom filter: a set which can't list its members and which 
+ * sometimes says "maybe" about a value that was never added, but never says 
+ * "no" about one that was.  Put one in front of a zlist's contains_item() or 
+ * a zhash lookup which usually misses, and most of the misses never get as 
+ * far as the expensive probe.
+ *
+ * It is "blocked": the bits are in 256-bit blocks, aligned so that none 
+ * straddles a cache line, and all of the bits for one value are in the same 
+ * block -- one bit in each of the block's eight 32-bit words (the "split 
+ * block" layout of Apache Parquet and Impala).  So adding or testing a value 
+ * touches one cache line, and with AVX2 it is a handful of instructions: 
+ * one multiply makes the eight bit positions and one vptest checks them all.  
+ * The price is a somewhat higher false-positive rate for the same number of 
+ * bits, which zbloom_init() allows for when it sizes the filter.
+ *
+ * The filter works on 64-bit hashes rather than on values, so that the same 
+ * filter serves any type.  The hashes must be well mixed in all 64 bits -- 
+ * use zhash_u64() or zhash_bytes() from zhash.h.
+ */
+
+#define ZBLOOM_BLOCK_WORDS 8 /* 32-bit words in a block */
+
+typedef struct {
+	uint32_t* words; /* nblocks * ZBLOOM_BLOCK_WORDS of them */
+	size_t nblocks;
+	size_t len; /* number of hashes added */
+} zbloom;
+
+#define ZBLOOM_INITIALIZER { NULL, 0, 0 }
+
+/**
+ * Size b for n values with a false-positive rate of at most fpr (e.g. 0.01) 
+ * once all n have been added, and make it empty.  b need not be initialized.  
+ * About 10 bits per value for fpr = 0.01, 15 for 0.001.
+ */
+void zbloom_init(zbloom* b, size_t n, double fpr);
+void zbloom_free(zbloom* b);
+
+/**
+ * Remove everything, keeping the size.
+ */
+void zbloom_clear(zbloom* b);
+
+void zbloom_add(zbloom* b, uint64_t hash);
+
+/**
+ * Returns false if hash was certainly never added, true if it may have been.
+ */
+bool zbloom_contains(const zbloom* b, uint64_t hash);
+
+/**
+ * The same as calling zbloom_add() or zbloom_contains() on each of the n 
+ * hashes, but faster for large filters, since they fetch the blocks for the 
+ * hashes several steps ahead and so wait on many cache misses at once.  
+ * zbloom_contains_batch() sets out[i] to zbloom_contains(b, hashes[i]) and 
+ * returns how many of them are true.
+ */
+void zbloom_add_batch(zbloom* b, const uint64_t* hashes, size_t n);
+size_t zbloom_contains_batch(const zbloom* b, const uint64_t* hashes, size_t n, bool* out);
+
+/**
+ * The serialized form is a 24-byte header (a magic number, the number of 
+ * bits set per value, the number of blocks and the number of hashes added) 
+ * followed by the words, all big-endian as written by uint32_encode() and 
+ * uint64_encode() in zutil.h, so it reads back the same on any machine.
+ *
+ * zbloom_serialized_size() returns the number of bytes zbloom_serialize() 
+ * will write to buf.  zbloom_deserialize() makes b a copy of the filter 
+ * serialized in the len bytes at buf; b need not be initialized.  It returns 
+ * false, leaving b empty, if buf doesn't hold a well-formed serialized filter.
+ */
+size_t zbloom_serialized_size(const zbloom* b);
+void zbloom_serialize(const zbloom* b, zbyte* buf);
+bool zbloom_deserialize(zbloom* b, const zbyte* buf, size_t len);
+
+#endif /* #ifndef __INCL_zbloom_h */
@@ -0,0 +1,124 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#include <string.h>
+
+#include "zbtree.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static size_t _zbtree_popcount(unsigned m)
+{
+#ifdef __GNUC__
+	return (size_t)__builtin_popcount(m);
+#else
+	size_t c = 0;
+	for (; m != 0; m &= m - 1) { c++; }
+	return c;
+#endif
+}
+
+/* Since the keys are sorted, the rank is just a count: of the keys below k, 
+   or, if inclusive, n minus the count of keys above k.  Either way every 
+   step is a compare-greater, with the operands swapped for the first case.  
+   Unsigned keys have their top bits flipped by bias so that a signed 
+   comparison orders them correctly.  The keys may be in an array of any 
+   4-byte (or 8-byte) integer type, so the scalar loop reads them with 
+   memcpy. */
+static size_t _zbtree_rank32(const void* const keys, const size_t n, const int32_t k, const bool inclusive, const uint32_t bias)
+{
+	const unsigned char* const p = (const unsigned char*)keys;
+	size_t i = 0, c = 0;
+	uint32_t x;
+	int32_t y;
+#if defined(__AVX2__)
+	const __m256i vk = _mm256_set1_epi32(k);
+	const __m256i vb = _mm256_set1_epi32((int32_t)bias);
+	for (; i + 8 <= n; i += 8) {
+		const __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(p + 4 * i)), vb);
+		const __m256i m = inclusive ? _mm256_cmpgt_epi32(v, vk) : _mm256_cmpgt_epi32(vk, v);
+		c += _zbtree_popcount((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+	}
+#elif defined(__SSE2__)
+	const __m128i vk = _mm_set1_epi32(k);
+	const __m128i vb = _mm_set1_epi32((int32_t)bias);
+	for (; i + 4 <= n; i += 4) {
+		const __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p + 4 * i)), vb);
+		const __m128i m = inclusive ? _mm_cmpgt_epi32(v, vk) : _mm_cmpgt_epi32(vk, v);
+		c += _zbtree_popcount((unsigned)_mm_movemask_ps(_mm_castsi128_ps(m)));
+	}
+#endif
+	for (; i < n; i++) {
+		memcpy(&x, p + 4 * i, 4);
+		y = (int32_t)(x ^ bias);
+		c += inclusive ? (y > k) : (y < k);
+	}
+	return inclusive ? n - c : c;
+}
+
+static size_t _zbtree_rank64(const void* const keys, const size_t n, const int64_t k, const bool inclusive, const uint64_t bias)
+{
+	const unsigned char* const p = (const unsigned char*)keys;
+	size_t i = 0, c = 0;
+	uint64_t x;
+	int64_t y;
+#if defined(__AVX2__)
+	const __m256i vk = _mm256_set1_epi64x(k);
+	const __m256i vb = _mm256_set1_epi64x((int64_t)bias);
+	for (; i + 4 <= n; i += 4) {
+		const __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(p + 8 * i)), vb);
+		const __m256i m = inclusive ? _mm256_cmpgt_epi64(v, vk) : _mm256_cmpgt_epi64(vk, v);
+		c += _zbtree_popcount((unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+	}
+#elif defined(__SSE4_2__)
+	const __m128i vk = _mm_set1_epi64x(k);
+	const __m128i vb = _mm_set1_epi64x((int64_t)bias);
+	for (; i + 2 <= n; i += 2) {
+		const __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p + 8 * i)), vb);
+		const __m128i m = inclusive ? _mm_cmpgt_epi64(v, vk) : _mm_cmpgt_epi64(vk, v);
+		c += _zbtree_popcount((unsigned)_mm_movemask_pd(_mm_castsi128_pd(m)));
+	}
+#endif
+	for (; i < n; i++) {
+		memcpy(&x, p + 8 * i, 8);
+		y = (int64_t)(x ^ bias);
+		c += inclusive ? (y > k) : (y < k);
+	}
+	return inclusive ? n - c : c;
+}
+
+size_t _zbtree_rank_i32(const void* const keys, const size_t n, const int32_t k, const bool inclusive)
+{
+	return _zbtree_rank32(keys, n, k, inclusive, 0);
+}
+
+size_t _zbtree_rank_u32(const void* const keys, const size_t n, const uint32_t k, const bool inclusive)
+{
+	return _zbtree_rank32(keys, n, (int32_t)(k ^ 0x80000000UL), inclusive, 0x80000000UL);
+}
+
+size_t _zbtree_rank_i64(const void* const keys, const size_t n, const int64_t k, const bool inclusive)
+{
+	return _zbtree_rank64(keys, n, k, inclusive, 0);
+}
+
+size_t _zbtree_rank_u64(const void* const keys, const size_t n, const uint64_t k, const bool inclusive)
+{
+	return _zbtree_rank64(keys, n, (int64_t)(k ^ 0x8000000000000000ULL), inclusive, 0x8000000000000000ULL);
+}
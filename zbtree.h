@@ -0,0 +1,104 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zbtree_h
+#define __INCL_zbtree_h
+
+#include "zutil.h"
+
+#include "zbtreeimp.h" /* implementation stuff that you needn't look at in order to use this */
+
+/**
+ * Ordered maps from integer keys to values, as B+trees which live entirely in 
+ * memory.  Use one instead of a sorted zlist when there are too many keys to 
+ * memmove on every insertion; use a zhash instead if you never need the keys 
+ * in order.
+ *
+ * The keys of each node fill ZBTREE_NODE_BYTES (four cache lines), aligned to 
+ * a cache line and stored apart from the values and child pointers, so that 
+ * searching a node reads only those four lines.  The search doesn't branch: 
+ * it counts the keys less than the one sought, 8 (AVX2) or 4 (SSE2) 32-bit 
+ * keys at a time, or 4 (AVX2) or 2 (SSE4.2) 64-bit keys at a time, and falls 
+ * back to a plain loop for other widths or without those instructions.  The 
+ * values live only in the leaves, which are linked both ways for range scans.
+ *
+ * For example:
+ *
+ * DECLARE_ZBTREE(int, double, zbtreeid)
+ *
+ * declares the types zbtreeid, zbtreeid_iter, zbtreeid_leaf and 
+ * zbtreeid_inner (you needn't look inside the last three) and the following 
+ * functions:
+ *
+ * bool zbtreeid_put(zbtreeid* t, int key, double val);
+ * double* zbtreeid_get(const zbtreeid* t, int key);
+ * bool zbtreeid_contains(const zbtreeid* t, int key);
+ * bool zbtreeid_remove(zbtreeid* t, int key);
+ * void zbtreeid_bulk_load(zbtreeid* t, const int* keys, const double* vals, size_t n);
+ * void zbtreeid_range(const zbtreeid* t, int lo, int hi, zbtreeid_iter* it);
+ * void zbtreeid_range_rev(const zbtreeid* t, int lo, int hi, zbtreeid_iter* it);
+ * bool zbtreeid_iter_next(zbtreeid_iter* it, int* key, double* val);
+ * void zbtreeid_free(zbtreeid* t);
+ *
+ * and DEFINE_ZBTREE(int, double, zbtreeid) defines them.  The key type must 
+ * be an integer type.  t->len is the number of keys in the tree.  Initialize a 
+ * new tree with ZBTREE_INITIALIZER (or any other way of zeroing it).
+ *
+ * Here is the documentation for each of these functions:
+ *
+ * bool nam_put(nam* t, ktyp key, vtyp val):
+ *     Map key to val, replacing any previous value.  Returns true iff key was 
+ *     not already in the tree.  O(log len).
+ *
+ * vtyp* nam_get(const nam* t, ktyp key):
+ *     Returns a pointer to the value for key, or NULL if key isn't present.  
+ *     The pointer is good until the next put() or remove().
+ *
+ * bool nam_contains(const nam* t, ktyp key):
+ *     Returns true iff key is present.
+ *
+ * bool nam_remove(nam* t, ktyp key):
+ *     Remove key.  Returns true iff it was present.  Nodes are never merged, 
+ *     so a tree which has had most of its keys removed takes more memory and 
+ *     scans more slowly than it needs to; bulk_load() a fresh one if that 
+ *     matters.
+ *
+ * void nam_bulk_load(nam* t, const ktyp* keys, const vtyp* vals, size_t n):
+ *     Replace the contents of t with the n keys and values, which must be 
+ *     sorted by key with no duplicates.  The leaves are packed full, so this 
+ *     is much faster than n puts and makes a smaller tree.  O(n).
+ *
+ * void nam_range(const nam* t, ktyp lo, ktyp hi, nam_iter* it):
+ * void nam_range_rev(const nam* t, ktyp lo, ktyp hi, nam_iter* it):
+ *     Set it up to visit the keys k with lo <= k <= hi, in ascending order 
+ *     (range) or descending order (range_rev).
+ *
+ * bool nam_iter_next(nam_iter* it, ktyp* key, vtyp* val):
+ *     Store the next key and its value through key and val (either of which 
+ *     may be NULL) and return true, or return false if there are no more.  
+ *     The tree must not change during the iteration.  For example:
+ *
+ *     zbtreeid_iter it;
+ *     int k;
+ *     double v;
+ *     zbtreeid_range(&t, 100, 200, &it);
+ *     while (zbtreeid_iter_next(&it, &k, &v)) {
+ *         ...
+ *     }
+ *
+ * void nam_free(nam* t):
+ *     Free all of the nodes and leave t as an empty tree.  Okay to call this 
+ *     on an already-freed tree.
+ */
+
+#endif /* #ifndef __INCL_zbtree_h */
@@ -0,0 +1,408 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zbtreeimp_h
+#define __INCL_zbtreeimp_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+#define ZBTREE_CACHELINE 64
+#define ZBTREE_NODE_BYTES (4 * ZBTREE_CACHELINE)
+#define ZBTREE_INITIALIZER {0}
+
+/* Even half-full nodes of the narrowest fan-out (32 keys) can't get this 
+   deep in a 64-bit address space. */
+#define ZBTREE_MAX_HEIGHT 24
+
+/* The number of the n sorted keys which are less than k, or less than or 
+   equal to k if inclusive.  These are in zbtree.c. */
+size_t _zbtree_rank_i32(const void* keys, size_t n, int32_t k, bool inclusive);
+size_t _zbtree_rank_u32(const void* keys, size_t n, uint32_t k, bool inclusive);
+size_t _zbtree_rank_i64(const void* keys, size_t n, int64_t k, bool inclusive);
+size_t _zbtree_rank_u64(const void* keys, size_t n, uint64_t k, bool inclusive);
+
+#define DECLARE_ZBTREE(ktyp, vtyp, nam) \
+enum { nam##_KEYS = ZBTREE_NODE_BYTES / sizeof(ktyp) }; \
+typedef struct nam##_leaf { \
+	_Alignas(ZBTREE_CACHELINE) ktyp keys[nam##_KEYS]; \
+	vtyp vals[nam##_KEYS]; \
+	size_t n; \
+	struct nam##_leaf* prev; \
+	struct nam##_leaf* next; \
+} nam##_leaf; \
+typedef struct { \
+	_Alignas(ZBTREE_CACHELINE) ktyp keys[nam##_KEYS]; \
+	size_t n; \
+	void* kids[nam##_KEYS + 1]; \
+} nam##_inner; \
+typedef struct { \
+	void* root; \
+	size_t height; \
+	size_t len; \
+	nam##_leaf* first; \
+	nam##_leaf* last; \
+} nam; \
+typedef struct { \
+	const nam##_leaf* leaf; \
+	size_t i; \
+	ktyp bound; \
+	bool reverse; \
+} nam##_iter; \
+bool nam##_put(nam* t, ktyp key, vtyp val); \
+vtyp* nam##_get(const nam* t, ktyp key); \
+bool nam##_contains(const nam* t, ktyp key); \
+bool nam##_remove(nam* t, ktyp key); \
+void nam##_bulk_load(nam* t, const ktyp* keys, const vtyp* vals, size_t n); \
+void nam##_range(const nam* t, ktyp lo, ktyp hi, nam##_iter* it); \
+void nam##_range_rev(const nam* t, ktyp lo, ktyp hi, nam##_iter* it); \
+bool nam##_iter_next(nam##_iter* it, ktyp* key, vtyp* val); \
+void nam##_free(nam* t);
+
+/* An inner node with n keys has n+1 kids; kids[i] holds the keys k with 
+   keys[i-1] <= k < keys[i].  The height of a tree whose root is a leaf is 0. 
+   The conditions on sizeof(ktyp) are constant, so each instantiation 
+   compiles down to a single call of the right search. */
+#define DEFINE_ZBTREE(ktyp, vtyp, nam) \
+static size_t _##nam##_rank(const ktyp*const keys, const size_t n, const ktyp k, const bool inclusive) { \
+	size_t i, c = 0; \
+	if (sizeof(ktyp) == 4) { \
+		if ((ktyp)-1 < (ktyp)0) { return _zbtree_rank_i32(keys, n, (int32_t)k, inclusive); } \
+		return _zbtree_rank_u32(keys, n, (uint32_t)k, inclusive); \
+	} \
+	if (sizeof(ktyp) == 8) { \
+		if ((ktyp)-1 < (ktyp)0) { return _zbtree_rank_i64(keys, n, (int64_t)k, inclusive); } \
+		return _zbtree_rank_u64(keys, n, (uint64_t)k, inclusive); \
+	} \
+	for (i = 0; i < n; i++) { \
+		c += inclusive ? (keys[i] <= k) : (keys[i] < k); \
+	} \
+	return c; \
+} \
+ \
+static void* _##nam##_alloc(const size_t size) { \
+	void*const p = aligned_alloc(ZBTREE_CACHELINE, size); \
+	runtime_assert(p != NULL, "memory exhaustion"); \
+	return p; \
+} \
+ \
+static nam##_leaf* _##nam##_new_leaf(void) { \
+	nam##_leaf*const leaf = (nam##_leaf*)_##nam##_alloc(sizeof(nam##_leaf)); \
+	leaf->n = 0; \
+	leaf->prev = NULL; \
+	leaf->next = NULL; \
+	return leaf; \
+} \
+ \
+static nam##_leaf* _##nam##_find_leaf(const nam*const t, const ktyp key) { \
+	void* node = t->root; \
+	size_t h; \
+	for (h = t->height; h > 0; h--) { \
+		const nam##_inner*const in = (const nam##_inner*)node; \
+		node = in->kids[_##nam##_rank(in->keys, in->n, key, 1)]; \
+	} \
+	return (nam##_leaf*)node; \
+} \
+ \
+bool nam##_put(nam*const t, const ktyp key, const vtyp val) { \
+	nam##_inner* path[ZBTREE_MAX_HEIGHT]; \
+	size_t slot[ZBTREE_MAX_HEIGHT]; \
+	ktyp ck[nam##_KEYS + 1]; \
+	void* cp[nam##_KEYS + 2]; \
+	void* node; \
+	void* newkid = NULL; \
+	nam##_leaf* leaf; \
+	nam##_leaf* right; \
+	nam##_inner* in; \
+	nam##_inner* rin; \
+	ktyp sep = key; \
+	size_t h, i, j; \
+	runtime_assert(t != NULL, "You are required to pass a non-NULL pointer."); \
+	if (t->root == NULL) { \
+		leaf = _##nam##_new_leaf(); \
+		t->root = leaf; \
+		t->first = leaf; \
+		t->last = leaf; \
+		t->height = 0; \
+	} \
+	node = t->root; \
+	for (h = t->height; h > 0; h--) { \
+		in = (nam##_inner*)node; \
+		i = _##nam##_rank(in->keys, in->n, key, 1); \
+		path[h-1] = in; \
+		slot[h-1] = i; \
+		node = in->kids[i]; \
+	} \
+	leaf = (nam##_leaf*)node; \
+	i = _##nam##_rank(leaf->keys, leaf->n, key, 0); \
+	if ((i < leaf->n) && (leaf->keys[i] == key)) { \
+		leaf->vals[i] = val; \
+		return 0; \
+	} \
+	if (leaf->n == nam##_KEYS) { \
+		/* Split the leaf in half and hand the right half's first key up. */ \
+		right = _##nam##_new_leaf(); \
+		j = nam##_KEYS / 2; \
+		right->n = nam##_KEYS - j; \
+		memcpy(right->keys, leaf->keys + j, sizeof(ktyp) * right->n); \
+		memcpy(right->vals, leaf->vals + j, sizeof(vtyp) * right->n); \
+		leaf->n = j; \
+		right->prev = leaf; \
+		right->next = leaf->next; \
+		if (leaf->next != NULL) { \
+			leaf->next->prev = right; \
+		} else { \
+			t->last = right; \
+		} \
+		leaf->next = right; \
+		sep = right->keys[0]; \
+		newkid = right; \
+		if (i > j) { \
+			leaf = right; \
+			i -= j; \
+		} \
+	} \
+	memmove(leaf->keys + i + 1, leaf->keys + i, sizeof(ktyp) * (leaf->n - i)); \
+	memmove(leaf->vals + i + 1, leaf->vals + i, sizeof(vtyp) * (leaf->n - i)); \
+	leaf->keys[i] = key; \
+	leaf->vals[i] = val; \
+	leaf->n++; \
+	t->len++; \
+	for (h = 0; newkid != NULL; h++) { \
+		if (h == t->height) { \
+			runtime_assert(t->height + 1 < ZBTREE_MAX_HEIGHT, "zbtree too deep"); \
+			in = (nam##_inner*)_##nam##_alloc(sizeof(nam##_inner)); \
+			in->n = 1; \
+			in->keys[0] = sep; \
+			in->kids[0] = t->root; \
+			in->kids[1] = newkid; \
+			t->root = in; \
+			t->height++; \
+			break; \
+		} \
+		in = path[h]; \
+		i = slot[h]; \
+		if (in->n < nam##_KEYS) { \
+			memmove(in->keys + i + 1, in->keys + i, sizeof(ktyp) * (in->n - i)); \
+			memmove(in->kids + i + 2, in->kids + i + 1, sizeof(void*) * (in->n - i)); \
+			in->keys[i] = sep; \
+			in->kids[i+1] = newkid; \
+			in->n++; \
+			break; \
+		} \
+		/* Lay the full node plus the new key out in ck/cp, keep the left \
+		   half, move the right half to a new node, and hand the middle \
+		   key up. */ \
+		memcpy(ck, in->keys, sizeof(ktyp) * i); \
+		ck[i] = sep; \
+		memcpy(ck + i + 1, in->keys + i, sizeof(ktyp) * (nam##_KEYS - i)); \
+		memcpy(cp, in->kids, sizeof(void*) * (i + 1)); \
+		cp[i+1] = newkid; \
+		memcpy(cp + i + 2, in->kids + i + 1, sizeof(void*) * (nam##_KEYS - i)); \
+		j = (nam##_KEYS + 1) / 2; \
+		rin = (nam##_inner*)_##nam##_alloc(sizeof(nam##_inner)); \
+		in->n = j; \
+		memcpy(in->keys, ck, sizeof(ktyp) * j); \
+		memcpy(in->kids, cp, sizeof(void*) * (j + 1)); \
+		rin->n = nam##_KEYS - j; \
+		memcpy(rin->keys, ck + j + 1, sizeof(ktyp) * rin->n); \
+		memcpy(rin->kids, cp + j + 1, sizeof(void*) * (rin->n + 1)); \
+		sep = ck[j]; \
+		newkid = rin; \
+	} \
+	return 1; \
+} \
+ \
+vtyp* nam##_get(const nam*const t, const ktyp key) { \
+	nam##_leaf* leaf; \
+	size_t i; \
+	runtime_assert(t != NULL, "You are required to pass a non-NULL pointer."); \
+	if (t->root == NULL) { return NULL; } \
+	leaf = _##nam##_find_leaf(t, key); \
+	i = _##nam##_rank(leaf->keys, leaf->n, key, 0); \
+	if ((i < leaf->n) && (leaf->keys[i] == key)) { return &leaf->vals[i]; } \
+	return NULL; \
+} \
+ \
+bool nam##_contains(const nam*const t, const ktyp key) { \
+	return nam##_get(t, key) != NULL; \
+} \
+ \
+bool nam##_remove(nam*const t, const ktyp key) { \
+	nam##_leaf* leaf; \
+	size_t i; \
+	runtime_assert(t != NULL, "You are required to pass a non-NULL pointer."); \
+	if (t->root == NULL) { return 0; } \
+	leaf = _##nam##_find_leaf(t, key); \
+	i = _##nam##_rank(leaf->keys, leaf->n, key, 0); \
+	if ((i >= leaf->n) || (leaf->keys[i] != key)) { return 0; } \
+	memmove(leaf->keys + i, leaf->keys + i + 1, sizeof(ktyp) * (leaf->n - i - 1)); \
+	memmove(leaf->vals + i, leaf->vals + i + 1, sizeof(vtyp) * (leaf->n - i - 1)); \
+	leaf->n--; \
+	t->len--; \
+	return 1; \
+} \
+ \
+static void _##nam##_free_node(void*const node, const size_t height) { \
+	size_t i; \
+	if (height > 0) { \
+		nam##_inner*const in = (nam##_inner*)node; \
+		for (i = 0; i <= in->n; i++) { \
+			_##nam##_free_node(in->kids[i], height - 1); \
+		} \
+	} \
+	free(node); \
+} \
+ \
+void nam##_free(nam*const t) { \
+	runtime_assert(t != NULL, "You are required to pass a non-NULL pointer."); \
+	if (t->root != NULL) { \
+		_##nam##_free_node(t->root, t->height); \
+	} \
+	t->root = NULL; \
+	t->height = 0; \
+	t->len = 0; \
+	t->first = NULL; \
+	t->last = NULL; \
+} \
+ \
+/* Build the tree bottom up: spread the keys evenly over as few full leaves \
+   as will hold them, then do the same with each level of inner nodes until \
+   one node is left.  nodes[] and mins[] hold the current level's nodes and \
+   the smallest key under each. */ \
+void nam##_bulk_load(nam*const t, const ktyp*const keys, const vtyp*const vals, const size_t n) { \
+	void** nodes; \
+	ktyp* mins; \
+	size_t count, parents, per, extra, i, j, at; \
+	nam##_leaf* leaf; \
+	nam##_leaf* prev = NULL; \
+	nam##_inner* in; \
+	runtime_assert(t != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert((n == 0) || ((keys != NULL) && (vals != NULL)), "You are required to pass a non-NULL array."); \
+	for (i = 1; i < n; i++) { \
+		runtime_assert(keys[i-1] < keys[i], "The keys must be sorted and unique."); \
+	} \
+	nam##_free(t); \
+	if (n == 0) { return; } \
+	count = (n + nam##_KEYS - 1) / nam##_KEYS; \
+	nodes = (void**)malloc(sizeof(void*) * count); \
+	mins = (ktyp*)malloc(sizeof(ktyp) * count); \
+	runtime_assert((nodes != NULL) && (mins != NULL), "memory exhaustion"); \
+	per = n / count; \
+	extra = n % count; \
+	at = 0; \
+	for (i = 0; i < count; i++) { \
+		leaf = _##nam##_new_leaf(); \
+		leaf->n = per + (i < extra); \
+		memcpy(leaf->keys, keys + at, sizeof(ktyp) * leaf->n); \
+		memcpy(leaf->vals, vals + at, sizeof(vtyp) * leaf->n); \
+		at += leaf->n; \
+		leaf->prev = prev; \
+		if (prev != NULL) { \
+			prev->next = leaf; \
+		} else { \
+			t->first = leaf; \
+		} \
+		prev = leaf; \
+		nodes[i] = leaf; \
+		mins[i] = leaf->keys[0]; \
+	} \
+	t->last = prev; \
+	while (count > 1) { \
+		runtime_assert(t->height + 1 < ZBTREE_MAX_HEIGHT, "zbtree too deep"); \
+		parents = (count + nam##_KEYS) / (nam##_KEYS + 1); \
+		per = count / parents; \
+		extra = count % parents; \
+		at = 0; \
+		for (i = 0; i < parents; i++) { \
+			in = (nam##_inner*)_##nam##_alloc(sizeof(nam##_inner)); \
+			in->n = per + (i < extra) - 1; \
+			for (j = 0; j <= in->n; j++) { \
+				in->kids[j] = nodes[at + j]; \
+				if (j > 0) { \
+					in->keys[j-1] = mins[at + j]; \
+				} \
+			} \
+			mins[i] = mins[at]; \
+			nodes[i] = in; \
+			at += in->n + 1; \
+		} \
+		count = parents; \
+		t->height++; \
+	} \
+	t->root = nodes[0]; \
+	t->len = n; \
+	free(nodes); \
+	free(mins); \
+} \
+ \
+void nam##_range(const nam*const t, const ktyp lo, const ktyp hi, nam##_iter*const it) { \
+	runtime_assert((t != NULL) && (it != NULL), "You are required to pass a non-NULL pointer."); \
+	it->reverse = 0; \
+	it->bound = hi; \
+	it->leaf = NULL; \
+	it->i = 0; \
+	if ((t->root != NULL) && (lo <= hi)) { \
+		it->leaf = _##nam##_find_leaf(t, lo); \
+		it->i = _##nam##_rank(it->leaf->keys, it->leaf->n, lo, 0); \
+	} \
+} \
+ \
+/* Going backwards, it->i is one past the next index, so that it never has \
+   to go below 0. */ \
+void nam##_range_rev(const nam*const t, const ktyp lo, const ktyp hi, nam##_iter*const it) { \
+	runtime_assert((t != NULL) && (it != NULL), "You are required to pass a non-NULL pointer."); \
+	it->reverse = 1; \
+	it->bound = lo; \
+	it->leaf = NULL; \
+	it->i = 0; \
+	if ((t->root != NULL) && (lo <= hi)) { \
+		it->leaf = _##nam##_find_leaf(t, hi); \
+		it->i = _##nam##_rank(it->leaf->keys, it->leaf->n, hi, 1); \
+	} \
+} \
+ \
+bool nam##_iter_next(nam##_iter*const it, ktyp*const key, vtyp*const val) { \
+	size_t i; \
+	runtime_assert(it != NULL, "You are required to pass a non-NULL pointer."); \
+	if (!it->reverse) { \
+		while ((it->leaf != NULL) && (it->i >= it->leaf->n)) { \
+			it->leaf = it->leaf->next; \
+			it->i = 0; \
+		} \
+		if ((it->leaf == NULL) || (it->leaf->keys[it->i] > it->bound)) { \
+			it->leaf = NULL; \
+			return 0; \
+		} \
+		i = it->i++; \
+	} else { \
+		while ((it->leaf != NULL) && (it->i == 0)) { \
+			it->leaf = it->leaf->prev; \
+			it->i = (it->leaf != NULL) ? it->leaf->n : 0; \
+		} \
+		if ((it->leaf == NULL) || (it->leaf->keys[it->i - 1] < it->bound)) { \
+			it->leaf = NULL; \
+			return 0; \
+		} \
+		i = --it->i; \
+	} \
+	if (key != NULL) { *key = it->leaf->keys[i]; } \
+	if (val != NULL) { *val = it->leaf->vals[i]; } \
+	return 1; \
+}
+
+#endif /* #ifndef __INCL_zbtreeimp_h */
@@ -0,0 +1,76 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#include <pthread.h>
+#include <string.h>
+
+#include "zcollect.h"
+
+typedef struct {
+	unsigned char* dst;
+	const void*const* srcs;
+	const size_t* lens;
+	size_t n;
+	size_t width;
+	size_t from; /* byte offset into the concatenation */
+	size_t to;
+} _zcollect_job;
+
+static void* _zcollect_copy_range(void* arg)
+{
+	const _zcollect_job* const j = (const _zcollect_job*)arg;
+	size_t i, start = 0, bytes, lo, hi;
+	for (i = 0; (i < j->n) && (start < j->to); i++) {
+		bytes = j->lens[i] * j->width;
+		lo = (j->from > start) ? j->from : start;
+		hi = (j->to < start + bytes) ? j->to : start + bytes;
+		if (lo < hi) {
+			memcpy(j->dst + lo, (const unsigned char*)j->srcs[i] + (lo - start), hi - lo);
+		}
+		start += bytes;
+	}
+	return NULL;
+}
+
+void _zcollect_parallel_copy(void* const dst, const void*const* const srcs, const size_t* const lens, const size_t n, const size_t width, const size_t nworkers)
+{
+	_zcollect_job* jobs;
+	pthread_t* threads;
+	size_t i, total = 0;
+	for (i = 0; i < n; i++) {
+		total += lens[i] * width;
+	}
+	jobs = (_zcollect_job*)malloc(sizeof(_zcollect_job) * nworkers);
+	threads = (pthread_t*)malloc(sizeof(pthread_t) * nworkers);
+	runtime_assert((jobs != NULL) && (threads != NULL), "memory exhaustion");
+	for (i = 0; i < nworkers; i++) {
+		jobs[i].dst = (unsigned char*)dst;
+		jobs[i].srcs = srcs;
+		jobs[i].lens = lens;
+		jobs[i].n = n;
+		jobs[i].width = width;
+		/* split on element boundaries so that no element is torn between workers */
+		jobs[i].from = total / width * i / nworkers * width;
+		jobs[i].to = total / width * (i + 1) / nworkers * width;
+	}
+	/* the calling thread does the first share itself */
+	for (i = 1; i < nworkers; i++) {
+		runtime_assert(pthread_create(&threads[i], NULL, _zcollect_copy_range, &jobs[i]) == 0, "failed to create a thread");
+	}
+	_zcollect_copy_range(&jobs[0]);
+	for (i = 1; i < nworkers; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(jobs);
+	free(threads);
+}
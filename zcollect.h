@@ -0,0 +1,73 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zcollect_h
+#define __INCL_zcollect_h
+
+#include "zutil.h"
+
+#include "zcollectimp.h" /* implementation stuff that you needn't look at in order to use this */
+
+/**
+ * A collector lets several threads append to what is logically one zlist 
+ * without a lock.  Each thread appends to its own private zlist, and these 
+ * private lists are each on their own cache lines so that the threads don't 
+ * fight over the lines holding each other's len and arr.  When the threads 
+ * are done, merge() concatenates the private lists onto a real zlist, 
+ * optionally copying with several threads.
+ *
+ * Threads are identified by a small integer tid from 0 to nthreads-1 which 
+ * you assign yourself, e.g. the index of the worker in your thread pool.  No 
+ * two threads may use the same tid at the same time.
+ *
+ * DECLARE_ZCOLLECT(typ, lnam, nam) declares the type nam and the following 
+ * functions, and DEFINE_ZCOLLECT(typ, lnam, nam) defines them.  lnam must be 
+ * a zlist of typ which has already been declared and defined with 
+ * DECLARE_ZLIST() and DEFINE_ZLIST().
+ *
+ * void nam_init(nam* c, size_t nthreads):
+ *     Make c an empty collector for threads 0 to nthreads-1.
+ *
+ * lnam* nam_local(nam* c, size_t tid):
+ *     Returns thread tid's private list, for when you want to use the other 
+ *     zlist functions (extend(), reserve(), ...) on it directly.
+ *
+ * void nam_append(nam* c, size_t tid, typ item):
+ *     (thread tid only) Append item to thread tid's private list.
+ *
+ * size_t nam_len(const nam* c):
+ *     Returns the total number of items collected.  Not safe to call while 
+ *     other threads are appending.
+ *
+ * void nam_merge(nam* c, lnam* out, bool ordered, size_t nworkers):
+ *     (no other thread may be appending) Append all the collected items to 
+ *     out and empty the private lists.  If ordered, the items from thread 0 
+ *     come first, then those from thread 1, and so on.  The items from any one 
+ *     thread always stay in the order in which that thread appended them.  If 
+ *     not ordered and out is empty, then instead of being copied the largest 
+ *     private list's array is handed over to out and the others are appended 
+ *     after it.  If nworkers is greater than 1, the copying is split between 
+ *     that many threads, which only pays off for many megabytes of items.
+ *
+ * void nam_clear(nam* c):
+ *     Empty all the private lists but keep their memory.
+ *
+ * void nam_free(nam* c):
+ *     Free all the memory.
+ *
+ * Note that the private lists keep their capacity across merge() and 
+ * clear(), so reusing a collector for the next batch of work usually doesn't 
+ * call the allocator at all.
+ */
+
+#endif /* #ifndef __INCL_zcollect_h */
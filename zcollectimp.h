@@ -0,0 +1,146 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zcollectimp_h
+#define __INCL_zcollectimp_h
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "moreassert.h"
+#include "morelimits.h"
+#include "zlist.h"
+
+#define ZCOLLECT_CACHELINE 64
+
+/* Copy the concatenation of the n arrays srcs[i] (of lens[i] elements of 
+   width bytes each) to dst, splitting the bytes evenly between nworkers 
+   threads. */
+void _zcollect_parallel_copy(void* dst, const void*const* srcs, const size_t* lens, size_t n, size_t width, size_t nworkers);
+
+#define DECLARE_ZCOLLECT(typ, lnam, nam) \
+typedef struct { \
+	_Alignas(ZCOLLECT_CACHELINE) lnam l; \
+} nam##_slot; \
+typedef struct { \
+	size_t nthreads; \
+	nam##_slot* slots; \
+} nam; \
+void nam##_init(nam* c, size_t nthreads); \
+lnam* nam##_local(nam* c, size_t tid); \
+void nam##_append(nam* c, size_t tid, typ item); \
+size_t nam##_len(const nam* c); \
+void nam##_merge(nam* c, lnam* out, bool ordered, size_t nworkers); \
+void nam##_clear(nam* c); \
+void nam##_free(nam* c);
+
+#define DEFINE_ZCOLLECT(typ, lnam, nam) \
+void nam##_init(nam*const c, const size_t nthreads) { \
+	size_t i; \
+	runtime_assert(c != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(nthreads > 0, "You are required to pass a positive number of threads."); \
+	runtime_assert(nthreads <= Z_SIZE_T_MAX / sizeof(nam##_slot), "memory exhaustion"); \
+	c->slots = (nam##_slot*)aligned_alloc(ZCOLLECT_CACHELINE, sizeof(nam##_slot) * nthreads); \
+	runtime_assert(c->slots != NULL, "memory exhaustion"); \
+	for (i = 0; i < nthreads; i++) { \
+		c->slots[i].l = (lnam)ZLIST_INITIALIZER; \
+	} \
+	c->nthreads = nthreads; \
+} \
+ \
+lnam* nam##_local(nam*const c, const size_t tid) { \
+	runtime_assert(c != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(tid < c->nthreads, "Index out of range."); \
+	return &c->slots[tid].l; \
+} \
+ \
+void nam##_append(nam*const c, const size_t tid, const typ item) { \
+	lnam##_append(nam##_local(c, tid), item); \
+} \
+ \
+size_t nam##_len(const nam*const c) { \
+	size_t i, n = 0; \
+	runtime_assert(c != NULL, "You are required to pass a non-NULL pointer."); \
+	for (i = 0; i < c->nthreads; i++) { \
+		n += c->slots[i].l.len; \
+	} \
+	return n; \
+} \
+ \
+void nam##_merge(nam*const c, lnam*const out, const bool ordered, const size_t nworkers) { \
+	const typ** srcs; \
+	size_t* lens; \
+	size_t i, n, big, at, total; \
+	runtime_assert(out != NULL, "You are required to pass a non-NULL pointer."); \
+	total = nam##_len(c); \
+	if (total == 0) { return; } \
+	if (!ordered && (out->len == 0)) { \
+		big = 0; \
+		for (i = 1; i < c->nthreads; i++) { \
+			if (c->slots[i].l.len > c->slots[big].l.len) { big = i; } \
+		} \
+		lnam##_free(out); \
+		*out = c->slots[big].l; \
+		c->slots[big].l = (lnam)ZLIST_INITIALIZER; \
+		total -= out->len; \
+		if (total == 0) { return; } \
+	} \
+	runtime_assert(total <= Z_SIZE_T_MAX - out->len, "memory exhaustion"); \
+	at = out->len; \
+	lnam##_resize(out, at + total); \
+	if (nworkers <= 1) { \
+		for (i = 0; i < c->nthreads; i++) { \
+			if (c->slots[i].l.len > 0) { \
+				memcpy(out->arr + at, c->slots[i].l.arr, sizeof(typ) * c->slots[i].l.len); \
+				at += c->slots[i].l.len; \
+			} \
+		} \
+	} else { \
+		srcs = (const typ**)malloc(sizeof(typ*) * c->nthreads); \
+		lens = (size_t*)malloc(sizeof(size_t) * c->nthreads); \
+		runtime_assert((srcs != NULL) && (lens != NULL), "memory exhaustion"); \
+		for (i = 0, n = 0; i < c->nthreads; i++) { \
+			if (c->slots[i].l.len > 0) { \
+				srcs[n] = c->slots[i].l.arr; \
+				lens[n] = c->slots[i].l.len; \
+				n++; \
+			} \
+		} \
+		_zcollect_parallel_copy(out->arr + at, (const void*const*)srcs, lens, n, sizeof(typ), nworkers); \
+		free(srcs); \
+		free(lens); \
+	} \
+	nam##_clear(c); \
+} \
+ \
+void nam##_clear(nam*const c) { \
+	size_t i; \
+	runtime_assert(c != NULL, "You are required to pass a non-NULL pointer."); \
+	for (i = 0; i < c->nthreads; i++) { \
+		lnam##_clear(&c->slots[i].l); \
+	} \
+} \
+ \
+void nam##_free(nam*const c) { \
+	size_t i; \
+	runtime_assert(c != NULL, "You are required to pass a non-NULL pointer."); \
+	if (c->slots == NULL) { return; } \
+	for (i = 0; i < c->nthreads; i++) { \
+		lnam##_free(&c->slots[i].l); \
+	} \
+	free(c->slots); \
+	c->slots = NULL; \
+	c->nthreads = 0; \
+}
+
+#endif /* #ifndef __INCL_zcollectimp_h */
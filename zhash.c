@@ -0,0 +1,57 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#include "zhash.h"
+
+size_t zhash_u64(unsigned long long x)
+{
+	/* the finalizer of MurmurHash3 */
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdLLU;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53LLU;
+	x ^= x >> 33;
+	return (size_t)x;
+}
+
+size_t zhash_bytes(const void* const p, const size_t len)
+{
+	/* 64-bit FNV-1a, then mixed so that the low bits are good too */
+	const zbyte* const bs = (const zbyte*)p;
+	unsigned long long h = 0xcbf29ce484222325LLU;
+	size_t i;
+	for (i = 0; i < len; i++) {
+		h ^= bs[i];
+		h *= 0x100000001b3LLU;
+	}
+	return zhash_u64(h);
+}
+
+unsigned _zhash_match_portable(const unsigned char* const g, const unsigned char b)
+{
+	unsigned m = 0;
+	unsigned i;
+	for (i = 0; i < ZHASH_GROUP; i++) {
+		m |= ((unsigned)(g[i] == b)) << i;
+	}
+	return m;
+}
+
+unsigned _zhash_ctz_portable(unsigned m)
+{
+	unsigned n = 0;
+	while ((m & 1) == 0) {
+		m >>= 1;
+		n++;
+	}
+	return n;
+}
@@ -0,0 +1,125 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#ifndef __INCL_zhash_h
+#define __INCL_zhash_h
+
+#include "zutil.h"
+
+#include "zhashimp.h" /* implementation stuff that you needn't look at in order to use this */
+
+/**
+ * Open-addressing hash maps and sets, in the style of zlist.h: you generate a 
+ * type with a DECLARE macro in a .h file and the functions with the 
+ * corresponding DEFINE macro in exactly one .c file.
+ *
+ * Each slot has a one-byte "control byte" which is either EMPTY or holds 7 
+ * bits of the key's hash.  Lookups scan 16 control bytes at a time (with SSE2 
+ * when it is available) and only compare keys whose 7 hash bits match, so a 
+ * lookup touches very few keys even when the table is 7/8 full, which is as 
+ * full as it gets before it doubles.  Probing is linear, and deletion shifts 
+ * later entries back into the hole rather than leaving a "tombstone" behind, 
+ * so deleting never makes later lookups slower.
+ *
+ * For example:
+ *
+ * DECLARE_ZHASH(unsigned long, int, zhashuli)
+ *
+ * expands to the following declarations:
+ *
+ * typedef struct {
+ * 	unsigned long key;
+ * 	int val;
+ * } zhashuli_slot;
+ *
+ * typedef struct {
+ * 	size_t len;
+ * 	size_t cap;
+ * 	unsigned char* ctrl;
+ * 	zhashuli_slot* slots;
+ * } zhashuli;
+ *
+ * bool zhashuli_put(zhashuli* h, unsigned long key, int val);
+ * int* zhashuli_get(const zhashuli* h, unsigned long key);
+ * bool zhashuli_contains(const zhashuli* h, unsigned long key);
+ * bool zhashuli_remove(zhashuli* h, unsigned long key);
+ * void zhashuli_reserve(zhashuli* h, size_t n);
+ * size_t zhashuli_next(const zhashuli* h, size_t i);
+ * void zhashuli_clear(zhashuli* h);
+ * void zhashuli_free(zhashuli* h);
+ *
+ * and DEFINE_ZHASH(unsigned long, int, zhashuli, hashfn, eqfn) defines them.  
+ * hashfn(key) must return a size_t, all of whose bits are well mixed (use 
+ * zhash_u64() or zhash_bytes() below if in doubt).  eqfn(a, b) must return 
+ * true iff the keys are equal; ZHASH_EQ is "==".  Either may be a function or 
+ * a function-like macro.
+ *
+ * DECLARE_ZHASHSET(typ, nam) and DEFINE_ZHASHSET(typ, nam, hashfn, eqfn) 
+ * generate a set, whose slots have only a key, and which has add() instead of 
+ * put() and no get():
+ *
+ * bool zhashsetname_add(zhashsetname* h, typ key);
+ *
+ * Initialize a new table with ZHASH_INITIALIZER (or any other way of zeroing 
+ * it).  No memory is allocated until the first insertion.
+ *
+ * Here is the documentation for each of these functions:
+ *
+ * bool nam_put(nam* h, ktyp key, vtyp val):
+ *     Map key to val, replacing any previous value.  Returns true iff key was 
+ *     not already in the table.
+ *
+ * vtyp* nam_get(const nam* h, ktyp key):
+ *     Returns a pointer to the value for key, or NULL if key isn't present.  
+ *     The pointer is good until the next insertion or removal.
+ *
+ * bool nam_contains(const nam* h, ktyp key):
+ *     Returns true iff key is present.
+ *
+ * bool nam_remove(nam* h, ktyp key):
+ *     Remove key.  Returns true iff it was present.
+ *
+ * void nam_reserve(nam* h, size_t n):
+ *     Make room for n entries in total, so that inserting up to n entries 
+ *     won't rehash.
+ *
+ * size_t nam_next(const nam* h, size_t i):
+ *     Returns the index of the first occupied slot at index i or after, or 
+ *     h->cap if there isn't one.  Iterate like this:
+ *
+ *     for (i = nam_next(&h, 0); i < h.cap; i = nam_next(&h, i+1)) {
+ *         ... h.slots[i].key ... h.slots[i].val ...
+ *     }
+ *
+ *     Don't insert or remove while iterating.
+ *
+ * void nam_clear(nam* h):
+ *     Remove all entries but keep the memory.
+ *
+ * void nam_free(nam* h):
+ *     Free the memory and leave h as an empty table.  Okay to call this on an 
+ *     already-freed table.
+ */
+
+#define ZHASH_EQ(a, b) ((a) == (b))
+
+/**
+ * A strong mixing function for integer (or pointer, cast to an integer) keys.
+ */
+size_t zhash_u64(unsigned long long x);
+
+/**
+ * Hash len bytes starting at p.
+ */
+size_t zhash_bytes(const void* p, size_t len);
+
+#endif /* #ifndef __INCL_zhash_h */
@@ -0,0 +1,263 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#ifndef __INCL_zhashimp_h
+#define __INCL_zhashimp_h
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+/* Control bytes: EMPTY has the high bit set; a full slot holds the low 7 bits 
+   of its key's hash.  The ctrl array has ZHASH_GROUP extra bytes at the end 
+   which mirror the first ZHASH_GROUP bytes, so that a group can be loaded 
+   starting at any slot without wrapping around by hand.  cap is always a power 
+   of two and at least ZHASH_GROUP. */
+#define ZHASH_GROUP 16
+#define _ZHASH_EMPTY ((unsigned char)0x80)
+#define _ZHASH_H1(hash) ((hash) >> 7)
+#define _ZHASH_H2(hash) ((unsigned char)((hash) & 0x7f))
+
+#define ZHASH_INITIALIZER { 0, 0, NULL, NULL }
+
+unsigned _zhash_match_portable(const unsigned char* g, unsigned char b);
+unsigned _zhash_ctz_portable(unsigned m);
+
+/* _ZHASH_MATCH(g, b) returns a bitmask with bit i set iff g[i] == b, for the 
+   ZHASH_GROUP bytes starting at g.  _ZHASH_MATCH_EMPTY(g) does the same for 
+   EMPTY. */
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define _ZHASH_MATCH(g, b) ((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(g)), _mm_set1_epi8((char)(b)))))
+#define _ZHASH_MATCH_EMPTY(g) ((unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(g))))
+#else
+#define _ZHASH_MATCH(g, b) _zhash_match_portable((g), (b))
+#define _ZHASH_MATCH_EMPTY(g) _zhash_match_portable((g), _ZHASH_EMPTY)
+#endif
+
+#ifdef __GNUC__
+#define _ZHASH_CTZ(m) ((unsigned)__builtin_ctz(m))
+#else
+#define _ZHASH_CTZ(m) _zhash_ctz_portable(m)
+#endif
+
+#define _ZHASH_SET_CTRL(h, i, c) do { \
+	(h)->ctrl[i] = (c); \
+	if ((i) < ZHASH_GROUP) { (h)->ctrl[(h)->cap + (i)] = (c); } \
+} while (0)
+
+#define _DECLARE_ZHASH_TABLE(ktyp, nam) \
+typedef struct { \
+	size_t len; \
+	size_t cap; \
+	unsigned char* ctrl; \
+	nam##_slot* slots; \
+} nam; \
+bool nam##_contains(const nam* h, ktyp key); \
+bool nam##_remove(nam* h, ktyp key); \
+void nam##_reserve(nam* h, size_t n); \
+size_t nam##_next(const nam* h, size_t i); \
+void nam##_clear(nam* h); \
+void nam##_free(nam* h);
+
+#define DECLARE_ZHASH(ktyp, vtyp, nam) \
+typedef struct { \
+	ktyp key; \
+	vtyp val; \
+} nam##_slot; \
+_DECLARE_ZHASH_TABLE(ktyp, nam) \
+bool nam##_put(nam* h, ktyp key, vtyp val); \
+vtyp* nam##_get(const nam* h, ktyp key);
+
+#define DECLARE_ZHASHSET(ktyp, nam) \
+typedef struct { \
+	ktyp key; \
+} nam##_slot; \
+_DECLARE_ZHASH_TABLE(ktyp, nam) \
+bool nam##_add(nam* h, ktyp key);
+
+#define _DEFINE_ZHASH_TABLE(ktyp, nam, hashfn, eqfn) \
+static size_t _##nam##_find(const nam*const h, const ktyp key) { \
+	size_t hash, mask, pos, i; \
+	unsigned char h2; \
+	unsigned m; \
+	if (h->cap == 0) { return 0; } \
+	hash = hashfn(key); \
+	mask = h->cap - 1; \
+	pos = _ZHASH_H1(hash) & mask; \
+	h2 = _ZHASH_H2(hash); \
+	for (;;) { \
+		m = _ZHASH_MATCH(h->ctrl + pos, h2); \
+		while (m != 0) { \
+			i = (pos + _ZHASH_CTZ(m)) & mask; \
+			if (eqfn(h->slots[i].key, key)) { \
+				return i; \
+			} \
+			m &= m - 1; \
+		} \
+		if (_ZHASH_MATCH_EMPTY(h->ctrl + pos) != 0) { \
+			return h->cap; \
+		} \
+		pos = (pos + ZHASH_GROUP) & mask; \
+	} \
+} \
+ \
+/* Claim the first empty slot at or after hash's home slot. */ \
+static size_t _##nam##_insert_at(nam*const h, const size_t hash) { \
+	const size_t mask = h->cap - 1; \
+	size_t pos = _ZHASH_H1(hash) & mask; \
+	unsigned m; \
+	for (;;) { \
+		m = _ZHASH_MATCH_EMPTY(h->ctrl + pos); \
+		if (m != 0) { \
+			pos = (pos + _ZHASH_CTZ(m)) & mask; \
+			_ZHASH_SET_CTRL(h, pos, _ZHASH_H2(hash)); \
+			h->len++; \
+			return pos; \
+		} \
+		pos = (pos + ZHASH_GROUP) & mask; \
+	} \
+} \
+ \
+static void _##nam##_rehash(nam*const h, const size_t newcap) { \
+	const nam old = *h; \
+	size_t i, j; \
+	runtime_assert(newcap <= (Z_SIZE_T_MAX - ZHASH_GROUP) / (sizeof(nam##_slot) + 1), "memory exhaustion"); \
+	h->slots = (nam##_slot*)malloc(newcap * sizeof(nam##_slot) + newcap + ZHASH_GROUP); \
+	runtime_assert(h->slots != NULL, "memory exhaustion"); \
+	h->ctrl = (unsigned char*)(h->slots + newcap); \
+	memset(h->ctrl, _ZHASH_EMPTY, newcap + ZHASH_GROUP); \
+	h->cap = newcap; \
+	h->len = 0; \
+	for (i = 0; i < old.cap; i++) { \
+		if (old.ctrl[i] != _ZHASH_EMPTY) { \
+			j = _##nam##_insert_at(h, hashfn(old.slots[i].key)); \
+			h->slots[j] = old.slots[i]; \
+		} \
+	} \
+	if (old.slots != NULL) { free(old.slots); } \
+} \
+ \
+void nam##_reserve(nam*const h, const size_t n) { \
+	size_t newcap; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	newcap = (h->cap == 0) ? ZHASH_GROUP : h->cap; \
+	while (n > newcap / 8 * 7) { \
+		runtime_assert(newcap <= Z_SIZE_T_MAX / 2, "memory exhaustion"); \
+		newcap *= 2; \
+	} \
+	if (newcap != h->cap) { \
+		_##nam##_rehash(h, newcap); \
+	} \
+} \
+ \
+bool nam##_contains(const nam*const h, const ktyp key) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	return _##nam##_find(h, key) < h->cap; \
+} \
+ \
+/* Rather than leaving a tombstone, shift each later entry in the run back \
+   into the hole if the hole is between the entry's home slot and the entry. */ \
+bool nam##_remove(nam*const h, const ktyp key) { \
+	size_t i, j, home, mask; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	i = _##nam##_find(h, key); \
+	if (i >= h->cap) { return false; } \
+	mask = h->cap - 1; \
+	j = i; \
+	for (;;) { \
+		j = (j + 1) & mask; \
+		if (h->ctrl[j] == _ZHASH_EMPTY) { break; } \
+		home = _ZHASH_H1(hashfn(h->slots[j].key)) & mask; \
+		if (((j - home) & mask) >= ((j - i) & mask)) { \
+			h->slots[i] = h->slots[j]; \
+			_ZHASH_SET_CTRL(h, i, h->ctrl[j]); \
+			i = j; \
+		} \
+	} \
+	_ZHASH_SET_CTRL(h, i, _ZHASH_EMPTY); \
+	h->len--; \
+	return true; \
+} \
+ \
+size_t nam##_next(const nam*const h, size_t i) { \
+	unsigned m; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	while (i < h->cap) { \
+		m = ~_ZHASH_MATCH_EMPTY(h->ctrl + i) & ((1U << ZHASH_GROUP) - 1); \
+		if (m != 0) { \
+			i += _ZHASH_CTZ(m); \
+			return (i < h->cap) ? i : h->cap; \
+		} \
+		i += ZHASH_GROUP; \
+	} \
+	return h->cap; \
+} \
+ \
+void nam##_clear(nam*const h) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	if (h->ctrl != NULL) { memset(h->ctrl, _ZHASH_EMPTY, h->cap + ZHASH_GROUP); } \
+	h->len = 0; \
+} \
+ \
+void nam##_free(nam*const h) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	if (h->slots != NULL) { free(h->slots); } \
+	h->slots = NULL; \
+	h->ctrl = NULL; \
+	h->len = 0; \
+	h->cap = 0; \
+}
+
+#define DEFINE_ZHASH(ktyp, vtyp, nam, hashfn, eqfn) \
+_DEFINE_ZHASH_TABLE(ktyp, nam, hashfn, eqfn) \
+ \
+bool nam##_put(nam*const h, const ktyp key, const vtyp val) { \
+	size_t i; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	i = _##nam##_find(h, key); \
+	if (i < h->cap) { \
+		h->slots[i].val = val; \
+		return false; \
+	} \
+	nam##_reserve(h, h->len + 1); \
+	i = _##nam##_insert_at(h, hashfn(key)); \
+	h->slots[i].key = key; \
+	h->slots[i].val = val; \
+	return true; \
+} \
+ \
+vtyp* nam##_get(const nam*const h, const ktyp key) { \
+	size_t i; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	i = _##nam##_find(h, key); \
+	return (i < h->cap) ? &h->slots[i].val : NULL; \
+}
+
+#define DEFINE_ZHASHSET(ktyp, nam, hashfn, eqfn) \
+_DEFINE_ZHASH_TABLE(ktyp, nam, hashfn, eqfn) \
+ \
+bool nam##_add(nam*const h, const ktyp key) { \
+	size_t i; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	if (_##nam##_find(h, key) < h->cap) { \
+		return false; \
+	} \
+	nam##_reserve(h, h->len + 1); \
+	i = _##nam##_insert_at(h, hashfn(key)); \
+	h->slots[i].key = key; \
+	return true; \
+}
+
+#endif /* #ifndef __INCL_zhashimp_h */
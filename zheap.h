@@ -0,0 +1,86 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zheap_h
+#define __INCL_zheap_h
+
+#include "zutil.h"
+
+#include "zheapimp.h" /* implementation stuff that you needn't look at in order to use this */
+
+/**
+ * A zheap is a priority queue: an implicit d-ary heap kept in a growable 
+ * array (grown the same way as a zlist).  With d = 4 the children of a node 
+ * sit next to each other, usually in a single cache line, and the tree is 
+ * half as deep as a binary heap's, so pushes and pops touch about half as 
+ * many cache lines.
+ *
+ * DECLARE_ZHEAP(typ, nam, d) declares the type nam and the following 
+ * functions, and DEFINE_ZHEAP(typ, nam, d, lessfn) defines them.  lessfn(a, b) 
+ * is true if a should come out of the heap before b; it is expanded inline, 
+ * so it may be a macro such as ZHEAP_LESS ("<"), which gives a min-heap.
+ *
+ * typedef struct {
+ * 	size_t len;
+ * 	typ* arr;
+ * 	size_t cap;
+ * } nam;
+ *
+ * l.arr[0] is the top item, and the rest of arr is in heap order.  Initialize 
+ * a new heap with ZHEAP_INITIALIZER or by zeroing it.
+ *
+ * void nam_push(nam* h, typ item):
+ *     Add item.  O(log_d len).
+ *
+ * typ nam_top(const nam* h):
+ *     Returns the item which would be popped next.  The heap must not be 
+ *     empty.
+ *
+ * typ nam_pop(nam* h):
+ *     Remove and return the top item.  The heap must not be empty.  
+ *     O(d log_d len).
+ *
+ * void nam_heapify(nam* h, const typ* items, size_t n):
+ *     Add the n items starting at items all at once, in time linear in the 
+ *     size of the heap -- faster than n pushes.
+ *
+ * void nam_reserve(nam* h, size_t cap):
+ * void nam_clear(nam* h):
+ * void nam_free(nam* h):
+ *     As for a zlist.
+ *
+ *
+ * Indexed heaps
+ *
+ * DECLARE_ZHEAP_INDEXED(typ, nam, d) and DEFINE_ZHEAP_INDEXED(typ, nam, d, 
+ * lessfn, idfn) generate a heap which also keeps track of where each item is, 
+ * so that an item's priority can be changed in place -- as in Dijkstra's 
+ * algorithm.  idfn(item) must return a small non-negative integer (a size_t) 
+ * which identifies the item; the heap keeps an array indexed by it, so the 
+ * ids should be dense.  Each id may be in the heap only once.  The struct has 
+ * two more fields, "size_t* pos" and "size_t poscap", which you needn't look 
+ * at.  Besides all of the above functions it has:
+ *
+ * bool nam_contains_id(const nam* h, size_t id):
+ *     Returns true if an item with this id is in the heap.
+ *
+ * void nam_decrease_key(nam* h, typ item):
+ *     Replace the item in the heap which has the same id as item with item, 
+ *     which must come out no later than the one it replaces (by lessfn), i.e. 
+ *     the item can only move towards the top.  O(log_d len).
+ *
+ * void nam_update(nam* h, typ item):
+ *     Like decrease_key(), but the new item may move in either direction.
+ */
+
+#endif /* #ifndef __INCL_zheap_h */
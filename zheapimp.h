@@ -0,0 +1,245 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zheapimp_h
+#define __INCL_zheapimp_h
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "moreassert.h"
+#include "morelimits.h"
+#include "zlist.h"
+
+#define ZHEAP_LESS(a, b) ((a) < (b))
+#define ZHEAP_INITIALIZER {0}
+
+/* Both kinds of heap share this body.  Every time an item lands at index i 
+   the body calls _nam_setpos(h, i), which does nothing for a plain heap and 
+   records the position for an indexed one.  Sifting moves a "hole" rather 
+   than swapping, so each level costs one store. */
+#define _DECLARE_ZHEAP_COMMON(typ, nam) \
+void nam##_reserve(nam* h, size_t cap); \
+void nam##_push(nam* h, typ item); \
+typ nam##_top(const nam* h); \
+typ nam##_pop(nam* h); \
+void nam##_heapify(nam* h, const typ* items, size_t n); \
+void nam##_clear(nam* h); \
+void nam##_free(nam* h);
+
+#define _DEFINE_ZHEAP_COMMON(typ, nam, d, lessfn) \
+void nam##_reserve(nam*const h, const size_t cap) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((h->arr != NULL) && (cap <= h->cap)) { return; } \
+	if (cap == 0) { return; } \
+	runtime_assert(cap <= Z_SIZE_T_MAX / sizeof(typ), "memory exhaustion"); \
+	h->arr = (typ*)realloc(h->arr, sizeof(typ) * cap); \
+	runtime_assert(h->arr != NULL, "memory exhaustion"); \
+	h->cap = cap; \
+} \
+ \
+static void _##nam##_sift_up(nam*const h, size_t i) { \
+	const typ x = h->arr[i]; \
+	size_t p; \
+	while (i > 0) { \
+		p = (i - 1) / (d); \
+		if (!lessfn(x, h->arr[p])) { break; } \
+		h->arr[i] = h->arr[p]; \
+		_##nam##_setpos(h, i); \
+		i = p; \
+	} \
+	h->arr[i] = x; \
+	_##nam##_setpos(h, i); \
+} \
+ \
+static void _##nam##_sift_down(nam*const h, size_t i) { \
+	const typ x = h->arr[i]; \
+	const size_t n = h->len; \
+	size_t c, k, best, end; \
+	for (;;) { \
+		c = (d) * i + 1; \
+		if (c >= n) { break; } \
+		end = (n - c < (d)) ? n : c + (d); \
+		best = c; \
+		for (k = c + 1; k < end; k++) { \
+			if (lessfn(h->arr[k], h->arr[best])) { best = k; } \
+		} \
+		if (!lessfn(h->arr[best], x)) { break; } \
+		h->arr[i] = h->arr[best]; \
+		_##nam##_setpos(h, i); \
+		i = best; \
+	} \
+	h->arr[i] = x; \
+	_##nam##_setpos(h, i); \
+} \
+ \
+static void _##nam##_grow(nam*const h, const size_t n) { \
+	runtime_assert(n <= Z_SIZE_T_MAX - h->len, "memory exhaustion"); \
+	if ((h->len + n > h->cap) || (h->arr == NULL)) { \
+		nam##_reserve(h, _zlist_grow_cap((h->arr == NULL) ? 0 : h->cap, h->len + n, sizeof(typ))); \
+	} \
+} \
+ \
+void nam##_push(nam*const h, const typ item) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	_##nam##_add_id(h, item); \
+	_##nam##_grow(h, 1); \
+	h->arr[h->len++] = item; \
+	_##nam##_sift_up(h, h->len - 1); \
+} \
+ \
+typ nam##_top(const nam*const h) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(h->len > 0, "The heap is empty."); \
+	return h->arr[0]; \
+} \
+ \
+typ nam##_pop(nam*const h) { \
+	typ top; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(h->len > 0, "The heap is empty."); \
+	top = h->arr[0]; \
+	_##nam##_remove_id(h, top); \
+	h->len--; \
+	if (h->len > 0) { \
+		h->arr[0] = h->arr[h->len]; \
+		_##nam##_sift_down(h, 0); \
+	} \
+	return top; \
+} \
+ \
+void nam##_heapify(nam*const h, const typ*const items, const size_t n) { \
+	size_t i; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert((items != NULL) || (n == 0), "You are required to pass a non-NULL array."); \
+	if (n == 0) { return; } \
+	_##nam##_grow(h, n); \
+	for (i = 0; i < n; i++) { \
+		_##nam##_add_id(h, items[i]); \
+		h->arr[h->len++] = items[i]; \
+		_##nam##_setpos(h, h->len - 1); \
+	} \
+	for (i = (h->len < 2) ? 0 : (h->len - 2) / (d) + 1; i > 0; i--) { \
+		_##nam##_sift_down(h, i - 1); \
+	} \
+}
+
+#define DECLARE_ZHEAP(typ, nam, d) \
+typedef struct { \
+	size_t len; \
+	typ* arr; \
+	size_t cap; \
+} nam; \
+_DECLARE_ZHEAP_COMMON(typ, nam)
+
+#define DEFINE_ZHEAP(typ, nam, d, lessfn) \
+static void _##nam##_setpos(nam*const h, const size_t i) { (void)h; (void)i; } \
+static void _##nam##_add_id(nam*const h, const typ item) { (void)h; (void)item; } \
+static void _##nam##_remove_id(nam*const h, const typ item) { (void)h; (void)item; } \
+_DEFINE_ZHEAP_COMMON(typ, nam, d, lessfn) \
+ \
+void nam##_clear(nam*const h) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	h->len = 0; \
+} \
+ \
+void nam##_free(nam*const h) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	if (h->arr != NULL) { free(h->arr); h->arr = NULL; } \
+	h->len = 0; \
+	h->cap = 0; \
+}
+
+/* pos[id] is 1 + the index of the item with that id, or 0 if it isn't in 
+   the heap. */
+#define DECLARE_ZHEAP_INDEXED(typ, nam, d) \
+typedef struct { \
+	size_t len; \
+	typ* arr; \
+	size_t cap; \
+	size_t* pos; \
+	size_t poscap; \
+} nam; \
+_DECLARE_ZHEAP_COMMON(typ, nam) \
+bool nam##_contains_id(const nam* h, size_t id); \
+void nam##_decrease_key(nam* h, typ item); \
+void nam##_update(nam* h, typ item);
+
+#define DEFINE_ZHEAP_INDEXED(typ, nam, d, lessfn, idfn) \
+static void _##nam##_setpos(nam*const h, const size_t i) { \
+	h->pos[idfn(h->arr[i])] = i + 1; \
+} \
+ \
+static void _##nam##_add_id(nam*const h, const typ item) { \
+	const size_t id = idfn(item); \
+	size_t newcap; \
+	if (id >= h->poscap) { \
+		newcap = _zlist_grow_cap(h->poscap, id + 1, sizeof(size_t)); \
+		h->pos = (size_t*)realloc(h->pos, sizeof(size_t) * newcap); \
+		runtime_assert(h->pos != NULL, "memory exhaustion"); \
+		memset(h->pos + h->poscap, 0, sizeof(size_t) * (newcap - h->poscap)); \
+		h->poscap = newcap; \
+	} \
+	runtime_assert(h->pos[id] == 0, "An item with that id is already in the heap."); \
+} \
+ \
+static void _##nam##_remove_id(nam*const h, const typ item) { \
+	h->pos[idfn(item)] = 0; \
+} \
+ \
+_DEFINE_ZHEAP_COMMON(typ, nam, d, lessfn) \
+ \
+bool nam##_contains_id(const nam*const h, const size_t id) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	return (id < h->poscap) && (h->pos[id] != 0); \
+} \
+ \
+void nam##_decrease_key(nam*const h, const typ item) { \
+	size_t i; \
+	runtime_assert(nam##_contains_id(h, idfn(item)), "No item with that id is in the heap."); \
+	i = h->pos[idfn(item)] - 1; \
+	h->arr[i] = item; \
+	_##nam##_sift_up(h, i); \
+} \
+ \
+void nam##_update(nam*const h, const typ item) { \
+	size_t i; \
+	runtime_assert(nam##_contains_id(h, idfn(item)), "No item with that id is in the heap."); \
+	i = h->pos[idfn(item)] - 1; \
+	h->arr[i] = item; \
+	_##nam##_sift_up(h, i); \
+	if (h->pos[idfn(item)] - 1 == i) { \
+		/* it didn't move up, so maybe it has to move down */ \
+		_##nam##_sift_down(h, i); \
+	} \
+} \
+ \
+void nam##_clear(nam*const h) { \
+	size_t i; \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	for (i = 0; i < h->len; i++) { \
+		h->pos[idfn(h->arr[i])] = 0; \
+	} \
+	h->len = 0; \
+} \
+ \
+void nam##_free(nam*const h) { \
+	runtime_assert(h != NULL, "You are required to pass a non-NULL pointer."); \
+	if (h->arr != NULL) { free(h->arr); h->arr = NULL; } \
+	if (h->pos != NULL) { free(h->pos); h->pos = NULL; } \
+	h->len = 0; \
+	h->cap = 0; \
+	h->poscap = 0; \
+}
+
+#endif /* #ifndef __INCL_zheapimp_h */
@@ -0,0 +1,394 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#include <limits.h>
+#include <string.h>
+
+#include "zint.h"
+
+#include "moreassert.h"
+
+static const char _zint_dec_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const char _zint_hex_pairs[2][513] = {
+	"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",
+	"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+	"202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+	"404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+	"606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+	"808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+	"A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+	"C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+	"E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF"
+};
+
+/* The value of each char as a hex digit, or -1. */
+static const signed char _zint_hex_val[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/* _zint_pow10[k] is 10^k, except that _zint_pow10[0] is 0, so that 0 comes 
+   out as one digit. */
+static const unsigned long long _zint_pow10[20] = {
+	0ULL, 10ULL, 100ULL, 1000ULL,
+	10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+	100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+	1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+	10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+#ifdef __GNUC__
+#define _ZINT_BITS(v) (64 - __builtin_clzll((v) | 1))
+#else
+#define _ZINT_BITS(v) _zint_bits(v)
+static unsigned _zint_bits(unsigned long long v) {
+	unsigned n = 1;
+	while ((v >>= 1) != 0) { n++; }
+	return n;
+}
+#endif
+
+/* log10(2) is about 1233/4096, so t is the number of digits or one less. */
+static inline size_t _zint_dec_len(const unsigned long long v) {
+	const unsigned t = ((unsigned)_ZINT_BITS(v) * 1233) >> 12;
+	return t + (v >= _zint_pow10[t]);
+}
+
+/* Write the digits of v backwards, the last of them just before end.  While 
+   v needs more than 32 bits the divisions are 64-bit ones. */
+static inline void _zint_write_dec(char* end, unsigned long long v) {
+	unsigned v32, d;
+	while (v > UINT_MAX) {
+		d = (unsigned)(v % 100) * 2;
+		v /= 100;
+		end -= 2;
+		memcpy(end, _zint_dec_pairs + d, 2);
+	}
+	v32 = (unsigned)v;
+	while (v32 >= 100) {
+		d = (v32 % 100) * 2;
+		v32 /= 100;
+		end -= 2;
+		memcpy(end, _zint_dec_pairs + d, 2);
+	}
+	if (v32 >= 10) {
+		memcpy(end - 2, _zint_dec_pairs + v32 * 2, 2);
+	} else {
+		end[-1] = (char)('0' + v32);
+	}
+}
+
+size_t zint_format_ullong(const unsigned long long v, char*const out) {
+	const size_t n = _zint_dec_len(v);
+	_zint_write_dec(out + n, v);
+	return n;
+}
+
+size_t zint_format_llong(const long long v, char*const out) {
+	if (v < 0) {
+		out[0] = '-';
+		return 1 + zint_format_ullong(0ULL - (unsigned long long)v, out + 1);
+	}
+	return zint_format_ullong((unsigned long long)v, out);
+}
+
+size_t zint_format_uint(const unsigned v, char*const out) {
+	return zint_format_ullong(v, out);
+}
+
+size_t zint_format_int(const int v, char*const out) {
+	return zint_format_llong(v, out);
+}
+
+size_t zint_format_ulong(const unsigned long v, char*const out) {
+	return zint_format_ullong(v, out);
+}
+
+size_t zint_format_long(const long v, char*const out) {
+	return zint_format_llong(v, out);
+}
+
+size_t zint_format_hex_ullong(unsigned long long v, char*const out, const bool upper) {
+	const char*const pairs = _zint_hex_pairs[upper != 0];
+	const size_t n = ((size_t)_ZINT_BITS(v) + 3) / 4;
+	char* p = out + n;
+	while (p - out >= 2) {
+		p -= 2;
+		memcpy(p, pairs + (v & 0xff) * 2, 2);
+		v >>= 8;
+	}
+	if (p > out) {
+		out[0] = pairs[(v & 0xf) * 2 + 1];
+	}
+	return n;
+}
+
+size_t zint_format_hex_uint(const unsigned v, char*const out, const bool upper) {
+	return zint_format_hex_ullong(v, out, upper);
+}
+
+size_t zint_format_hex_ulong(const unsigned long v, char*const out, const bool upper) {
+	return zint_format_hex_ullong(v, out, upper);
+}
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define _ZINT_SWAR
+#endif
+
+#ifdef _ZINT_SWAR
+/* Of the eight chars loaded into w (the first in the low byte), how many 
+   at the start are digits, given x = w - 0x3030303030303030, i.e. each 
+   char less '0'.  A char is a digit iff its byte in x is below 10, so iff 
+   neither that byte nor that byte plus 0x76 has its high bit set.  (A borrow 
+   or carry out of a byte which isn't a digit can spoil the bytes after it, 
+   but those don't count anyway.) */
+static inline unsigned _zint_leading_digits(const unsigned long long x) {
+	const unsigned long long m = (x | (x + 0x7676767676767676ULL)) & 0x8080808080808080ULL;
+	/* the same as (m == 0) ? 8 : ctz(m) / 8, but without a branch */
+	return ((unsigned)__builtin_ctzll(m | 0x8000000000000000ULL) / 8) + (unsigned)(m == 0);
+}
+
+/* The value of eight digits which have had '0' taken off each, the first 
+   in the low byte: combine them pairwise into four 2-digit numbers, and 
+   then those into the whole with two multiplies which each do two of the 
+   combinations at once. */
+static inline unsigned long long _zint_parse_8_digits(unsigned long long w) {
+	w = (w * 10) + (w >> 8);
+	w = (((w & 0x000000FF000000FFULL) * 0x000F424000000064ULL) + (((w >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+	return w & 0xFFFFFFFFULL;
+}
+
+/* Shift the first k chars of w to the top.  This multiplies by 2^(64 - 8k) 
+   (and by 0 for k = 0, where a shift by 64 would be undefined), because a 
+   shift by a variable amount costs several times what a multiply does on 
+   common x86 CPUs. */
+static const unsigned long long _zint_shift_up_8[9] = { 0ULL, 1ULL << 56, 1ULL << 48, 1ULL << 40, 1ULL << 32, 1ULL << 24, 1ULL << 16, 1ULL << 8, 1ULL };
+#define _ZINT_SHIFT_UP(w, k) ((w) * _zint_shift_up_8[k])
+
+static const unsigned long long _zint_pow10_8[9] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL };
+#endif
+
+static inline unsigned _zint_digit(const char c) {
+	return (unsigned)(unsigned char)c - '0';
+}
+
+static size_t _zint_parse_dec(const char*const s, const size_t len, unsigned long long*const out) {
+	unsigned long long v = 0;
+	size_t i = 0, start;
+	unsigned d;
+#ifdef _ZINT_SWAR
+	unsigned long long w, w2, w3;
+	unsigned k, k2, k3;
+#endif
+	if (len == 0) { return 0; }
+#ifdef _ZINT_SWAR
+	/* Take the digits up to eight at a time: k of them are shifted up to 
+	   the top of w, so that the bytes below are leading zeros.  When there 
+	   are 24 chars to look at, all three lots are done without branching on 
+	   how many digits there are, since that is what is hard to predict.  
+	   Fewer than 20 digits always fit; numbers of 20 digits or more, 
+	   including those padded with leading zeros, are rare, and go the 
+	   careful way below. */
+	if (len >= 24) {
+		memcpy(&w, s, 8);
+		memcpy(&w2, s + 8, 8);
+		memcpy(&w3, s + 16, 8);
+		w -= 0x3030303030303030ULL;
+		w2 -= 0x3030303030303030ULL;
+		w3 -= 0x3030303030303030ULL;
+		k = _zint_leading_digits(w);
+		k2 = _zint_leading_digits(w2);
+		k3 = _zint_leading_digits(w3);
+		/* k2 counts only if all of w were digits, and k3 only if all of w 
+		   and w2 were; the three counts are worked out side by side. */
+		k3 &= (0U - (unsigned)(k2 == 8)) & (0U - (unsigned)(k == 8));
+		k2 &= 0U - (unsigned)(k == 8);
+		if (k + k2 + k3 < 20) {
+			v = _zint_parse_8_digits(_ZINT_SHIFT_UP(w, k)) * _zint_pow10_8[k2] + _zint_parse_8_digits(_ZINT_SHIFT_UP(w2, k2));
+			v = v * _zint_pow10_8[k3] + _zint_parse_8_digits(_ZINT_SHIFT_UP(w3, k3));
+			if (k == 0) { return 0; }
+			*out = v;
+			return k + k2 + k3;
+		}
+	}
+#endif
+	while ((i < len) && (s[i] == '0')) { i++; }
+	start = i;
+#ifdef _ZINT_SWAR
+	while (len - i >= 8) {
+		memcpy(&w, s + i, 8);
+		w -= 0x3030303030303030ULL;
+		k = _zint_leading_digits(w);
+		if ((k == 0) || (i - start + k > 19)) { break; }
+		v = v * _zint_pow10_8[k] + _zint_parse_8_digits(w << (64 - 8 * k));
+		i += k;
+		if (k < 8) {
+			*out = v;
+			return i;
+		}
+	}
+#endif
+	while ((i < len) && (i - start < 19) && ((d = _zint_digit(s[i])) <= 9)) {
+		v = v * 10 + d;
+		i++;
+	}
+	if ((i < len) && ((d = _zint_digit(s[i])) <= 9)) {
+		/* 19 significant digits always fit; the 20th may not, and a 21st 
+		   never does. */
+		if ((v > ULLONG_MAX / 10) || MACRO_ADD_WOULD_OVERFLOW_ULLONG(v * 10, (unsigned long long)d)) { return 0; }
+		v = v * 10 + d;
+		i++;
+		if ((i < len) && (_zint_digit(s[i]) <= 9)) { return 0; }
+	}
+	if (i == 0) { return 0; }
+	*out = v;
+	return i;
+}
+
+/* Parse an optional sign and digits, and check the magnitude against max, 
+   the largest positive value of the type (whose most negative value is 
+   -max - 1). */
+static size_t _zint_parse_signed(const char*const s, const size_t len, const unsigned long long max, long long*const out) {
+	unsigned long long u;
+	size_t i = 0, n;
+	bool neg = false;
+	if ((len > 0) && ((s[0] == '-') || (s[0] == '+'))) {
+		neg = (s[0] == '-');
+		i = 1;
+	}
+	n = _zint_parse_dec(s + i, len - i, &u);
+	if ((n == 0) || (u > max + neg)) { return 0; }
+	*out = neg ? (-(long long)(u - 1) - 1) : (long long)u;
+	return i + n;
+}
+
+static size_t _zint_parse_hex(const char*const s, const size_t len, unsigned long long*const out) {
+	unsigned long long v = 0;
+	size_t i = 0, start;
+	int d;
+	while ((i < len) && (s[i] == '0')) { i++; }
+	start = i;
+	while ((i < len) && ((d = _zint_hex_val[(unsigned char)s[i]]) >= 0)) {
+		if (i - start == 16) { return 0; }
+		v = (v << 4) | (unsigned)d;
+		i++;
+	}
+	if (i == 0) { return 0; }
+	*out = v;
+	return i;
+}
+
+size_t zint_parse_ullong(const char*const s, const size_t len, unsigned long long*const out) {
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	return _zint_parse_dec(s, len, out);
+}
+
+size_t zint_parse_ulong(const char*const s, const size_t len, unsigned long*const out) {
+	unsigned long long u;
+	size_t n;
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	n = _zint_parse_dec(s, len, &u);
+	if ((n == 0) || (u > ULONG_MAX)) { return 0; }
+	*out = (unsigned long)u;
+	return n;
+}
+
+size_t zint_parse_uint(const char*const s, const size_t len, unsigned*const out) {
+	unsigned long long u;
+	size_t n;
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	n = _zint_parse_dec(s, len, &u);
+	if ((n == 0) || (u > UINT_MAX)) { return 0; }
+	*out = (unsigned)u;
+	return n;
+}
+
+size_t zint_parse_llong(const char*const s, const size_t len, long long*const out) {
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	return _zint_parse_signed(s, len, LLONG_MAX, out);
+}
+
+size_t zint_parse_long(const char*const s, const size_t len, long*const out) {
+	long long v;
+	size_t n;
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	n = _zint_parse_signed(s, len, LONG_MAX, &v);
+	if (n != 0) { *out = (long)v; }
+	return n;
+}
+
+size_t zint_parse_int(const char*const s, const size_t len, int*const out) {
+	long long v;
+	size_t n;
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	n = _zint_parse_signed(s, len, INT_MAX, &v);
+	if (n != 0) { *out = (int)v; }
+	return n;
+}
+
+size_t zint_parse_hex_ullong(const char*const s, const size_t len, unsigned long long*const out) {
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	return _zint_parse_hex(s, len, out);
+}
+
+size_t zint_parse_hex_ulong(const char*const s, const size_t len, unsigned long*const out) {
+	unsigned long long u;
+	size_t n;
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	n = _zint_parse_hex(s, len, &u);
+	if ((n == 0) || (u > ULONG_MAX)) { return 0; }
+	*out = (unsigned long)u;
+	return n;
+}
+
+size_t zint_parse_hex_uint(const char*const s, const size_t len, unsigned*const out) {
+	unsigned long long u;
+	size_t n;
+	runtime_assert((s != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+	n = _zint_parse_hex(s, len, &u);
+	if ((n == 0) || (u > UINT_MAX)) { return 0; }
+	*out = (unsigned)u;
+	return n;
+}
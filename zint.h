@@ -0,0 +1,80 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zint_h
+#define __INCL_zint_h
+
+#include <stddef.h>
+
+#include "zutil.h"
+
+/**
+ * Integers to and from text, for text protocols and the like, and much 
+ * faster than sprintf() and strtoull(): they look at no locale, and they 
+ * don't need a NUL-terminated string or errno.
+ *
+ * The format functions write the digits of v to out, with no NUL after 
+ * them, and return how many they wrote.  Decimal is at most ZINT_DEC_MAX 
+ * chars ("-9223372036854775808" or "18446744073709551615"), and hex at most 
+ * ZINT_HEX_MAX; hex is lowercase unless upper is true, and has no "0x".  They 
+ * write two digits at a time from a table, to exactly the right places 
+ * (the number of digits is worked out first, from the highest set bit), so 
+ * they never have to reverse or move the digits.  Smaller types are done 
+ * by the int and uint functions, and a signed value in hex is done by 
+ * casting it to the unsigned type of the same width.
+ */
+#define ZINT_DEC_MAX 20
+#define ZINT_HEX_MAX 16
+
+size_t zint_format_int(int v, char* out);
+size_t zint_format_uint(unsigned v, char* out);
+size_t zint_format_long(long v, char* out);
+size_t zint_format_ulong(unsigned long v, char* out);
+size_t zint_format_llong(long long v, char* out);
+size_t zint_format_ullong(unsigned long long v, char* out);
+size_t zint_format_hex_uint(unsigned v, char* out, bool upper);
+size_t zint_format_hex_ulong(unsigned long v, char* out, bool upper);
+size_t zint_format_hex_ullong(unsigned long long v, char* out, bool upper);
+
+/**
+ * The parse functions read the number at the start of the len chars at s, 
+ * which needn't be NUL-terminated, and stop at the first char which can't 
+ * be part of it.  They return the number of chars they used, having stored 
+ * the number in *out, or 0, leaving *out alone, if s doesn't start with a 
+ * number or the number doesn't fit in the type.  (s[0] tells which of those 
+ * it was.)  So "123 " and "123abc" give 123 and 3, "abc" gives 0, and 
+ * "4294967296" gives 0 for a 32-bit unsigned.
+ *
+ * Decimal numbers are an optional sign ('-' or '+', for the signed types 
+ * only) and then digits; hex numbers are hex digits of either case, with no 
+ * sign or "0x".  Leading whitespace isn't skipped.  On little-endian 
+ * machines decimal digits are taken eight chars at a time: a few bit 
+ * operations find how many of the eight are digits, and three multiplies 
+ * combine them, so there is no branch per digit.  When at least 24 chars
+ * are left, the first three words are tested together and a number of up
+ * to 19 digits is finished without looping at all.  Up to 19 digits always
+ * fit in an unsigned long long, so only a 20th needs the overflow check,
+ * which is the add_would_overflow test from zutil.h.  On one x86-64 box
+ * this parses about 2.5-3 times as fast as strtoull().
+ */
+size_t zint_parse_int(const char* s, size_t len, int* out);
+size_t zint_parse_uint(const char* s, size_t len, unsigned* out);
+size_t zint_parse_long(const char* s, size_t len, long* out);
+size_t zint_parse_ulong(const char* s, size_t len, unsigned long* out);
+size_t zint_parse_llong(const char* s, size_t len, long long* out);
+size_t zint_parse_ullong(const char* s, size_t len, unsigned long long* out);
+size_t zint_parse_hex_uint(const char* s, size_t len, unsigned* out);
+size_t zint_parse_hex_ulong(const char* s, size_t len, unsigned long* out);
+size_t zint_parse_hex_ullong(const char* s, size_t len, unsigned long long* out);
+
+#endif /* #ifndef __INCL_zint_h */
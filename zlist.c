@@ -0,0 +1,86 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#include "zlist.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+size_t _zlist_grow_cap(const size_t cap, const size_t needed, const size_t elemsize)
+{
+	const size_t maxcap = Z_SIZE_T_MAX / elemsize;
+	size_t newcap;
+	runtime_assert(needed <= maxcap, "memory exhaustion");
+	newcap = (cap <= maxcap / 2) ? (cap * 2) : maxcap;
+	if (newcap < ZLIST_MIN_CAP) { newcap = ZLIST_MIN_CAP; }
+	if (newcap > maxcap) { newcap = maxcap; }
+	if (newcap < needed) { newcap = needed; }
+	return newcap;
+}
+
+size_t _zlist_eyt_ascend(size_t k)
+{
+	/* Strip the trailing 1 bits (the right turns taken after the last left 
+	   turn) and then the 0 bit of that left turn. */
+	while ((k & 1) != 0) {
+		k >>= 1;
+	}
+	return k >> 1;
+}
+
+/* The list types whose statistics have changed since the last reset, most 
+   recently registered first. */
+static zlist_stats* _zlist_stats_head = NULL;
+
+void _zlist_stats_register(zlist_stats* const s)
+{
+	s->registered = 1;
+	s->next = _zlist_stats_head;
+	_zlist_stats_head = s;
+}
+
+void zlist_stats_reset(void)
+{
+	zlist_stats* s = _zlist_stats_head;
+	zlist_stats* next;
+	while (s != NULL) {
+		next = s->next;
+		s->resizes = 0;
+		s->bytes_copied = 0;
+		s->peak_len = 0;
+		s->contains_calls = 0;
+		s->elements_scanned = 0;
+		s->registered = 0;
+		s->next = NULL;
+		s = next;
+	}
+	_zlist_stats_head = NULL;
+}
+
+void zlist_stats_dump(FILE* const f, const bool json)
+{
+	const zlist_stats* s;
+	runtime_assert(f != NULL, "You are required to pass a non-NULL pointer.");
+	if (json) {
+		fprintf(f, "{");
+	}
+	for (s = _zlist_stats_head; s != NULL; s = s->next) {
+		if (json) {
+			fprintf(f, "%s\"%s\": {\"resizes\": %lu, \"bytes_copied\": %lu, \"peak_len\": %lu, \"contains_calls\": %lu, \"elements_scanned\": %lu}", (s == _zlist_stats_head) ? "" : ", ", s->name, (unsigned long)s->resizes, (unsigned long)s->bytes_copied, (unsigned long)s->peak_len, (unsigned long)s->contains_calls, (unsigned long)s->elements_scanned);
+		} else {
+			fprintf(f, "%s: resizes %lu, bytes copied %lu, peak len %lu, contains_item calls %lu, elements scanned %lu\n", s->name, (unsigned long)s->resizes, (unsigned long)s->bytes_copied, (unsigned long)s->peak_len, (unsigned long)s->contains_calls, (unsigned long)s->elements_scanned);
+		}
+	}
+	if (json) {
+		fprintf(f, "}\n");
+	}
+}
@@ -20,23 +20,29 @@ static int const zlist_vermin = 9;
 static int const zlist_vermicro = 0;
 static char const* const zlist_vernum = "0.9.0";
 
+#include <stdio.h>
+
 #include "zutil.h"
 
 #include "zlistimp.h" /* implementation stuff that you needn't look at in order to use this */
 
 /**
- * This is a very simple dynamically-resizing list.  It isn't efficient in some
- * cases -- for example the typical use of appending a bunch of items one at a 
- * time invokes realloc() every time.  The only virtues of this data structure
- * lie in simplicity, portability, and more simplicity.  You might want to read
- * through the implementation before using it -- it only takes a couple of
- * minutes.
+ * This is a very simple dynamically-resizing list.  It keeps a separate 
+ * capacity and grows that capacity geometrically, so appending a bunch of items 
+ * one at a time costs amortized constant time per item rather than a realloc() 
+ * per item.  The only virtues of this data structure lie in simplicity, 
+ * portability, and more simplicity.  You might want to read through the 
+ * implementation before using it -- it only takes a couple of minutes.
  *
  * zlistimp.h defines a macro named DECLARE_ZLIST which you need to use in order
  * to declare a zlist type that holds items of the type that you need to hold.
  * The macro has two operands: the first is the type of the things contained in
  * the list, and the second is the name of this kind of list.
  *
+ * (If the contained type is a pointer type, give it a name with typedef first 
+ * -- e.g. "typedef char* charp;" and then DECLARE_ZLIST(charp, zlistcharp) -- 
+ * because the generated functions declare their item parameters const.)
+ *
  * For example:
  *
  * DECLARE_ZLIST(int, zlisti)
@@ -46,11 +52,26 @@ static char const* const zlist_vernum = "0.9.0";
  * typedef struct {
  * 	size_t len;
  * 	int* arr;
+ * 	size_t cap;
  * } zlisti;
  * 
- * void zlisti_resize(zlisti* l, int item);
+ * void zlisti_resize(zlisti* l, size_t len);
+ * void zlisti_reserve(zlisti* l, size_t cap);
+ * void zlisti_shrink_to_fit(zlisti* l);
  * void zlisti_append(zlisti* l, int item);
+ * void zlisti_clear(zlisti* l);
  * void zlisti_free(zlisti* l);
+ * void zlisti_extend(zlisti* l, const int* items, size_t n);
+ * void zlisti_insert_range(zlisti* l, size_t at, const int* items, size_t n);
+ * void zlisti_erase_range(zlisti* l, size_t at, size_t n);
+ * void zlisti_swap_remove(zlisti* l, size_t i);
+ * int zlisti_pop(zlisti* l);
+ * void zlisti_copy(zlisti* dst, const zlisti* src);
+ *
+ * Initialize a new list with ZLIST_INITIALIZER (or any other way of zeroing 
+ * it), e.g. "zlisti l = ZLIST_INITIALIZER;".  Code written before the cap 
+ * field existed, which sets just len = 0 and arr = NULL, keeps working: a NULL 
+ * arr is always treated as having no capacity.
  *
  * The optional macro DECLARE_ZLIST_CONTAINS_ITEM expands to:
  *
@@ -68,18 +89,422 @@ static char const* const zlist_vernum = "0.9.0";
  * Here is the documentation for each of these functions:
  *
  * void zlisti_resize(zlisti* l, size_t len):
- *     Resize the array (with realloc()) so that it has capacity for len items.
+ *     Set the length of the list to len.  If the capacity is too small it is 
+ *     enlarged (with realloc()) to at least double its old size.  Shrinking 
+ *     never gives memory back; use shrink_to_fit() or free() for that.  Items 
+ *     in slots that become newly part of the list are uninitialized.
+ *
+ * void zlistname_reserve(zlistname* l, size_t cap):
+ *     Make sure that the list has room for at least cap items without 
+ *     reallocating.  Never shrinks the list.
+ *
+ * void zlistname_shrink_to_fit(zlistname* l):
+ *     Reallocate the array so that its capacity is exactly len.
  *
  * void zlistname_append(zlistname* l, containedtype item):
- *     Enlarge the array by one and store item in the newly allocated
- *     (highest-indexed) slot.
+ *     Enlarge the list by one and store item in the newly allocated
+ *     (highest-indexed) slot.  Reallocates only when the capacity is used up.
+ *
+ * void zlistname_clear(zlistname* l):
+ *     Set l.len = 0 but keep the memory around for reuse.
  *
  * void zlistname_free(zlistname* l):
- *     free the memory, set l.arr = NULL and l.len = 0;  Okay to call this on an 
- *     already-freed list.
+ *     free the memory, set l.arr = NULL and l.len = l.cap = 0;  Okay to call 
+ *     this on an already-freed list.
+ *
+ * void zlistname_extend(zlistname* l, const containedtype* items, size_t n):
+ *     Append the n items starting at items, with at most one realloc() and 
+ *     one memcpy().  items must not point into l itself.
+ *
+ * void zlistname_insert_range(zlistname* l, size_t at, const containedtype* items, size_t n):
+ *     Insert the n items starting at items so that the first of them ends up 
+ *     at index at, moving the items from index at onwards up by n with a 
+ *     single memmove().  items must not point into l itself.
+ *
+ * void zlistname_erase_range(zlistname* l, size_t at, size_t n):
+ *     Remove the n items starting at index at, moving the later items down.
+ *
+ * void zlistname_swap_remove(zlistname* l, size_t i):
+ *     Remove the item at index i in constant time by moving the last item 
+ *     into its place.  This doesn't preserve the order of the list.
+ *
+ * containedtype zlistname_pop(zlistname* l):
+ *     Remove the last item and return it.  The list must not be empty.
+ *
+ * void zlistname_copy(zlistname* dst, const zlistname* src):
+ *     Make dst's items a copy of src's.  dst must be an initialized list 
+ *     (its old items are discarded but its memory is reused).
  *
  * bool zlistname_contains_item(zlistname l, containedtype item):
- *      Iterates the list and returns true if any element == item.
+ *      Iterates the list and returns true if any element == item.  This takes 
+ *      time proportional to the length of the list; if you need to test 
+ *      membership in a big collection over and over, use a zhash set (see 
+ *      zhash.h) instead.
+ *
+ * When the contained type is an integer or pointer type, you can use 
+ * DECLARE_ZLIST_SCALAR_FIND and DEFINE_ZLIST_SCALAR_FIND instead of the 
+ * CONTAINS_ITEM macros.  They generate contains_item() with the same 
+ * signature, plus find() and count(), all of which compare many items per 
+ * instruction with SSE2 or AVX2 (see zscan.h).  They compare items 
+ * bit-for-bit, so don't use them for floating point types or structs.
+ *
+ * size_t zlistname_find(zlistname l, containedtype item):
+ *      Returns the index of the first element equal to item, or l.len if 
+ *      there isn't one.
+ *
+ * size_t zlistname_count(zlistname l, containedtype item):
+ *      Returns the number of elements equal to item.
+ *
+ *
+ * Sorting
+ *
+ * DECLARE_ZLIST_SORT(typ, nam) and DEFINE_ZLIST_SORT(typ, nam, lessfn) 
+ * generate an introsort for the list, where lessfn(a, b) is true if a sorts 
+ * before b.  ZLIST_LESS is "<", for types which can be compared with it.  
+ * lessfn is expanded inline, so unlike with qsort() there is no function call 
+ * per comparison.  The sort is not stable.
+ *
+ * For lists of integers, DECLARE_ZLIST_RADIX_SORT(typ, nam) and 
+ * DEFINE_ZLIST_RADIX_SORT(typ, nam) instead generate a radix sort (see 
+ * zsort.h), which takes time linear in the length of the list, skips 
+ * byte positions that are the same in every element, and can use several 
+ * threads.  Use one or the other on a given list type, not both.  Both 
+ * generate:
+ *
+ * void zlistname_sort(zlistname* l):
+ *      Sort l in ascending order.
+ *
+ * void zlistname_sort_range(containedtype* a, size_t n):
+ *      Sort the n elements starting at a -- e.g. part of a list.
+ *
+ * and the radix sort also generates:
+ *
+ * void zlistname_sort_mt(zlistname* l, size_t nthreads):
+ *      Sort l using up to nthreads threads.
+ *
+ * Segmented lists
+ *
+ * DECLARE_ZLIST_SEGMENTED(typ, nam, shift) and DEFINE_ZLIST_SEGMENTED(typ, 
+ * nam) generate a list which stores its items in separately allocated chunks 
+ * of 2^shift items each, reached through a directory of chunk pointers.  
+ * Growing it allocates new chunks and at most reallocates the 
+ * (small) directory, so items never move: pointers to items stay good until 
+ * the list is freed, and growing never copies the items or needs room for two 
+ * copies of them.  This is for really big lists.  The price is that the items 
+ * aren't in one contiguous array, so there is no arr field:
+ *
+ * typedef struct {
+ * 	size_t len;
+ * 	typ** chunks;
+ * 	size_t nchunks;
+ * 	size_t dircap;
+ * } nam;
+ *
+ * typ* nam_at(const nam* l, size_t i);
+ * typ nam_get(const nam* l, size_t i);
+ * void nam_set(nam* l, size_t i, typ item);
+ * void nam_resize(nam* l, size_t len);
+ * void nam_reserve(nam* l, size_t cap);
+ * void nam_append(nam* l, typ item);
+ * void nam_clear(nam* l);
+ * void nam_free(nam* l);
+ *
+ * at() returns a pointer to the item at index i (which must be < len).  The 
+ * macro ZLIST_SEGMENTED_AT(nam, l, i) does the same inline, given the list 
+ * itself rather than a pointer to it, and without checking i; it is just a 
+ * shift and a mask.  clear() keeps the chunks for reuse.  Initialize a new 
+ * list with ZLIST_SEGMENTED_INITIALIZER or by zeroing it.
+ *
+ *
+ * File-backed lists
+ *
+ * DECLARE_ZLIST_MMAP(typ, nam) and DEFINE_ZLIST_MMAP(typ, nam) generate a 
+ * list whose array lives in a memory-mapped file instead of on the heap, for 
+ * lists which are bigger than RAM or which you want to keep between runs.  
+ * The kernel pages the items in and out of the file as needed, so a huge list 
+ * doesn't push the rest of the process into swap, and opening an existing 
+ * file just maps it, so it is instant no matter how big the list is.  l.len 
+ * and l.arr are used just as for a plain zlist, and resize(), reserve(), 
+ * append(), clear() and the range operations work as above.  Growing the 
+ * list grows the file with ftruncate() and the mapping with mremap(), so 
+ * l.arr may move, as with realloc().  The struct has one more field, "file", 
+ * which you needn't look at.  Only lists of plain data (no pointers) make 
+ * sense here.
+ *
+ * bool zlistname_open(zlistname* l, const char* path, bool readonly):
+ *     Open the list stored in the file path, creating an empty one if the 
+ *     file doesn't exist (unless readonly).  Returns false, with errno set, if 
+ *     the file can't be opened or isn't a list of this element size.  A 
+ *     readonly list may be read through l.arr but not changed; any of the 
+ *     functions which would change it fails a runtime_assert().
+ *
+ * void zlistname_sync(zlistname* l):
+ *     Checkpoint: msync() the items, then record the current length in the 
+ *     file and msync() that, so that if the process dies later, reopening 
+ *     the file gives the list as it is now, and a crash during the sync() 
+ *     leaves the length as it was.  Without a sync() the file's recorded 
+ *     length is whatever it was at the last sync() or close().
+ *
+ * void zlistname_close(zlistname* l):
+ *     sync(), give back the file space beyond l.len and unmap the file.  Okay 
+ *     to call this on an already-closed list.
+ *
+ * Aligned lists
+ *
+ * DECLARE_ZLIST_ALIGNED(typ, nam) and DEFINE_ZLIST_ALIGNED(typ, nam, align, 
+ * hugebytes) generate a list whose l.arr is always a multiple of align bytes 
+ * (a power of 2, e.g. 64 for a cache line or 32 for AVX2 loads), and which, 
+ * once its capacity reaches hugebytes bytes, keeps its array in pages of its 
+ * own, aligned to ZLIST_HUGE_PAGE (2 MB) and marked MADV_HUGEPAGE.  Where 
+ * the kernel has transparent huge pages turned on (even just for madvise()d 
+ * memory) each TLB entry then covers 2 MB of the list instead of 4 KB, which 
+ * speeds up scans and random access over lists of hundreds of megabytes and 
+ * up.  A hugebytes of 0 means never; 32 << 20 is a reasonable threshold.  
+ * Growing a list which is already that big moves its pages with mremap() 
+ * rather than copying them (on Linux).  Everything else is as for a plain 
+ * zlist, and all of its functions are generated with the same signatures.
+ *
+ * Serialized lists
+ *
+ * DECLARE_ZLIST_SERIAL(typ, nam) and DEFINE_ZLIST_SERIAL(typ, nam) add 
+ * functions to write a list of fixed-width integers (typ of 1, 2, 4 or 8 
+ * bytes) to a buffer and read it back, to any list type with len and arr 
+ * and a resize() -- a plain zlist, an aligned or SBO one, etc.  The 
+ * serialized form is a ZLIST_SERIAL_HEADER-byte (32) header -- a magic 
+ * number, the byte order and width of the items, their number, a CRC-32C of 
+ * the items and one of the header -- followed by the items exactly as they 
+ * are in memory.  So writing is one memcpy() (and a checksum), and reading 
+ * on a machine with the same byte order is another, or nothing at all: a 
+ * view points straight at the items, e.g. in a file you have mmap()'d.  A 
+ * machine with the other byte order swaps the bytes as it reads.
+ *
+ * size_t zlistname_serialized_size(const zlistname* l):
+ *     The number of bytes zlistname_serialize() will write.
+ *
+ * void zlistname_serialize(const zlistname* l, zbyte* buf):
+ *     Write l to buf.
+ *
+ * bool zlistname_deserialize(zlistname* l, const zbyte* buf, size_t len):
+ *     Replace the contents of l with the list serialized in the (at least) 
+ *     len bytes at buf.  Returns false, leaving l alone, if those bytes 
+ *     aren't a list of items of this width or the checksums don't match.
+ *
+ * bool zlistname_view(zlistname_readonly* v, const zbyte* buf, size_t len, bool verify):
+ *     Point v, a struct with fields "size_t len" and "const typ* arr", at 
+ *     the items serialized in the len bytes at buf, without copying them.  
+ *     The bytes must stay put while v is in use.  Checking the items' 
+ *     checksum is a pass over them, so it is only done if verify is true.  
+ *     Returns false if the bytes are malformed, or if they can't be used in 
+ *     place because they are in the other byte order or aren't aligned for 
+ *     typ (buf should be aligned as for typ) -- use deserialize() then.
+ *
+ * Slices
+ *
+ * DECLARE_ZLIST_SLICE(typ, nam) and DEFINE_ZLIST_SLICE(typ, nam) generate a 
+ * slice type for a list of integers or pointers, a view of a run of the 
+ * list's items which doesn't own them:
+ *
+ * typedef struct {
+ * 	size_t len;
+ * 	typ* arr;
+ * } nam_slice;
+ *
+ * A slice is two words and is passed by value, so handing part of a list to 
+ * a function costs no allocation and no copying.  The slice points into the 
+ * list's array, so it is only good until the list is resized, reserved or 
+ * freed, and changing an item through the slice changes the list.  Any list 
+ * type with len and arr will do (a plain zlist, an aligned one, etc.), and 
+ * so will a zlistname_readonly view of a serialized list if you cast away 
+ * the const.  Because slice_sort() calls the list's sort_range(), the list 
+ * also needs DECLARE_ZLIST_SORT or DECLARE_ZLIST_RADIX_SORT.  Indexes out of 
+ * range fail a runtime_assert.
+ *
+ * nam_slice nam_slice_of(const nam* l, size_t at, size_t n):
+ *      The n items of l starting at index at.  slice_of(&l, 0, l.len) is all 
+ *      of l.
+ *
+ * nam_slice nam_subslice(nam_slice s, size_t at, size_t n):
+ *      The n items of s starting at index at.
+ *
+ * void nam_split_at(nam_slice s, size_t at, nam_slice* head, nam_slice* tail):
+ *      Cut s in two: head gets the first at items and tail the rest.
+ *
+ * bool nam_split_next(nam_slice* rest, typ sep, nam_slice* field):
+ *      Take the items up to the first sep off the front of rest, and put them 
+ *      in field; rest loses those and the sep.  Returns false, when rest is 
+ *      empty, instead.  So a loop "while (split_next(&rest, '\n', &line))" 
+ *      visits every line, including empty ones between two seps, but not an 
+ *      empty one after a final sep.
+ *
+ * size_t nam_chunk_count(nam_slice s, size_t size):
+ * nam_slice nam_chunk(nam_slice s, size_t size, size_t i):
+ *      Chunk i of s cut into chunks of size items, the last of which may be 
+ *      shorter.
+ *
+ * size_t nam_window_count(nam_slice s, size_t width):
+ * nam_slice nam_window(nam_slice s, size_t width, size_t i):
+ *      The sliding window of width items starting at index i.  There are 
+ *      s.len - width + 1 windows, or none if s is shorter than width.
+ *
+ * size_t nam_slice_find(nam_slice s, typ item):
+ * bool nam_slice_contains(nam_slice s, typ item):
+ * size_t nam_slice_count(nam_slice s, typ item):
+ *      As find(), contains_item() and count() for SCALAR_FIND lists.
+ *
+ * bool nam_slice_minmax(nam_slice s, typ* min, typ* max):
+ *      Set *min and *max to the smallest and largest items of s, in one pass.  
+ *      Returns false, leaving them alone, if s is empty.
+ *
+ * void nam_slice_sort(nam_slice s):
+ *      Sort the items of s, in place in the list.
+ *
+ * Structure-of-arrays lists
+ *
+ * For records of which you usually only look at one or two fields at a time, 
+ * DECLARE_ZLIST_SOA(fields, nam) and DEFINE_ZLIST_SOA(fields, nam) generate a 
+ * list which keeps each field in its own array (a "column"), so that a scan 
+ * over one field reads only that field's bytes and the compiler can 
+ * vectorize it.  fields is the name of a macro which lists the fields, by 
+ * applying its argument to each (type, name) pair:
+ *
+ * #define POINT_FIELDS(F) F(double, x) F(double, y) F(int, id)
+ * DECLARE_ZLIST_SOA(POINT_FIELDS, zpoints)
+ * DEFINE_ZLIST_SOA(POINT_FIELDS, zpoints)
+ *
+ * generates a struct zpoints_row with the fields x, y and id, and a list:
+ *
+ * typedef struct {
+ * 	size_t len;
+ * 	size_t cap;
+ * 	double* x;
+ * 	double* y;
+ * 	int* id;
+ * } zpoints;
+ *
+ * where l.x[i] is the x field of row i, plus the following functions.  All of 
+ * the columns always have the same length and capacity.  Initialize a new 
+ * list with ZLIST_SOA_INITIALIZER or by zeroing it.
+ *
+ * void nam_reserve(nam* l, size_t cap);
+ * void nam_resize(nam* l, size_t len);
+ * void nam_append(nam* l, nam_row row);
+ * nam_row nam_get(const nam* l, size_t i);
+ * void nam_set(nam* l, size_t i, nam_row row);
+ * void nam_swap_remove(nam* l, size_t i);
+ * void nam_clear(nam* l);
+ * void nam_free(nam* l);
+ *
+ * Sorted lists
+ *
+ * If the contained type can be compared with "<", DECLARE_ZLIST_SORTED(typ, 
+ * nam) and DEFINE_ZLIST_SORTED(typ, nam) (used in addition to DECLARE_ZLIST 
+ * and DEFINE_ZLIST) generate functions for keeping a list in ascending order 
+ * and searching it, plus a separate search index type:
+ *
+ * typedef struct {
+ * 	size_t len;
+ * 	typ* eyt;
+ * } zlistname_index;
+ *
+ * void zlistname_insert_sorted(zlistname* l, containedtype item):
+ *      Insert item after any elements which are <= it, keeping l sorted.
+ *
+ * size_t zlistname_lower_bound(zlistname l, containedtype item):
+ *      Returns the index of the first element which is not < item, or l.len 
+ *      if there isn't one.  l has to be sorted.  The search is a branch-free 
+ *      binary search, so it doesn't suffer branch mispredictions.
+ *
+ * void zlistname_build_index(zlistname l, zlistname_index* ix):
+ *      Build (or rebuild) ix from the sorted list l.  ix holds a copy of the 
+ *      elements in "Eytzinger" order -- the breadth-first order of the binary 
+ *      search tree -- so that the first few levels of every search share a 
+ *      few cache lines and later levels can be prefetched.  Initialize ix to 
+ *      all zeroes before its first use.  The index doesn't see later changes 
+ *      to the list; rebuild it.
+ *
+ * const containedtype* zlistname_index_lower_bound(const zlistname_index* ix, containedtype item):
+ *      Returns a pointer to the first element (in sorted order) which is not 
+ *      < item, or NULL if there isn't one.  This is usually much faster than 
+ *      lower_bound() on big read-mostly tables.
+ *
+ * void zlistname_index_free(zlistname_index* ix):
+ *      Free the index's memory.
+ *
+ *
+ * Arena-backed lists
+ *
+ * DECLARE_ZLIST_ARENA(typ, nam) and DEFINE_ZLIST_ARENA(typ, nam) generate a 
+ * list which gets its memory from a zarena (see zarena.h) instead of from 
+ * realloc().  Its struct has one more field, "zarena* arena", and it has to be 
+ * initialized with nam_init(&l, &arena) before use.  resize(), reserve(), 
+ * append(), clear() and the range operations (extend() etc.) work just as 
+ * above.  free() merely forgets the memory; 
+ * it is actually released, along with everything else in the arena, when the 
+ * arena is freed or reset.  Growing the most recently allocated list in an 
+ * arena happens in place when there is room left in the arena's chunk.  
+ * DECLARE_ZLIST_CONTAINS_ITEM and DEFINE_ZLIST_CONTAINS_ITEM work on 
+ * arena-backed lists too.
+ *
+ * void zlistname_init(zlistname* l, zarena* arena):
+ *     Make l an empty list which allocates from arena.
+ *
+ *
+ * Lists with inline storage
+ *
+ * DECLARE_ZLIST_SBO(typ, nam, N) and DEFINE_ZLIST_SBO(typ, nam, N) generate a 
+ * list which keeps up to N items in an array inside the struct itself (field 
+ * "typ buf[N]") and only goes to the heap when it grows beyond N items.  This 
+ * saves a malloc() for every list that stays small.  l.arr points at l.buf 
+ * while the list is small, so l.len and l.arr are used just as for a plain 
+ * zlist, and all of the functions of a plain zlist are generated with the same 
+ * signatures.  shrink_to_fit() moves the items back into buf if they fit.
+ * DECLARE_ZLIST_CONTAINS_ITEM and DEFINE_ZLIST_CONTAINS_ITEM work on these 
+ * lists too.
+ *
+ * Because arr may point into the struct itself, don't copy such a list by 
+ * value and then modify the copy or let the copy outlive the original -- pass 
+ * pointers around instead.  (Passing it by value to contains_item() is fine.)
+ *
+ *
+ * Statistics
+ *
+ * If you compile with Z_ZLIST_STATS defined (e.g. -DZ_ZLIST_STATS in 
+ * CPPFLAGS) the plain, arena, SBO and mmap'd list generators also count, for 
+ * each list type, how often its lists are (re)allocated, how many bytes of 
+ * items those reallocations had to carry along, the longest any of its lists 
+ * has been, and how many contains_item() calls it has had and how many items 
+ * they looked at.  DEFINE_ZLIST(typ, nam) and the others define a global 
+ * "zlist_stats nam_stats" holding them, which is registered the first time it 
+ * changes, so zlist_stats_dump() lists just the types which have been used.  
+ * Without Z_ZLIST_STATS the counting compiles to nothing at all, and the 
+ * dump is empty.  Compile every file that uses a given list type the same 
+ * way.  The counters aren't atomic, so they are approximate if lists of the 
+ * same type are used by several threads at once.
+ */
+
+typedef struct zlist_stats {
+	const char* name; /* the list type's name */
+	size_t resizes; /* allocations and reallocations of arr */
+	size_t bytes_copied; /* items (in bytes) which those had to move */
+	size_t peak_len;
+	size_t contains_calls;
+	size_t elements_scanned; /* by those contains_item() calls */
+	bool registered;
+	struct zlist_stats* next;
+} zlist_stats;
+
+/**
+ * Write the statistics of every list type which has been used since the 
+ * last reset to f, either as text, one line per type, or as a single JSON 
+ * object with a member per type.
+ */
+void zlist_stats_dump(FILE* f, bool json);
+
+/**
+ * Zero the statistics of every list type.
  */
+void zlist_stats_reset(void);
+
+void _zlist_stats_register(zlist_stats* s);
 
 #endif /* #ifndef __INCL_zlist_h */
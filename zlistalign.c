@@ -0,0 +1,115 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifdef __linux__
+#define _GNU_SOURCE /* for mremap() */
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "zlist.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+static bool _zlist_is_huge(const size_t bytes, const size_t hugebytes)
+{
+	return (hugebytes != 0) && (bytes >= hugebytes);
+}
+
+static size_t _zlist_huge_round(const size_t bytes)
+{
+	runtime_assert(bytes <= Z_SIZE_T_MAX - 2 * ZLIST_HUGE_PAGE, "memory exhaustion");
+	return (bytes + ZLIST_HUGE_PAGE - 1) & ~(size_t)(ZLIST_HUGE_PAGE - 1);
+}
+
+/* Map len bytes starting at a multiple of ZLIST_HUGE_PAGE, by mapping a huge 
+   page more than that and unmapping the ends, so that every huge page of the 
+   range can be a real one. */
+static unsigned char* _zlist_huge_map(const size_t len, const int prot)
+{
+	unsigned char* const p = (unsigned char*)mmap(NULL, len + ZLIST_HUGE_PAGE, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	size_t head;
+	runtime_assert(p != (unsigned char*)MAP_FAILED, "memory exhaustion");
+	head = (ZLIST_HUGE_PAGE - ((uintptr_t)p & (ZLIST_HUGE_PAGE - 1))) & (ZLIST_HUGE_PAGE - 1);
+	if (head > 0) {
+		munmap(p, head);
+	}
+	munmap(p + head + len, ZLIST_HUGE_PAGE - head);
+	return p + head;
+}
+
+static void _zlist_huge_advise(void* const p, const size_t len)
+{
+#ifdef MADV_HUGEPAGE
+	(void)madvise(p, len, MADV_HUGEPAGE); /* only a hint; fine if it fails */
+#else
+	(void)p;
+	(void)len;
+#endif
+}
+
+void _zlist_aligned_free(void* const p, const size_t capbytes, const size_t hugebytes)
+{
+	if (p == NULL) {
+		return;
+	}
+	if (_zlist_is_huge(capbytes, hugebytes)) {
+		munmap(p, _zlist_huge_round(capbytes));
+	} else {
+		free(p);
+	}
+}
+
+void* _zlist_aligned_realloc(void* const old, const size_t oldcapbytes, const size_t usedbytes, const size_t newbytes, const size_t align, const size_t hugebytes)
+{
+	void* p;
+	size_t size;
+	runtime_assert((align >= sizeof(void*)) && ((align & (align - 1)) == 0), "The alignment must be a power of 2 and at least the size of a pointer.");
+	if (_zlist_is_huge(newbytes, hugebytes)) {
+		size = _zlist_huge_round(newbytes);
+#if defined(__linux__) && defined(MREMAP_FIXED)
+		if ((old != NULL) && _zlist_is_huge(oldcapbytes, hugebytes)) {
+			const size_t oldsize = _zlist_huge_round(oldcapbytes);
+			if (size <= oldsize) {
+				if (size < oldsize) {
+					munmap((unsigned char*)old + size, oldsize - size);
+				}
+				return old;
+			}
+			/* Move the pages into a fresh aligned range rather than copying 
+			   them: this is as cheap for a gigabyte as for a megabyte. */
+			p = mremap(old, oldsize, size, MREMAP_MAYMOVE | MREMAP_FIXED, _zlist_huge_map(size, PROT_NONE));
+			runtime_assert(p != MAP_FAILED, "memory exhaustion");
+			_zlist_huge_advise(p, size);
+			return p;
+		}
+#endif
+		p = _zlist_huge_map(size, PROT_READ | PROT_WRITE);
+		_zlist_huge_advise(p, size);
+	} else {
+		/* aligned_alloc() wants a multiple of the alignment */
+		runtime_assert(newbytes <= Z_SIZE_T_MAX - align, "memory exhaustion");
+		size = (newbytes + align - 1) & ~(align - 1);
+		p = aligned_alloc(align, (size == 0) ? align : size);
+		runtime_assert(p != NULL, "memory exhaustion");
+	}
+	if (old != NULL) {
+		memcpy(p, old, (usedbytes < newbytes) ? usedbytes : newbytes);
+		_zlist_aligned_free(old, oldcapbytes, hugebytes);
+	}
+	return p;
+}
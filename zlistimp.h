@@ -13,35 +13,469 @@
 #ifndef __INCL_zlistimp_h
 #define __INCL_zlistimp_h
 
+#include <stdlib.h>
+#include <string.h>
+
+#include "moreassert.h"
+#include "zarena.h"
+#include "zscan.h"
+#include "zsort.h"
+
+/* The smallest capacity that a growing list jumps to. */
+#define ZLIST_MIN_CAP 4
+
+/* Returns the capacity a list of elemsize-sized items with capacity cap should
+   grow to so that it can hold at least needed items: at least double the old 
+   capacity, so that a sequence of appends costs amortized O(1) apiece. */
+size_t _zlist_grow_cap(size_t cap, size_t needed, size_t elemsize);
+
+#define ZLIST_INITIALIZER { 0, NULL, 0 }
+
+/* The statistics hooks (see "Statistics" in zlist.h).  _ZLIST_STATS_GROW is 
+   for each (re)allocation of arr which carries bytes of items along, and 
+   _ZLIST_STATS_LEN for each time the length may have grown. */
+#ifdef Z_ZLIST_STATS
+#define _DECLARE_ZLIST_STATS(nam) \
+extern zlist_stats nam##_stats;
+#define _DEFINE_ZLIST_STATS(nam) \
+zlist_stats nam##_stats = { #nam, 0, 0, 0, 0, 0, 0, NULL };
+#define _ZLIST_STATS_TOUCH(nam) \
+	if (!nam##_stats.registered) { _zlist_stats_register(&nam##_stats); }
+#define _ZLIST_STATS_GROW(nam, bytes) do { \
+	_ZLIST_STATS_TOUCH(nam) \
+	nam##_stats.resizes++; \
+	nam##_stats.bytes_copied += (bytes); \
+} while (0)
+#define _ZLIST_STATS_LEN(nam, len) do { \
+	if ((len) > nam##_stats.peak_len) { \
+		_ZLIST_STATS_TOUCH(nam) \
+		nam##_stats.peak_len = (len); \
+	} \
+} while (0)
+#define _ZLIST_STATS_SCAN(nam, n) do { \
+	_ZLIST_STATS_TOUCH(nam) \
+	nam##_stats.contains_calls++; \
+	nam##_stats.elements_scanned += (n); \
+} while (0)
+#else
+#define _DECLARE_ZLIST_STATS(nam)
+#define _DEFINE_ZLIST_STATS(nam)
+#define _ZLIST_STATS_GROW(nam, bytes) ((void)0)
+#define _ZLIST_STATS_LEN(nam, len) ((void)0)
+#define _ZLIST_STATS_SCAN(nam, n) ((void)0)
+#endif
+
+/* Operations on whole ranges of items, shared by all of the list flavours.  
+   They only need len, arr, and the flavour's reserve() and resize().  
+   writable(l) is a statement run first by every operation which modifies l, 
+   for flavours which can refuse to be modified. */
+#define _DECLARE_ZLIST_BULK(typ, nam) \
+void nam##_extend(nam* l, const typ* items, size_t n); \
+void nam##_insert_range(nam* l, size_t at, const typ* items, size_t n); \
+void nam##_erase_range(nam* l, size_t at, size_t n); \
+void nam##_swap_remove(nam* l, size_t i); \
+typ nam##_pop(nam* l); \
+void nam##_copy(nam* dst, const nam* src); \
+_DECLARE_ZLIST_STATS(nam)
+
+#define _DEFINE_ZLIST_BULK_CHECKED(typ, nam, writable) \
+void nam##_extend(nam*const l, const typ*const items, const size_t n) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	writable(l); \
+	runtime_assert((items != NULL) || (n == 0), "You are required to pass a non-NULL array."); \
+	if (n == 0) { return; } \
+	runtime_assert(n <= Z_SIZE_T_MAX - l->len, "memory exhaustion"); \
+	nam##_resize(l, l->len + n); \
+	memcpy(l->arr + l->len - n, items, sizeof(typ) * n); \
+} \
+ \
+void nam##_insert_range(nam*const l, const size_t at, const typ*const items, const size_t n) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	writable(l); \
+	runtime_assert((items != NULL) || (n == 0), "You are required to pass a non-NULL array."); \
+	runtime_assert(at <= l->len, "Index out of range."); \
+	if (n == 0) { return; } \
+	runtime_assert(n <= Z_SIZE_T_MAX - l->len, "memory exhaustion"); \
+	nam##_resize(l, l->len + n); \
+	memmove(l->arr + at + n, l->arr + at, sizeof(typ) * (l->len - n - at)); \
+	memcpy(l->arr + at, items, sizeof(typ) * n); \
+} \
+ \
+void nam##_erase_range(nam*const l, const size_t at, const size_t n) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	writable(l); \
+	runtime_assert((at <= l->len) && (n <= l->len - at), "Index out of range."); \
+	if (n == 0) { return; } \
+	memmove(l->arr + at, l->arr + at + n, sizeof(typ) * (l->len - at - n)); \
+	l->len -= n; \
+} \
+ \
+void nam##_swap_remove(nam*const l, const size_t i) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	writable(l); \
+	runtime_assert(i < l->len, "Index out of range."); \
+	l->arr[i] = l->arr[l->len - 1]; \
+	l->len--; \
+} \
+ \
+typ nam##_pop(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	writable(l); \
+	runtime_assert(l->len > 0, "You can't pop from an empty list."); \
+	l->len--; \
+	return l->arr[l->len]; \
+} \
+ \
+void nam##_copy(nam*const dst, const nam*const src) { \
+	runtime_assert((dst != NULL) && (src != NULL), "You are required to pass non-NULL pointers."); \
+	runtime_assert(dst != src, "You can't copy a list onto itself."); \
+	writable(dst); \
+	dst->len = 0; \
+	nam##_reserve(dst, src->len); \
+	nam##_extend(dst, src->arr, src->len); \
+} \
+ \
+_DEFINE_ZLIST_STATS(nam)
+
+#define _ZLIST_ALWAYS_WRITABLE(l) ((void)0)
+#define _DEFINE_ZLIST_BULK(typ, nam) _DEFINE_ZLIST_BULK_CHECKED(typ, nam, _ZLIST_ALWAYS_WRITABLE)
+
 #define DECLARE_ZLIST(typ, nam) \
 typedef struct { \
 	size_t len; \
 	typ* arr; \
+	size_t cap; \
 } nam; \
 void nam##_resize(nam* l, size_t len); \
+void nam##_reserve(nam* l, size_t cap); \
+void nam##_shrink_to_fit(nam* l); \
 void nam##_append(nam* l, typ item); \
-void nam##_free(nam* l);
+void nam##_clear(nam* l); \
+void nam##_free(nam* l); \
+_DECLARE_ZLIST_BULK(typ, nam)
 
 #define DECLARE_ZLIST_CONTAINS_ITEM(typ, nam) \
 bool nam##_contains_item(nam l, typ item);
 
+#define DECLARE_ZLIST_SCALAR_FIND(typ, nam) \
+size_t nam##_find(nam l, typ item); \
+bool nam##_contains_item(nam l, typ item); \
+size_t nam##_count(nam l, typ item);
+
+#define DECLARE_ZLIST_SORTED(typ, nam) \
+typedef struct { \
+	size_t len; \
+	typ* eyt; \
+} nam##_index; \
+void nam##_insert_sorted(nam* l, typ item); \
+size_t nam##_lower_bound(nam l, typ item); \
+void nam##_build_index(nam l, nam##_index* ix); \
+const typ* nam##_index_lower_bound(const nam##_index* ix, typ item); \
+void nam##_index_free(nam##_index* ix);
+
+/* A NULL arr always means that there is no allocation, regardless of what cap 
+   says, so that code which initializes only len and arr keeps working. */
 #define DEFINE_ZLIST(typ, nam) \
-void nam##_resize(nam* l, size_t len) { \
-	l->arr = (typ*)realloc(l->arr, sizeof(typ) * len);	\
-	runtime_assert((len == 0) || (l->arr != NULL), "memory exhaustion"); \
+void nam##_reserve(nam*const l, const size_t cap) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((l->arr != NULL) && (cap <= l->cap)) { return; } \
+	if (cap == 0) { return; } \
+	runtime_assert(cap <= Z_SIZE_T_MAX / sizeof(typ), "memory exhaustion"); \
+	_ZLIST_STATS_GROW(nam, (l->arr == NULL) ? 0 : sizeof(typ) * l->len); \
+	l->arr = (typ*)realloc(l->arr, sizeof(typ) * cap); \
+	runtime_assert(l->arr != NULL, "memory exhaustion"); \
+	l->cap = cap; \
+} \
+ \
+void nam##_resize(nam*const l, const size_t len) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((len > l->cap) || ((l->arr == NULL) && (len > 0))) { \
+		nam##_reserve(l, _zlist_grow_cap((l->arr == NULL) ? 0 : l->cap, len, sizeof(typ))); \
+	} \
 	l->len = len; \
+	_ZLIST_STATS_LEN(nam, len); \
+} \
+ \
+void nam##_shrink_to_fit(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (l->arr == NULL) { l->len = 0; l->cap = 0; return; } \
+	if (l->len == 0) { free(l->arr); l->arr = NULL; l->cap = 0; return; } \
+	if (l->len == l->cap) { return; } \
+	_ZLIST_STATS_GROW(nam, sizeof(typ) * l->len); \
+	l->arr = (typ*)realloc(l->arr, sizeof(typ) * l->len); \
+	runtime_assert(l->arr != NULL, "memory exhaustion"); \
+	l->cap = l->len; \
 } \
  \
 void nam##_append(nam*const l, const typ item) { \
 	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
-	nam##_resize(l, l->len+1); \
+	if ((l->len >= l->cap) || (l->arr == NULL)) { \
+		nam##_resize(l, l->len+1); \
+	} else { \
+		l->len++; \
+		_ZLIST_STATS_LEN(nam, l->len); \
+	} \
 	l->arr[l->len-1] = item; \
 } \
  \
+void nam##_clear(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	l->len = 0; \
+} \
+ \
 void nam##_free(nam*const l) { \
 	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
 	if (l->arr != NULL) { free(l->arr); l->arr = NULL; } \
 	l->len = 0; \
+	l->cap = 0; \
+} \
+ \
+_DEFINE_ZLIST_BULK(typ, nam)
+
+#define DECLARE_ZLIST_ARENA(typ, nam) \
+typedef struct { \
+	size_t len; \
+	typ* arr; \
+	size_t cap; \
+	zarena* arena; \
+} nam; \
+void nam##_init(nam* l, zarena* arena); \
+void nam##_resize(nam* l, size_t len); \
+void nam##_reserve(nam* l, size_t cap); \
+void nam##_append(nam* l, typ item); \
+void nam##_clear(nam* l); \
+void nam##_free(nam* l); \
+_DECLARE_ZLIST_BULK(typ, nam)
+
+#define DEFINE_ZLIST_ARENA(typ, nam) \
+void nam##_init(nam*const l, zarena*const arena) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(arena != NULL, "You are required to pass a non-NULL arena."); \
+	l->len = 0; \
+	l->arr = NULL; \
+	l->cap = 0; \
+	l->arena = arena; \
+} \
+ \
+void nam##_reserve(nam*const l, const size_t cap) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(l->arena != NULL, "You are required to call init() first."); \
+	if (cap <= l->cap) { return; } \
+	runtime_assert(cap <= Z_SIZE_T_MAX / sizeof(typ), "memory exhaustion"); \
+	_ZLIST_STATS_GROW(nam, sizeof(typ) * l->len); \
+	l->arr = (typ*)zarena_realloc(l->arena, l->arr, sizeof(typ) * l->cap, sizeof(typ) * cap); \
+	l->cap = cap; \
+} \
+ \
+void nam##_resize(nam*const l, const size_t len) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (len > l->cap) { \
+		nam##_reserve(l, _zlist_grow_cap(l->cap, len, sizeof(typ))); \
+	} \
+	l->len = len; \
+	_ZLIST_STATS_LEN(nam, len); \
+} \
+ \
+void nam##_append(nam*const l, const typ item) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (l->len >= l->cap) { \
+		nam##_resize(l, l->len+1); \
+	} else { \
+		l->len++; \
+		_ZLIST_STATS_LEN(nam, l->len); \
+	} \
+	l->arr[l->len-1] = item; \
+} \
+ \
+void nam##_clear(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	l->len = 0; \
+} \
+ \
+void nam##_free(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	l->arr = NULL; \
+	l->len = 0; \
+	l->cap = 0; \
+} \
+ \
+_DEFINE_ZLIST_BULK(typ, nam)
+
+/* An SBO list whose arr is NULL is empty and hasn't yet pointed arr at its 
+   inline buf, so that a zeroed struct is a valid empty list. */
+#define DECLARE_ZLIST_SBO(typ, nam, N) \
+typedef struct { \
+	size_t len; \
+	typ* arr; \
+	size_t cap; \
+	typ buf[N]; \
+} nam; \
+void nam##_resize(nam* l, size_t len); \
+void nam##_reserve(nam* l, size_t cap); \
+void nam##_shrink_to_fit(nam* l); \
+void nam##_append(nam* l, typ item); \
+void nam##_clear(nam* l); \
+void nam##_free(nam* l); \
+_DECLARE_ZLIST_BULK(typ, nam)
+
+#define DEFINE_ZLIST_SBO(typ, nam, N) \
+void nam##_reserve(nam*const l, const size_t cap) { \
+	typ* newarr; \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (l->arr == NULL) { l->arr = l->buf; l->cap = (N); } \
+	if (cap <= l->cap) { return; } \
+	runtime_assert(cap <= Z_SIZE_T_MAX / sizeof(typ), "memory exhaustion"); \
+	_ZLIST_STATS_GROW(nam, sizeof(typ) * l->len); \
+	if (l->arr == l->buf) { \
+		newarr = (typ*)malloc(sizeof(typ) * cap); \
+		runtime_assert(newarr != NULL, "memory exhaustion"); \
+		memcpy(newarr, l->buf, sizeof(typ) * l->len); \
+	} else { \
+		newarr = (typ*)realloc(l->arr, sizeof(typ) * cap); \
+		runtime_assert(newarr != NULL, "memory exhaustion"); \
+	} \
+	l->arr = newarr; \
+	l->cap = cap; \
+} \
+ \
+void nam##_resize(nam*const l, const size_t len) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((len > l->cap) || (l->arr == NULL)) { \
+		nam##_reserve(l, (len <= (N)) ? (N) : _zlist_grow_cap((l->arr == NULL) ? (N) : l->cap, len, sizeof(typ))); \
+	} \
+	l->len = len; \
+	_ZLIST_STATS_LEN(nam, len); \
+} \
+ \
+void nam##_shrink_to_fit(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((l->arr == NULL) || (l->arr == l->buf) || (l->len == l->cap)) { return; } \
+	if (l->len <= (N)) { \
+		memcpy(l->buf, l->arr, sizeof(typ) * l->len); \
+		free(l->arr); \
+		l->arr = l->buf; \
+		l->cap = (N); \
+		return; \
+	} \
+	l->arr = (typ*)realloc(l->arr, sizeof(typ) * l->len); \
+	runtime_assert(l->arr != NULL, "memory exhaustion"); \
+	l->cap = l->len; \
+} \
+ \
+void nam##_append(nam*const l, const typ item) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((l->len >= l->cap) || (l->arr == NULL)) { \
+		nam##_resize(l, l->len+1); \
+	} else { \
+		l->len++; \
+		_ZLIST_STATS_LEN(nam, l->len); \
+	} \
+	l->arr[l->len-1] = item; \
+} \
+ \
+void nam##_clear(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	l->len = 0; \
+} \
+ \
+void nam##_free(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((l->arr != NULL) && (l->arr != l->buf)) { free(l->arr); } \
+	l->arr = NULL; \
+	l->len = 0; \
+	l->cap = 0; \
+} \
+ \
+_DEFINE_ZLIST_BULK(typ, nam)
+
+/* A segmented list keeps its items in chunks of (1 << shift) items apiece, 
+   reached through a directory of chunk pointers.  Chunks are never moved or 
+   freed until the list is freed; only the directory is ever realloc()'d. */
+#define DECLARE_ZLIST_SEGMENTED(typ, nam, shift) \
+enum { nam##_shift = (shift) }; \
+typedef struct { \
+	size_t len; \
+	typ** chunks; \
+	size_t nchunks; \
+	size_t dircap; \
+} nam; \
+typ* nam##_at(const nam* l, size_t i); \
+typ nam##_get(const nam* l, size_t i); \
+void nam##_set(nam* l, size_t i, typ item); \
+void nam##_resize(nam* l, size_t len); \
+void nam##_reserve(nam* l, size_t cap); \
+void nam##_append(nam* l, typ item); \
+void nam##_clear(nam* l); \
+void nam##_free(nam* l);
+
+#define ZLIST_SEGMENTED_INITIALIZER { 0, NULL, 0, 0 }
+
+#define ZLIST_SEGMENTED_AT(nam, l, i) (&(l).chunks[(i) >> nam##_shift][(i) & ((((size_t)1) << nam##_shift) - 1)])
+
+#define DEFINE_ZLIST_SEGMENTED(typ, nam) \
+typ* nam##_at(const nam*const l, const size_t i) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(i < l->len, "Index out of range."); \
+	return ZLIST_SEGMENTED_AT(nam, *l, i); \
+} \
+ \
+typ nam##_get(const nam*const l, const size_t i) { \
+	return *nam##_at(l, i); \
+} \
+ \
+void nam##_set(nam*const l, const size_t i, const typ item) { \
+	*nam##_at(l, i) = item; \
+} \
+ \
+void nam##_reserve(nam*const l, const size_t cap) { \
+	const size_t chunklen = ((size_t)1) << nam##_shift; \
+	size_t needed; \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(chunklen <= Z_SIZE_T_MAX / sizeof(typ), "memory exhaustion"); \
+	needed = cap / chunklen + ((cap % chunklen) != 0); \
+	if (needed > l->dircap) { \
+		l->dircap = _zlist_grow_cap(l->dircap, needed, sizeof(typ*)); \
+		l->chunks = (typ**)realloc(l->chunks, sizeof(typ*) * l->dircap); \
+		runtime_assert(l->chunks != NULL, "memory exhaustion"); \
+	} \
+	while (l->nchunks < needed) { \
+		l->chunks[l->nchunks] = (typ*)malloc(sizeof(typ) * chunklen); \
+		runtime_assert(l->chunks[l->nchunks] != NULL, "memory exhaustion"); \
+		l->nchunks++; \
+	} \
+} \
+ \
+void nam##_resize(nam*const l, const size_t len) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	nam##_reserve(l, len); \
+	l->len = len; \
+} \
+ \
+void nam##_append(nam*const l, const typ item) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(l->len < Z_SIZE_T_MAX, "memory exhaustion"); \
+	if ((l->len >> nam##_shift) >= l->nchunks) { \
+		nam##_reserve(l, l->len + 1); \
+	} \
+	*ZLIST_SEGMENTED_AT(nam, *l, l->len) = item; \
+	l->len++; \
+} \
+ \
+void nam##_clear(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	l->len = 0; \
+} \
+ \
+void nam##_free(nam*const l) { \
+	size_t i; \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	for (i = 0; i < l->nchunks; i++) { \
+		free(l->chunks[i]); \
+	} \
+	if (l->chunks != NULL) { free(l->chunks); l->chunks = NULL; } \
+	l->len = 0; \
+	l->nchunks = 0; \
+	l->dircap = 0; \
 }
 
 #define DEFINE_ZLIST_CONTAINS_ITEM(typ, nam) \
@@ -49,10 +483,689 @@ bool nam##_contains_item(const nam l, const typ item) { \
 	size_t i; \
 	for (i = 0; i < l.len; i++) { \
 		if (l.arr[i] == item) { \
+			_ZLIST_STATS_SCAN(nam, i + 1); \
 			return true; \
 		} \
 	} \
+	_ZLIST_STATS_SCAN(nam, l.len); \
 	return false; \
 }
 
+#define DEFINE_ZLIST_SCALAR_FIND(typ, nam) \
+size_t nam##_find(const nam l, const typ item) { \
+	return zscan_find(l.arr, l.len, &item, sizeof(typ)); \
+} \
+ \
+bool nam##_contains_item(const nam l, const typ item) { \
+	const size_t i = zscan_find(l.arr, l.len, &item, sizeof(typ)); \
+	_ZLIST_STATS_SCAN(nam, (i < l.len) ? i + 1 : l.len); \
+	return i < l.len; \
+} \
+ \
+size_t nam##_count(const nam l, const typ item) { \
+	return zscan_count(l.arr, l.len, &item, sizeof(typ)); \
+}
+
+#ifdef __GNUC__
+#define _ZLIST_PREFETCH(p) __builtin_prefetch(p)
+#define _ZLIST_EYT_ASCEND(k) ((k) >> __builtin_ffsll(~(long long)(k)))
+#else
+#define _ZLIST_PREFETCH(p) ((void)0)
+#define _ZLIST_EYT_ASCEND(k) _zlist_eyt_ascend(k)
+#endif
+size_t _zlist_eyt_ascend(size_t k);
+
+/* In the Eytzinger layout the 64/sizeof(typ) descendants of node k which are 
+   log2(64/sizeof(typ)) levels further down sit together, starting at 
+   k * (64/sizeof(typ)), so prefetching that address every step keeps the 
+   search that many levels ahead of the cache misses. */
+#define _ZLIST_EYT_STRIDE(typ) ((sizeof(typ) < 64) ? (64 / sizeof(typ)) : 1)
+
+#define DEFINE_ZLIST_SORTED(typ, nam) \
+void nam##_insert_sorted(nam*const l, const typ item) { \
+	size_t lo = 0, hi, mid; \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	hi = l->len; \
+	while (lo < hi) { \
+		mid = lo + (hi - lo) / 2; \
+		if (item < l->arr[mid]) { hi = mid; } else { lo = mid + 1; } \
+	} \
+	nam##_resize(l, l->len + 1); \
+	memmove(l->arr + lo + 1, l->arr + lo, sizeof(typ) * (l->len - 1 - lo)); \
+	l->arr[lo] = item; \
+} \
+ \
+size_t nam##_lower_bound(const nam l, const typ item) { \
+	const typ* base = l.arr; \
+	size_t n = l.len; \
+	size_t half; \
+	if (n == 0) { return 0; } \
+	while (n > 1) { \
+		half = n / 2; \
+		base = (base[half - 1] < item) ? (base + half) : base; \
+		n -= half; \
+	} \
+	return (size_t)(base - l.arr) + (*base < item); \
+} \
+ \
+static size_t _##nam##_eyt_fill(const typ*const a, typ*const eyt, size_t i, const size_t k, const size_t n) { \
+	if (k <= n) { \
+		i = _##nam##_eyt_fill(a, eyt, i, 2 * k, n); \
+		eyt[k] = a[i++]; \
+		i = _##nam##_eyt_fill(a, eyt, i, 2 * k + 1, n); \
+	} \
+	return i; \
+} \
+ \
+void nam##_build_index(const nam l, nam##_index*const ix) { \
+	runtime_assert(ix != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(l.len < Z_SIZE_T_MAX / sizeof(typ), "memory exhaustion"); \
+	ix->eyt = (typ*)realloc(ix->eyt, sizeof(typ) * (l.len + 1)); \
+	runtime_assert(ix->eyt != NULL, "memory exhaustion"); \
+	ix->len = l.len; \
+	_##nam##_eyt_fill(l.arr, ix->eyt, 0, 1, l.len); \
+} \
+ \
+const typ* nam##_index_lower_bound(const nam##_index*const ix, const typ item) { \
+	const typ*const eyt = ix->eyt; \
+	const size_t n = ix->len; \
+	size_t k = 1; \
+	while (k <= n) { \
+		_ZLIST_PREFETCH(eyt + k * _ZLIST_EYT_STRIDE(typ)); \
+		k = 2 * k + (eyt[k] < item); \
+	} \
+	k = _ZLIST_EYT_ASCEND(k); \
+	return (k == 0) ? NULL : (eyt + k); \
+} \
+ \
+void nam##_index_free(nam##_index*const ix) { \
+	runtime_assert(ix != NULL, "You are required to pass a non-NULL pointer."); \
+	if (ix->eyt != NULL) { free(ix->eyt); ix->eyt = NULL; } \
+	ix->len = 0; \
+}
+
+/* A structure-of-arrays list is generated from an "X macro" listing the 
+   fields; each of the helpers below is applied to every (type, name) pair. */
+#define _ZLIST_SOA_ROW_FIELD(t, f) t f;
+#define _ZLIST_SOA_COLUMN(t, f) t* f;
+#define _ZLIST_SOA_FITS(t, f) && (cap <= Z_SIZE_T_MAX / sizeof(t))
+#define _ZLIST_SOA_REALLOC(t, f) \
+	l->f = (t*)realloc(l->f, sizeof(t) * cap); \
+	runtime_assert(l->f != NULL, "memory exhaustion");
+#define _ZLIST_SOA_STORE(t, f) l->f[i] = row.f;
+#define _ZLIST_SOA_LOAD(t, f) row.f = l->f[i];
+#define _ZLIST_SOA_MOVE_LAST(t, f) l->f[i] = l->f[l->len - 1];
+#define _ZLIST_SOA_FREE(t, f) \
+	if (l->f != NULL) { free(l->f); l->f = NULL; }
+
+#define ZLIST_SOA_INITIALIZER {0}
+
+#define DECLARE_ZLIST_SOA(fields, nam) \
+typedef struct { \
+	fields(_ZLIST_SOA_ROW_FIELD) \
+} nam##_row; \
+typedef struct { \
+	size_t len; \
+	size_t cap; \
+	fields(_ZLIST_SOA_COLUMN) \
+} nam; \
+void nam##_reserve(nam* l, size_t cap); \
+void nam##_resize(nam* l, size_t len); \
+void nam##_append(nam* l, nam##_row row); \
+nam##_row nam##_get(const nam* l, size_t i); \
+void nam##_set(nam* l, size_t i, nam##_row row); \
+void nam##_swap_remove(nam* l, size_t i); \
+void nam##_clear(nam* l); \
+void nam##_free(nam* l);
+
+#define DEFINE_ZLIST_SOA(fields, nam) \
+void nam##_reserve(nam*const l, const size_t cap) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (cap <= l->cap) { return; } \
+	runtime_assert(1 fields(_ZLIST_SOA_FITS), "memory exhaustion"); \
+	fields(_ZLIST_SOA_REALLOC) \
+	l->cap = cap; \
+} \
+ \
+void nam##_resize(nam*const l, const size_t len) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (len > l->cap) { \
+		nam##_reserve(l, _zlist_grow_cap(l->cap, len, sizeof(nam##_row))); \
+	} \
+	l->len = len; \
+} \
+ \
+void nam##_append(nam*const l, const nam##_row row) { \
+	size_t i; \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (l->len >= l->cap) { \
+		nam##_reserve(l, _zlist_grow_cap(l->cap, l->len + 1, sizeof(nam##_row))); \
+	} \
+	i = l->len++; \
+	fields(_ZLIST_SOA_STORE) \
+} \
+ \
+nam##_row nam##_get(const nam*const l, const size_t i) { \
+	nam##_row row; \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(i < l->len, "Index out of range."); \
+	fields(_ZLIST_SOA_LOAD) \
+	return row; \
+} \
+ \
+void nam##_set(nam*const l, const size_t i, const nam##_row row) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(i < l->len, "Index out of range."); \
+	fields(_ZLIST_SOA_STORE) \
+} \
+ \
+void nam##_swap_remove(nam*const l, const size_t i) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(i < l->len, "Index out of range."); \
+	fields(_ZLIST_SOA_MOVE_LAST) \
+	l->len--; \
+} \
+ \
+void nam##_clear(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	l->len = 0; \
+} \
+ \
+void nam##_free(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	fields(_ZLIST_SOA_FREE) \
+	l->len = 0; \
+	l->cap = 0; \
+}
+
+#define ZLIST_LESS(a, b) ((a) < (b))
+
+#define DECLARE_ZLIST_RADIX_SORT(typ, nam) \
+void nam##_sort_range(typ* a, size_t n); \
+void nam##_sort(nam* l); \
+void nam##_sort_mt(nam* l, size_t nthreads);
+
+#define DEFINE_ZLIST_RADIX_SORT(typ, nam) \
+void nam##_sort_range(typ*const a, const size_t n) { \
+	zsort_radix(a, n, sizeof(typ), ((typ)-1) < ((typ)0), 1); \
+} \
+ \
+void nam##_sort(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	zsort_radix(l->arr, l->len, sizeof(typ), ((typ)-1) < ((typ)0), 1); \
+} \
+ \
+void nam##_sort_mt(nam*const l, const size_t nthreads) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	zsort_radix(l->arr, l->len, sizeof(typ), ((typ)-1) < ((typ)0), nthreads); \
+}
+
+#define DECLARE_ZLIST_SORT(typ, nam) \
+void nam##_sort_range(typ* a, size_t n); \
+void nam##_sort(nam* l);
+
+/* Introsort: quicksort with a median-of-three pivot, which switches to 
+   heapsort if the recursion gets deeper than 2*log2(n) (so the worst case is 
+   O(n log n)), and leaves runs of up to ZLIST_SORT_NETWORK_MAX elements to a 
+   branch-free sorting network (Knuth's merge exchange).  lessfn is expanded 
+   inline everywhere, so it may be a macro. */
+#define ZLIST_SORT_NETWORK_MAX 16
+
+#define DEFINE_ZLIST_SORT(typ, nam, lessfn) \
+static void _##nam##_network(typ*const a, const size_t n) { \
+	size_t t, p, q, r, d, i; \
+	typ x, y; \
+	bool sw; \
+	if (n < 2) { return; } \
+	for (t = 0; ((size_t)1 << t) < n; t++) { } \
+	for (p = (size_t)1 << (t - 1); p > 0; p >>= 1) { \
+		q = (size_t)1 << (t - 1); \
+		r = 0; \
+		d = p; \
+		for (;;) { \
+			for (i = 0; i + d < n; i++) { \
+				if ((i & p) == r) { \
+					x = a[i]; \
+					y = a[i + d]; \
+					sw = lessfn(y, x); \
+					a[i] = sw ? y : x; \
+					a[i + d] = sw ? x : y; \
+				} \
+			} \
+			if (q == p) { break; } \
+			d = q - p; \
+			q >>= 1; \
+			r = p; \
+		} \
+	} \
+} \
+ \
+static void _##nam##_sift_down(typ*const a, size_t i, const size_t n) { \
+	const typ x = a[i]; \
+	size_t c; \
+	while ((c = 2 * i + 1) < n) { \
+		if ((c + 1 < n) && lessfn(a[c], a[c + 1])) { c++; } \
+		if (!lessfn(x, a[c])) { break; } \
+		a[i] = a[c]; \
+		i = c; \
+	} \
+	a[i] = x; \
+} \
+ \
+static void _##nam##_heapsort(typ*const a, const size_t n) { \
+	size_t i; \
+	typ x; \
+	for (i = n / 2; i > 0; i--) { \
+		_##nam##_sift_down(a, i - 1, n); \
+	} \
+	for (i = n - 1; i > 0; i--) { \
+		x = a[0]; a[0] = a[i]; a[i] = x; \
+		_##nam##_sift_down(a, 0, i); \
+	} \
+} \
+ \
+static void _##nam##_introsort(typ* a, size_t n, size_t depth) { \
+	size_t i, j; \
+	typ pivot, x; \
+	while (n > ZLIST_SORT_NETWORK_MAX) { \
+		if (depth == 0) { \
+			_##nam##_heapsort(a, n); \
+			return; \
+		} \
+		depth--; \
+		/* order a[0], a[n/2], a[n-1] and take the middle one as the pivot */ \
+		if (lessfn(a[n/2], a[0])) { x = a[0]; a[0] = a[n/2]; a[n/2] = x; } \
+		if (lessfn(a[n-1], a[n/2])) { x = a[n/2]; a[n/2] = a[n-1]; a[n-1] = x; \
+			if (lessfn(a[n/2], a[0])) { x = a[0]; a[0] = a[n/2]; a[n/2] = x; } } \
+		pivot = a[n/2]; \
+		/* Hoare partition; a[0] and a[n-1] are sentinels */ \
+		i = 0; \
+		j = n - 1; \
+		for (;;) { \
+			do { i++; } while (lessfn(a[i], pivot)); \
+			do { j--; } while (lessfn(pivot, a[j])); \
+			if (i >= j) { break; } \
+			x = a[i]; a[i] = a[j]; a[j] = x; \
+		} \
+		/* a[0..j] <= pivot <= a[j+1..n-1]; recurse on the smaller side */ \
+		if (j + 1 < n - j - 1) { \
+			_##nam##_introsort(a, j + 1, depth); \
+			a += j + 1; \
+			n -= j + 1; \
+		} else { \
+			_##nam##_introsort(a + j + 1, n - j - 1, depth); \
+			n = j + 1; \
+		} \
+	} \
+	_##nam##_network(a, n); \
+} \
+ \
+void nam##_sort_range(typ*const a, const size_t n) { \
+	size_t depth = 0, m; \
+	runtime_assert((a != NULL) || (n == 0), "You are required to pass a non-NULL array."); \
+	for (m = n; m > 1; m >>= 1) { depth += 2; } \
+	_##nam##_introsort(a, n, depth); \
+} \
+ \
+void nam##_sort(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	nam##_sort_range(l->arr, l->len); \
+}
+
+/* A file-backed list maps the whole file; the first ZLIST_MMAP_HEADER bytes 
+   are a header recording the element width and the length as of the last 
+   sync() or close(), and the items follow.  The file is grown with 
+   ftruncate() and the mapping with mremap(), a page at a time at least, and 
+   the capacity is whatever fits in the mapped file. */
+#define ZLIST_MMAP_HEADER 64
+typedef struct {
+	int fd;
+	unsigned char* base;
+	size_t maplen;
+	bool readonly;
+} _zlist_mmap_file;
+void* _zlist_mmap_open(_zlist_mmap_file* f, const char* path, bool readonly, size_t width, size_t* len);
+void* _zlist_mmap_reserve(_zlist_mmap_file* f, size_t bytes);
+void _zlist_mmap_sync(_zlist_mmap_file* f, size_t len, size_t width);
+void _zlist_mmap_close(_zlist_mmap_file* f, size_t len, size_t width);
+#define _ZLIST_MMAP_WRITABLE(l) runtime_assert(!(l)->file.readonly, "This list was opened read-only.")
+
+#define DECLARE_ZLIST_MMAP(typ, nam) \
+typedef struct { \
+	size_t len; \
+	typ* arr; \
+	size_t cap; \
+	_zlist_mmap_file file; \
+} nam; \
+bool nam##_open(nam* l, const char* path, bool readonly); \
+void nam##_resize(nam* l, size_t len); \
+void nam##_reserve(nam* l, size_t cap); \
+void nam##_append(nam* l, typ item); \
+void nam##_clear(nam* l); \
+void nam##_sync(nam* l); \
+void nam##_close(nam* l); \
+_DECLARE_ZLIST_BULK(typ, nam)
+
+#define DEFINE_ZLIST_MMAP(typ, nam) \
+bool nam##_open(nam*const l, const char*const path, const bool readonly) { \
+	size_t len; \
+	runtime_assert((l != NULL) && (path != NULL), "You are required to pass a non-NULL pointer."); \
+	l->arr = (typ*)_zlist_mmap_open(&l->file, path, readonly, sizeof(typ), &len); \
+	if (l->arr == NULL) { return false; } \
+	l->len = len; \
+	l->cap = (l->file.maplen - ZLIST_MMAP_HEADER) / sizeof(typ); \
+	return true; \
+} \
+ \
+void nam##_reserve(nam*const l, const size_t cap) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (cap <= l->cap) { return; } \
+	runtime_assert(!l->file.readonly, "This list was opened read-only."); \
+	runtime_assert(cap <= (Z_SIZE_T_MAX - ZLIST_MMAP_HEADER) / sizeof(typ), "memory exhaustion"); \
+	_ZLIST_STATS_GROW(nam, 0); \
+	l->arr = (typ*)_zlist_mmap_reserve(&l->file, sizeof(typ) * cap); \
+	l->cap = (l->file.maplen - ZLIST_MMAP_HEADER) / sizeof(typ); \
+} \
+ \
+void nam##_resize(nam*const l, const size_t len) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(!l->file.readonly, "This list was opened read-only."); \
+	if (len > l->cap) { \
+		nam##_reserve(l, _zlist_grow_cap(l->cap, len, sizeof(typ))); \
+	} \
+	l->len = len; \
+	_ZLIST_STATS_LEN(nam, len); \
+} \
+ \
+void nam##_append(nam*const l, const typ item) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (l->len >= l->cap) { \
+		nam##_resize(l, l->len+1); \
+	} else { \
+		runtime_assert(!l->file.readonly, "This list was opened read-only."); \
+		l->len++; \
+		_ZLIST_STATS_LEN(nam, l->len); \
+	} \
+	l->arr[l->len-1] = item; \
+} \
+ \
+void nam##_clear(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(!l->file.readonly, "This list was opened read-only."); \
+	l->len = 0; \
+} \
+ \
+void nam##_sync(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (!l->file.readonly) { _zlist_mmap_sync(&l->file, l->len, sizeof(typ)); } \
+} \
+ \
+void nam##_close(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (l->arr == NULL) { return; } \
+	_zlist_mmap_close(&l->file, l->len, sizeof(typ)); \
+	l->arr = NULL; \
+	l->len = 0; \
+	l->cap = 0; \
+} \
+ \
+_DEFINE_ZLIST_BULK_CHECKED(typ, nam, _ZLIST_MMAP_WRITABLE)
+
+/* An aligned list gets its array from _zlist_aligned_realloc(), which uses 
+   aligned_alloc() below hugebytes of capacity and, at or above it, an 
+   anonymous mapping aligned to ZLIST_HUGE_PAGE and madvise()'d 
+   MADV_HUGEPAGE.  Which one arr came from follows from cap, so the capacity 
+   in bytes is passed back in to free or grow it.  These are in 
+   zlistalign.c. */
+#define ZLIST_HUGE_PAGE ((size_t)2 << 20)
+void* _zlist_aligned_realloc(void* old, size_t oldcapbytes, size_t usedbytes, size_t newbytes, size_t align, size_t hugebytes);
+void _zlist_aligned_free(void* p, size_t capbytes, size_t hugebytes);
+
+#define DECLARE_ZLIST_ALIGNED(typ, nam) \
+typedef struct { \
+	size_t len; \
+	typ* arr; \
+	size_t cap; \
+} nam; \
+void nam##_resize(nam* l, size_t len); \
+void nam##_reserve(nam* l, size_t cap); \
+void nam##_shrink_to_fit(nam* l); \
+void nam##_append(nam* l, typ item); \
+void nam##_clear(nam* l); \
+void nam##_free(nam* l); \
+_DECLARE_ZLIST_BULK(typ, nam)
+
+#define DEFINE_ZLIST_ALIGNED(typ, nam, align, hugebytes) \
+void nam##_reserve(nam*const l, const size_t cap) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((l->arr != NULL) && (cap <= l->cap)) { return; } \
+	if (cap == 0) { return; } \
+	runtime_assert(cap <= Z_SIZE_T_MAX / sizeof(typ), "memory exhaustion"); \
+	_ZLIST_STATS_GROW(nam, (l->arr == NULL) ? 0 : sizeof(typ) * l->len); \
+	l->arr = (typ*)_zlist_aligned_realloc(l->arr, (l->arr == NULL) ? 0 : sizeof(typ) * l->cap, sizeof(typ) * l->len, sizeof(typ) * cap, (align), (hugebytes)); \
+	l->cap = cap; \
+} \
+ \
+void nam##_resize(nam*const l, const size_t len) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((len > l->cap) || ((l->arr == NULL) && (len > 0))) { \
+		nam##_reserve(l, _zlist_grow_cap((l->arr == NULL) ? 0 : l->cap, len, sizeof(typ))); \
+	} \
+	l->len = len; \
+	_ZLIST_STATS_LEN(nam, len); \
+} \
+ \
+void nam##_shrink_to_fit(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (l->arr == NULL) { l->len = 0; l->cap = 0; return; } \
+	if (l->len == 0) { nam##_free(l); return; } \
+	if (l->len == l->cap) { return; } \
+	_ZLIST_STATS_GROW(nam, sizeof(typ) * l->len); \
+	l->arr = (typ*)_zlist_aligned_realloc(l->arr, sizeof(typ) * l->cap, sizeof(typ) * l->len, sizeof(typ) * l->len, (align), (hugebytes)); \
+	l->cap = l->len; \
+} \
+ \
+void nam##_append(nam*const l, const typ item) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if ((l->len >= l->cap) || (l->arr == NULL)) { \
+		nam##_resize(l, l->len+1); \
+	} else { \
+		l->len++; \
+		_ZLIST_STATS_LEN(nam, l->len); \
+	} \
+	l->arr[l->len-1] = item; \
+} \
+ \
+void nam##_clear(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	l->len = 0; \
+} \
+ \
+void nam##_free(nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	if (l->arr != NULL) { \
+		_zlist_aligned_free(l->arr, sizeof(typ) * l->cap, (hugebytes)); \
+		l->arr = NULL; \
+	} \
+	l->len = 0; \
+	l->cap = 0; \
+} \
+ \
+_DEFINE_ZLIST_BULK(typ, nam)
+
+/* Serialization of lists of integers, with helpers in zlistserial.c.  The 
+   typedef fails to compile for an item size other than 1, 2, 4 or 8. */
+#define ZLIST_SERIAL_HEADER 32
+size_t _zlist_serial_size(size_t width, size_t len);
+void _zlist_serial_write(zbyte* buf, const void* arr, size_t len, size_t width);
+const zbyte* _zlist_serial_open(const zbyte* buf, size_t buflen, size_t width, bool verify, size_t* len, bool* swapped);
+void _zlist_serial_swap_copy(void* dst, const zbyte* src, size_t len, size_t width);
+
+#define DECLARE_ZLIST_SERIAL(typ, nam) \
+typedef struct { \
+	size_t len; \
+	const typ* arr; \
+} nam##_readonly; \
+size_t nam##_serialized_size(const nam* l); \
+void nam##_serialize(const nam* l, zbyte* buf); \
+bool nam##_deserialize(nam* l, const zbyte* buf, size_t len); \
+bool nam##_view(nam##_readonly* v, const zbyte* buf, size_t len, bool verify);
+
+#define DEFINE_ZLIST_SERIAL(typ, nam) \
+typedef char nam##_serial_width_check[((sizeof(typ) == 1) || (sizeof(typ) == 2) || (sizeof(typ) == 4) || (sizeof(typ) == 8)) ? 1 : -1]; \
+ \
+size_t nam##_serialized_size(const nam*const l) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	return _zlist_serial_size(sizeof(typ), l->len); \
+} \
+ \
+void nam##_serialize(const nam*const l, zbyte*const buf) { \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	_zlist_serial_write(buf, l->arr, l->len, sizeof(typ)); \
+} \
+ \
+bool nam##_deserialize(nam*const l, const zbyte*const buf, const size_t len) { \
+	const zbyte* p; \
+	size_t n; \
+	bool swapped; \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	p = _zlist_serial_open(buf, len, sizeof(typ), 1, &n, &swapped); \
+	if (p == NULL) { return false; } \
+	nam##_resize(l, n); \
+	if (n == 0) { return true; } \
+	if (swapped) { \
+		_zlist_serial_swap_copy(l->arr, p, n, sizeof(typ)); \
+	} else { \
+		memcpy(l->arr, p, sizeof(typ) * n); \
+	} \
+	return true; \
+} \
+ \
+bool nam##_view(nam##_readonly*const v, const zbyte*const buf, const size_t len, const bool verify) { \
+	const zbyte* p; \
+	size_t n; \
+	bool swapped; \
+	runtime_assert(v != NULL, "You are required to pass a non-NULL pointer."); \
+	p = _zlist_serial_open(buf, len, sizeof(typ), verify, &n, &swapped); \
+	if ((p == NULL) || swapped || (((size_t)p % sizeof(typ)) != 0)) { return false; } \
+	v->len = n; \
+	v->arr = (const typ*)(const void*)p; \
+	return true; \
+}
+
+#define DECLARE_ZLIST_SLICE(typ, nam) \
+typedef struct { \
+	size_t len; \
+	typ* arr; \
+} nam##_slice; \
+nam##_slice nam##_slice_of(const nam* l, size_t at, size_t n); \
+nam##_slice nam##_subslice(nam##_slice s, size_t at, size_t n); \
+void nam##_split_at(nam##_slice s, size_t at, nam##_slice* head, nam##_slice* tail); \
+bool nam##_split_next(nam##_slice* rest, typ sep, nam##_slice* field); \
+size_t nam##_chunk_count(nam##_slice s, size_t size); \
+nam##_slice nam##_chunk(nam##_slice s, size_t size, size_t i); \
+size_t nam##_window_count(nam##_slice s, size_t width); \
+nam##_slice nam##_window(nam##_slice s, size_t width, size_t i); \
+size_t nam##_slice_find(nam##_slice s, typ item); \
+bool nam##_slice_contains(nam##_slice s, typ item); \
+size_t nam##_slice_count(nam##_slice s, typ item); \
+bool nam##_slice_minmax(nam##_slice s, typ* min, typ* max); \
+void nam##_slice_sort(nam##_slice s);
+
+/* Slices never own memory, so nothing here allocates or frees.  The 
+   comparisons are bit-for-bit (zscan) and with "<", as for SCALAR_FIND, and 
+   slice_sort() is the list's own sort_range(). */
+#define DEFINE_ZLIST_SLICE(typ, nam) \
+nam##_slice nam##_slice_of(const nam*const l, const size_t at, const size_t n) { \
+	nam##_slice s; \
+	runtime_assert(l != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert((at <= l->len) && (n <= l->len - at), "Index out of range."); \
+	s.len = n; \
+	s.arr = (n == 0) ? NULL : (l->arr + at); \
+	return s; \
+} \
+ \
+nam##_slice nam##_subslice(nam##_slice s, const size_t at, const size_t n) { \
+	runtime_assert((at <= s.len) && (n <= s.len - at), "Index out of range."); \
+	s.len = n; \
+	s.arr = (n == 0) ? NULL : (s.arr + at); \
+	return s; \
+} \
+ \
+void nam##_split_at(const nam##_slice s, const size_t at, nam##_slice*const head, nam##_slice*const tail) { \
+	runtime_assert((head != NULL) && (tail != NULL), "You are required to pass non-NULL pointers."); \
+	*head = nam##_subslice(s, 0, at); \
+	*tail = nam##_subslice(s, at, s.len - at); \
+} \
+ \
+bool nam##_split_next(nam##_slice*const rest, const typ sep, nam##_slice*const field) { \
+	size_t i; \
+	runtime_assert((rest != NULL) && (field != NULL), "You are required to pass non-NULL pointers."); \
+	if (rest->len == 0) { return false; } \
+	i = zscan_find(rest->arr, rest->len, &sep, sizeof(typ)); \
+	field->len = i; \
+	field->arr = (i == 0) ? NULL : rest->arr; \
+	if (i + 1 >= rest->len) { \
+		rest->len = 0; \
+		rest->arr = NULL; \
+	} else { \
+		rest->arr += i + 1; \
+		rest->len -= i + 1; \
+	} \
+	return true; \
+} \
+ \
+size_t nam##_chunk_count(const nam##_slice s, const size_t size) { \
+	runtime_assert(size > 0, "The chunk size must be positive."); \
+	return s.len / size + ((s.len % size) != 0); \
+} \
+ \
+nam##_slice nam##_chunk(const nam##_slice s, const size_t size, const size_t i) { \
+	size_t at; \
+	runtime_assert(i < nam##_chunk_count(s, size), "Index out of range."); \
+	at = i * size; \
+	return nam##_subslice(s, at, (s.len - at < size) ? (s.len - at) : size); \
+} \
+ \
+size_t nam##_window_count(const nam##_slice s, const size_t width) { \
+	runtime_assert(width > 0, "The window width must be positive."); \
+	return (s.len < width) ? 0 : (s.len - width + 1); \
+} \
+ \
+nam##_slice nam##_window(const nam##_slice s, const size_t width, const size_t i) { \
+	runtime_assert(i < nam##_window_count(s, width), "Index out of range."); \
+	return nam##_subslice(s, i, width); \
+} \
+ \
+size_t nam##_slice_find(const nam##_slice s, const typ item) { \
+	return zscan_find(s.arr, s.len, &item, sizeof(typ)); \
+} \
+ \
+bool nam##_slice_contains(const nam##_slice s, const typ item) { \
+	return zscan_find(s.arr, s.len, &item, sizeof(typ)) < s.len; \
+} \
+ \
+size_t nam##_slice_count(const nam##_slice s, const typ item) { \
+	return zscan_count(s.arr, s.len, &item, sizeof(typ)); \
+} \
+ \
+bool nam##_slice_minmax(const nam##_slice s, typ*const min, typ*const max) { \
+	typ lo, hi; \
+	size_t i; \
+	runtime_assert((min != NULL) && (max != NULL), "You are required to pass non-NULL pointers."); \
+	if (s.len == 0) { return false; } \
+	lo = hi = s.arr[0]; \
+	for (i = 1; i < s.len; i++) { \
+		lo = (s.arr[i] < lo) ? s.arr[i] : lo; \
+		hi = (hi < s.arr[i]) ? s.arr[i] : hi; \
+	} \
+	*min = lo; \
+	*max = hi; \
+	return true; \
+} \
+ \
+void nam##_slice_sort(const nam##_slice s) { \
+	nam##_sort_range(s.arr, s.len); \
+}
+
 #endif /* #ifndef __INCL_zlistimp_h */
@@ -0,0 +1,145 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifdef __linux__
+#define _GNU_SOURCE /* for mremap() */
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "zlist.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+#define ZLIST_MMAP_MAGIC "zlistmm1"
+
+typedef struct {
+	char magic[8];
+	uint64_t width;
+	uint64_t len;
+} _zlist_mmap_header;
+
+static size_t _zlist_mmap_pagesize(void)
+{
+	static size_t pagesize = 0;
+	if (pagesize == 0) {
+		pagesize = (size_t)sysconf(_SC_PAGESIZE);
+	}
+	return pagesize;
+}
+
+void* _zlist_mmap_open(_zlist_mmap_file* const f, const char* const path, const bool readonly, const size_t width, size_t* const len)
+{
+	_zlist_mmap_header* h;
+	struct stat st;
+	f->base = NULL;
+	f->readonly = readonly;
+	f->fd = open(path, readonly ? O_RDONLY : (O_RDWR | O_CREAT), 0666);
+	if (f->fd < 0) {
+		return NULL;
+	}
+	if (fstat(f->fd, &st) != 0) {
+		goto fail;
+	}
+	if ((st.st_size == 0) && !readonly) {
+		/* a new file: write the header */
+		if (ftruncate(f->fd, ZLIST_MMAP_HEADER) != 0) {
+			goto fail;
+		}
+		st.st_size = ZLIST_MMAP_HEADER;
+	} else if (st.st_size < ZLIST_MMAP_HEADER) {
+		errno = EINVAL;
+		goto fail;
+	}
+	f->maplen = (size_t)st.st_size;
+	f->base = (unsigned char*)mmap(NULL, f->maplen, readonly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, f->fd, 0);
+	if (f->base == MAP_FAILED) {
+		f->base = NULL;
+		goto fail;
+	}
+	h = (_zlist_mmap_header*)f->base;
+	if (f->maplen == ZLIST_MMAP_HEADER && !readonly && h->magic[0] == '\0') {
+		memcpy(h->magic, ZLIST_MMAP_MAGIC, sizeof(h->magic));
+		h->width = width;
+		h->len = 0;
+	}
+	if ((memcmp(h->magic, ZLIST_MMAP_MAGIC, sizeof(h->magic)) != 0) || (h->width != width) || (h->len > (f->maplen - ZLIST_MMAP_HEADER) / width)) {
+		errno = EINVAL;
+		goto fail;
+	}
+	*len = (size_t)h->len;
+	return f->base + ZLIST_MMAP_HEADER;
+fail:
+	if (f->base != NULL) {
+		munmap(f->base, f->maplen);
+		f->base = NULL;
+	}
+	close(f->fd);
+	f->fd = -1;
+	return NULL;
+}
+
+void* _zlist_mmap_reserve(_zlist_mmap_file* const f, const size_t bytes)
+{
+	const size_t pagesize = _zlist_mmap_pagesize();
+	size_t newlen;
+	void* p;
+	runtime_assert(bytes <= Z_SIZE_T_MAX - ZLIST_MMAP_HEADER - pagesize, "memory exhaustion");
+	newlen = (ZLIST_MMAP_HEADER + bytes + pagesize - 1) / pagesize * pagesize;
+	if (newlen <= f->maplen) {
+		return f->base + ZLIST_MMAP_HEADER;
+	}
+	runtime_assert(ftruncate(f->fd, (off_t)newlen) == 0, "failed to grow the file backing a zlist");
+#ifdef MREMAP_MAYMOVE
+	p = mremap(f->base, f->maplen, newlen, MREMAP_MAYMOVE);
+#else
+	munmap(f->base, f->maplen);
+	p = mmap(NULL, newlen, PROT_READ | PROT_WRITE, MAP_SHARED, f->fd, 0);
+#endif
+	runtime_assert(p != MAP_FAILED, "memory exhaustion");
+	f->base = (unsigned char*)p;
+	f->maplen = newlen;
+	return f->base + ZLIST_MMAP_HEADER;
+}
+
+void _zlist_mmap_sync(_zlist_mmap_file* const f, const size_t len, const size_t width)
+{
+	/* The items have to be in the file before a header which counts them, 
+	   so sync them (with the old header) first, then the new header. */
+	runtime_assert(msync(f->base, ZLIST_MMAP_HEADER + len * width, MS_SYNC) == 0, "failed to sync the file backing a zlist");
+	((_zlist_mmap_header*)f->base)->len = len;
+	runtime_assert(msync(f->base, ZLIST_MMAP_HEADER, MS_SYNC) == 0, "failed to sync the file backing a zlist");
+}
+
+void _zlist_mmap_close(_zlist_mmap_file* const f, const size_t len, const size_t width)
+{
+	if (!f->readonly) {
+		_zlist_mmap_sync(f, len, width);
+	}
+	munmap(f->base, f->maplen);
+	if (!f->readonly) {
+		/* give back the unused capacity */
+		runtime_assert(ftruncate(f->fd, (off_t)(ZLIST_MMAP_HEADER + len * width)) == 0, "failed to trim the file backing a zlist");
+	}
+	close(f->fd);
+	f->base = NULL;
+	f->fd = -1;
+	f->maplen = 0;
+}
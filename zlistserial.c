@@ -0,0 +1,88 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#include <stdint.h>
+#include <string.h>
+
+#include "zlist.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+#define ZLIST_SERIAL_MAGIC 0x5a4c5331UL /* "ZLS1" */
+#define _ZLIST_SERIAL_LITTLE 1
+#define _ZLIST_SERIAL_BIG 2
+
+/* The header, all big-endian:
+     0  magic
+     4  byte order of the items (1 little, 2 big)
+     5  width of an item in bytes
+     6  two zero bytes
+     8  number of items, 64 bits
+    16  CRC-32C of the items
+    20  CRC-32C of bytes 0-19
+    24  eight zero bytes
+   The items follow at offset ZLIST_SERIAL_HEADER, in the byte order of the 
+   machine which wrote them. */
+
+static int _zlist_serial_native(void)
+{
+	const uint16_t one = 1;
+	return (*(const zbyte*)&one == 1) ? _ZLIST_SERIAL_LITTLE : _ZLIST_SERIAL_BIG;
+}
+
+size_t _zlist_serial_size(const size_t width, const size_t len)
+{
+	runtime_assert(len <= (Z_SIZE_T_MAX - ZLIST_SERIAL_HEADER) / width, "memory exhaustion");
+	return ZLIST_SERIAL_HEADER + width * len;
+}
+
+void _zlist_serial_write(zbyte* const buf, const void* const arr, const size_t len, const size_t width)
+{
+	runtime_assert(buf != NULL, "You are required to pass a non-NULL pointer.");
+	memset(buf, 0, ZLIST_SERIAL_HEADER);
+	uint32_encode(ZLIST_SERIAL_MAGIC, buf);
+	buf[4] = (zbyte)_zlist_serial_native();
+	buf[5] = (zbyte)width;
+	uint64_encode(len, buf + 8);
+	if (len > 0) {
+		memcpy(buf + ZLIST_SERIAL_HEADER, arr, width * len);
+	}
+	uint32_encode(zcrc32c(0, buf + ZLIST_SERIAL_HEADER, width * len), buf + 16);
+	uint32_encode(zcrc32c(0, buf, 20), buf + 20);
+}
+
+const zbyte* _zlist_serial_open(const zbyte* const buf, const size_t buflen, const size_t width, const bool verify, size_t* const len, bool* const swapped)
+{
+	unsigned long long n;
+	runtime_assert((buf != NULL) || (buflen == 0), "You are required to pass a non-NULL pointer.");
+	if ((buflen < ZLIST_SERIAL_HEADER) || (uint32_decode(buf) != ZLIST_SERIAL_MAGIC) || (uint32_decode(buf + 20) != zcrc32c(0, buf, 20))) { return NULL; }
+	if (((buf[4] != _ZLIST_SERIAL_LITTLE) && (buf[4] != _ZLIST_SERIAL_BIG)) || (buf[5] != width)) { return NULL; }
+	n = uint64_decode(buf + 8);
+	if (n > (buflen - ZLIST_SERIAL_HEADER) / width) { return NULL; }
+	if (verify && (uint32_decode(buf + 16) != zcrc32c(0, buf + ZLIST_SERIAL_HEADER, width * (size_t)n))) { return NULL; }
+	*len = (size_t)n;
+	*swapped = (buf[4] != _zlist_serial_native());
+	return buf + ZLIST_SERIAL_HEADER;
+}
+
+void _zlist_serial_swap_copy(void* const dst, const zbyte* const src, const size_t len, const size_t width)
+{
+	zbyte* const d = (zbyte*)dst;
+	size_t i, k;
+	for (i = 0; i < len; i++) {
+		for (k = 0; k < width; k++) {
+			d[i * width + k] = src[i * width + width - 1 - k];
+		}
+	}
+}
@@ -0,0 +1,70 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zpipe_h
+#define __INCL_zpipe_h
+
+#include "zutil.h"
+
+#include "zpipeimp.h" /* implementation stuff that you needn't look at in order to use this */
+
+/**
+ * Fused pipelines over zlists: filter, map and take stages which run one 
+ * item at a time in a single loop, with no intermediate lists, and append 
+ * the survivors to a zlist which is grown once, to the most it could need, 
+ * before the first of them is stored.  Compare building a new zlist per 
+ * step, which makes a pass over memory and a run of reallocs per step.
+ *
+ * For example, the squares of the first 10 even items of the zlisti src, 
+ * appended to the zlistll dst:
+ *
+ * ZPIPE_BEGIN(int, x, &src)
+ * 	ZPIPE_FILTER(x % 2 == 0)
+ * 	ZPIPE_MAP(long long, sq, (long long)x * x)
+ * 	ZPIPE_TAKE(10)
+ * 	ZPIPE_INTO(zlistll, &dst, sq)
+ * ZPIPE_END
+ *
+ * The stages are macros which expand to plain statements in the body of the 
+ * loop, so the compiler sees the whole pipeline at once and inlines all of 
+ * it; there are no calls through function pointers.  Between ZPIPE_BEGIN and 
+ * ZPIPE_END you may also write ordinary statements, which see every item that 
+ * got that far.
+ *
+ * ZPIPE_BEGIN(typ, x, l):
+ *     Loop over the items of l, a pointer to any kind of zlist (or anything 
+ *     else with "len" and "arr" fields) of typ, calling each one x.  l is 
+ *     evaluated once; it must not change during the loop.
+ *
+ * ZPIPE_FILTER(cond):
+ *     Drop the item unless cond is true.
+ *
+ * ZPIPE_MAP(typ, y, expr):
+ *     Compute y = expr, of type typ, for use by the stages after this one.
+ *
+ * ZPIPE_TAKE(n):
+ *     Let only the first n items which get this far through, and then stop 
+ *     the loop.  A pipeline may have only one ZPIPE_TAKE.
+ *
+ * ZPIPE_INTO(nam, dst, expr):
+ *     Append expr to dst, a pointer to a zlist of type nam.  The first time 
+ *     dst is full, it is reserved room for as many items as could still 
+ *     reach it -- the rest of l, or fewer if there is a ZPIPE_TAKE.
+ *
+ * ZPIPE_END:
+ *     End the loop.
+ *
+ * Pipelines can't be nested.
+ */
+
+#endif /* #ifndef __INCL_zpipe_h */
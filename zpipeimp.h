@@ -0,0 +1,61 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zpipeimp_h
+#define __INCL_zpipeimp_h
+
+#include "morelimits.h"
+
+#define ZPIPE_BEGIN(typ, x, l) \
+do { \
+	const typ* const _zpipe_arr = (l)->arr; \
+	const size_t _zpipe_len = (l)->len; \
+	size_t _zpipe_i; \
+	size_t _zpipe_taken = 0; \
+	size_t _zpipe_limit = Z_SIZE_T_MAX; \
+	bool _zpipe_stop = 0; \
+	(void)_zpipe_taken; \
+	(void)_zpipe_limit; \
+	for (_zpipe_i = 0; (_zpipe_i < _zpipe_len) && !_zpipe_stop; _zpipe_i++) { \
+		const typ x = _zpipe_arr[_zpipe_i];
+
+#define ZPIPE_FILTER(cond) \
+		if (!(cond)) { continue; }
+
+#define ZPIPE_MAP(typ, y, expr) \
+		const typ y = (expr);
+
+/* The loop stops before the next item rather than here, so that the stages 
+   after this one still see the n'th. */
+#define ZPIPE_TAKE(n) \
+		_zpipe_limit = (size_t)(n); \
+		if (_zpipe_taken >= _zpipe_limit) { break; } \
+		_zpipe_stop = (++_zpipe_taken == _zpipe_limit);
+
+/* At most _zpipe_len - _zpipe_i more items can arrive, counting this one, 
+   and at most _zpipe_limit - _zpipe_taken + 1 of them can get past a TAKE. */
+#define ZPIPE_INTO(nam, dst, expr) \
+		if ((dst)->len == (dst)->cap) { \
+			size_t _zpipe_more = _zpipe_len - _zpipe_i; \
+			if (_zpipe_limit - _zpipe_taken < _zpipe_more) { \
+				_zpipe_more = _zpipe_limit - _zpipe_taken + 1; \
+			} \
+			nam##_reserve((dst), (dst)->len + _zpipe_more); \
+		} \
+		(dst)->arr[(dst)->len++] = (expr);
+
+#define ZPIPE_END \
+	} \
+} while (0);
+
+#endif /* #ifndef __INCL_zpipeimp_h */
@@ -0,0 +1,40 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#include "zqueue.h"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sched.h>
+#endif
+
+void _zqueue_wait(atomic_uint* const word, const unsigned expected)
+{
+#ifdef __linux__
+	syscall(SYS_futex, (unsigned*)word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+	if (atomic_load(word) == expected) {
+		sched_yield();
+	}
+#endif
+}
+
+void _zqueue_wake(atomic_uint* const word)
+{
+	atomic_fetch_add_explicit(word, 1, memory_order_release);
+#ifdef __linux__
+	syscall(SYS_futex, (unsigned*)word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#endif
+}
@@ -0,0 +1,65 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#ifndef __INCL_zqueue_h
+#define __INCL_zqueue_h
+
+#include "zutil.h"
+
+#include "zqueueimp.h" /* implementation stuff that you needn't look at in order to use this */
+
+/**
+ * A bounded lock-free queue for any number of producer threads and any 
+ * number of consumer threads (for exactly one of each, zring.h is faster).  
+ * It needs C11 atomics.
+ *
+ * This is Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence 
+ * number which tells a producer or consumer, which has claimed a position 
+ * with a compare-and-swap on the shared enqueue or dequeue counter, whether 
+ * the cell is ready for it.  Producers and consumers only contend on their 
+ * own counter, and never wait for each other unless the queue is full or 
+ * empty.
+ *
+ * The blocking push() and pop() sleep in the kernel (with a futex on Linux; 
+ * elsewhere they just yield the CPU in a loop) rather than spinning when the 
+ * queue is full or empty.  Every successful push or pop checks whether anyone 
+ * is asleep on the other side and wakes one of them if so.
+ *
+ * DECLARE_ZQUEUE(typ, nam) declares the type nam and the following functions, 
+ * and DEFINE_ZQUEUE(typ, nam) defines them:
+ *
+ * void nam_init(nam* q, size_t cap):
+ *     Make q an empty queue which can hold cap items.  cap is rounded up to a 
+ *     power of two, and is at least 2.
+ *
+ * void nam_free(nam* q):
+ *     Free the queue's memory.  No thread may be using it anymore.
+ *
+ * bool nam_try_push(nam* q, typ item):
+ *     Add item and return true, or return false if the queue is full.
+ *
+ * bool nam_try_pop(nam* q, typ* item):
+ *     Remove the oldest item, store it in *item and return true, or return 
+ *     false if the queue is empty.
+ *
+ * void nam_push(nam* q, typ item):
+ *     Add item, sleeping until there is room if the queue is full.
+ *
+ * void nam_pop(nam* q, typ* item):
+ *     Remove the oldest item into *item, sleeping until there is one if the 
+ *     queue is empty.
+ *
+ * Like zring, the struct is aligned to ZQUEUE_CACHELINE bytes, so malloc() it 
+ * only with an allocator which honors that.
+ */
+
+#endif /* #ifndef __INCL_zqueue_h */
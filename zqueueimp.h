@@ -0,0 +1,179 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#ifndef __INCL_zqueueimp_h
+#define __INCL_zqueueimp_h
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+#define ZQUEUE_CACHELINE 64
+
+/* Sleep until someone calls _zqueue_wake(word), unless *word != expected 
+   already.  May also return spuriously. */
+void _zqueue_wait(atomic_uint* word, unsigned expected);
+/* Bump *word and wake one thread sleeping on it. */
+void _zqueue_wake(atomic_uint* word);
+
+/* A thread going to sleep on a full (empty) queue first reads the event 
+   counter popped (pushed), then announces itself in push_waiters 
+   (pop_waiters), then tries once more before sleeping.  A thread which 
+   pushes (pops) looks at pop_waiters (push_waiters) after its operation and, 
+   if anyone is waiting, bumps the counter and wakes one.  The seq_cst fences 
+   make sure that either the waker sees the waiter or the waiter's last try 
+   sees the waker's item (room). */
+#define DECLARE_ZQUEUE(typ, nam) \
+typedef struct { \
+	atomic_size_t seq; \
+	typ val; \
+} nam##_cell; \
+typedef struct { \
+	_Alignas(ZQUEUE_CACHELINE) atomic_size_t enq; \
+	_Alignas(ZQUEUE_CACHELINE) atomic_size_t deq; \
+	_Alignas(ZQUEUE_CACHELINE) atomic_uint pushed; \
+	atomic_uint pop_waiters; \
+	_Alignas(ZQUEUE_CACHELINE) atomic_uint popped; \
+	atomic_uint push_waiters; \
+	_Alignas(ZQUEUE_CACHELINE) size_t mask; \
+	nam##_cell* cells; \
+} nam; \
+void nam##_init(nam* q, size_t cap); \
+void nam##_free(nam* q); \
+bool nam##_try_push(nam* q, typ item); \
+bool nam##_try_pop(nam* q, typ* item); \
+void nam##_push(nam* q, typ item); \
+void nam##_pop(nam* q, typ* item);
+
+#define DEFINE_ZQUEUE(typ, nam) \
+void nam##_init(nam*const q, const size_t cap) { \
+	const size_t c = pow2ceil((cap < 2) ? 2 : cap); \
+	size_t i; \
+	runtime_assert(q != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(c <= Z_SIZE_T_MAX / sizeof(nam##_cell), "memory exhaustion"); \
+	q->cells = (nam##_cell*)malloc(sizeof(nam##_cell) * c); \
+	runtime_assert(q->cells != NULL, "memory exhaustion"); \
+	for (i = 0; i < c; i++) { \
+		atomic_init(&q->cells[i].seq, i); \
+	} \
+	q->mask = c - 1; \
+	atomic_init(&q->enq, 0); \
+	atomic_init(&q->deq, 0); \
+	atomic_init(&q->pushed, 0); \
+	atomic_init(&q->pop_waiters, 0); \
+	atomic_init(&q->popped, 0); \
+	atomic_init(&q->push_waiters, 0); \
+} \
+ \
+void nam##_free(nam*const q) { \
+	runtime_assert(q != NULL, "You are required to pass a non-NULL pointer."); \
+	if (q->cells != NULL) { free(q->cells); q->cells = NULL; } \
+} \
+ \
+static bool _##nam##_push_nowake(nam*const q, const typ item) { \
+	nam##_cell* cell; \
+	size_t pos = atomic_load_explicit(&q->enq, memory_order_relaxed); \
+	size_t seq; \
+	for (;;) { \
+		cell = &q->cells[pos & q->mask]; \
+		seq = atomic_load_explicit(&cell->seq, memory_order_acquire); \
+		if (seq == pos) { \
+			if (atomic_compare_exchange_weak_explicit(&q->enq, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) { \
+				break; \
+			} \
+		} else if ((ptrdiff_t)(seq - pos) < 0) { \
+			return false; \
+		} else { \
+			pos = atomic_load_explicit(&q->enq, memory_order_relaxed); \
+		} \
+	} \
+	cell->val = item; \
+	atomic_store_explicit(&cell->seq, pos + 1, memory_order_release); \
+	return true; \
+} \
+ \
+static bool _##nam##_pop_nowake(nam*const q, typ*const item) { \
+	nam##_cell* cell; \
+	size_t pos = atomic_load_explicit(&q->deq, memory_order_relaxed); \
+	size_t seq; \
+	for (;;) { \
+		cell = &q->cells[pos & q->mask]; \
+		seq = atomic_load_explicit(&cell->seq, memory_order_acquire); \
+		if (seq == pos + 1) { \
+			if (atomic_compare_exchange_weak_explicit(&q->deq, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) { \
+				break; \
+			} \
+		} else if ((ptrdiff_t)(seq - (pos + 1)) < 0) { \
+			return false; \
+		} else { \
+			pos = atomic_load_explicit(&q->deq, memory_order_relaxed); \
+		} \
+	} \
+	*item = cell->val; \
+	atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release); \
+	return true; \
+} \
+ \
+bool nam##_try_push(nam*const q, const typ item) { \
+	if (!_##nam##_push_nowake(q, item)) { return false; } \
+	atomic_thread_fence(memory_order_seq_cst); \
+	if (atomic_load_explicit(&q->pop_waiters, memory_order_relaxed) != 0) { \
+		_zqueue_wake(&q->pushed); \
+	} \
+	return true; \
+} \
+ \
+bool nam##_try_pop(nam*const q, typ*const item) { \
+	if (!_##nam##_pop_nowake(q, item)) { return false; } \
+	atomic_thread_fence(memory_order_seq_cst); \
+	if (atomic_load_explicit(&q->push_waiters, memory_order_relaxed) != 0) { \
+		_zqueue_wake(&q->popped); \
+	} \
+	return true; \
+} \
+ \
+void nam##_push(nam*const q, const typ item) { \
+	unsigned ev; \
+	bool done; \
+	while (!nam##_try_push(q, item)) { \
+		ev = atomic_load_explicit(&q->popped, memory_order_acquire); \
+		atomic_fetch_add_explicit(&q->push_waiters, 1, memory_order_relaxed); \
+		atomic_thread_fence(memory_order_seq_cst); \
+		done = nam##_try_push(q, item); \
+		if (!done) { \
+			_zqueue_wait(&q->popped, ev); \
+		} \
+		atomic_fetch_sub_explicit(&q->push_waiters, 1, memory_order_relaxed); \
+		if (done) { return; } \
+	} \
+} \
+ \
+void nam##_pop(nam*const q, typ*const item) { \
+	unsigned ev; \
+	bool done; \
+	while (!nam##_try_pop(q, item)) { \
+		ev = atomic_load_explicit(&q->pushed, memory_order_acquire); \
+		atomic_fetch_add_explicit(&q->pop_waiters, 1, memory_order_relaxed); \
+		atomic_thread_fence(memory_order_seq_cst); \
+		done = nam##_try_pop(q, item); \
+		if (!done) { \
+			_zqueue_wait(&q->pushed, ev); \
+		} \
+		atomic_fetch_sub_explicit(&q->pop_waiters, 1, memory_order_relaxed); \
+		if (done) { return; } \
+	} \
+}
+
+#endif /* #ifndef __INCL_zqueueimp_h */
@@ -0,0 +1,67 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#ifndef __INCL_zring_h
+#define __INCL_zring_h
+
+#include "zutil.h"
+
+#include "zringimp.h" /* implementation stuff that you needn't look at in order to use this */
+
+/**
+ * A bounded lock-free ring buffer for passing items from exactly one producer 
+ * thread to exactly one consumer thread.  It needs C11 atomics.
+ *
+ * The consumer's index and the producer's index live on separate cache lines, 
+ * so the two threads don't fight over a cache line on every operation.  Each 
+ * side also keeps a private cached copy of the other side's index and only 
+ * re-reads the real one when the cached copy says the ring is full (for the 
+ * producer) or empty (for the consumer).
+ *
+ * DECLARE_ZRING(typ, nam) declares the type nam and the following functions, 
+ * and DEFINE_ZRING(typ, nam) defines them:
+ *
+ * void nam_init(nam* r, size_t cap):
+ *     Make r an empty ring which can hold cap items.  cap is rounded up to a 
+ *     power of two.
+ *
+ * void nam_free(nam* r):
+ *     Free the ring's memory.  Neither thread may be using it anymore.
+ *
+ * bool nam_try_push(nam* r, typ item):
+ *     (producer only) Add item and return true, or return false if the ring 
+ *     is full.
+ *
+ * bool nam_try_pop(nam* r, typ* item):
+ *     (consumer only) Remove the oldest item, store it in *item and return 
+ *     true, or return false if the ring is empty.
+ *
+ * size_t nam_push_n(nam* r, const typ* items, size_t n):
+ *     (producer only) Add as many as possible of the n items starting at 
+ *     items, in order, and return how many were added.  This publishes them 
+ *     all to the consumer with a single atomic store.
+ *
+ * size_t nam_pop_n(nam* r, typ* items, size_t n):
+ *     (consumer only) Remove up to n items into the array items and return 
+ *     how many were removed.
+ *
+ * size_t nam_size(nam* r):
+ *     Returns the number of items in the ring.  If the other thread is busy 
+ *     this is only a snapshot.
+ *
+ * The struct is aligned to ZRING_CACHELINE bytes.  That alignment is honored 
+ * for rings which are global or local variables; if you malloc() one, use an 
+ * allocator which honors it (such as aligned_alloc()) or you'll lose some of 
+ * the benefit of the padding.
+ */
+
+#endif /* #ifndef __INCL_zring_h */
@@ -0,0 +1,133 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#ifndef __INCL_zringimp_h
+#define __INCL_zringimp_h
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+#define ZRING_CACHELINE 64
+
+/* head and tail count every item ever popped and pushed; they are reduced 
+   modulo the capacity (with mask) only when indexing into buf. */
+#define DECLARE_ZRING(typ, nam) \
+typedef struct { \
+	_Alignas(ZRING_CACHELINE) atomic_size_t head; /* written by the consumer */ \
+	size_t tail_cache; /* the consumer's copy of tail */ \
+	_Alignas(ZRING_CACHELINE) atomic_size_t tail; /* written by the producer */ \
+	size_t head_cache; /* the producer's copy of head */ \
+	_Alignas(ZRING_CACHELINE) size_t mask; \
+	typ* buf; \
+} nam; \
+void nam##_init(nam* r, size_t cap); \
+void nam##_free(nam* r); \
+bool nam##_try_push(nam* r, typ item); \
+bool nam##_try_pop(nam* r, typ* item); \
+size_t nam##_push_n(nam* r, const typ* items, size_t n); \
+size_t nam##_pop_n(nam* r, typ* items, size_t n); \
+size_t nam##_size(nam* r);
+
+#define DEFINE_ZRING(typ, nam) \
+void nam##_init(nam*const r, const size_t cap) { \
+	const size_t c = pow2ceil(cap); \
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer."); \
+	runtime_assert(c <= Z_SIZE_T_MAX / sizeof(typ), "memory exhaustion"); \
+	r->buf = (typ*)malloc(sizeof(typ) * c); \
+	runtime_assert(r->buf != NULL, "memory exhaustion"); \
+	r->mask = c - 1; \
+	atomic_init(&r->head, 0); \
+	atomic_init(&r->tail, 0); \
+	r->tail_cache = 0; \
+	r->head_cache = 0; \
+} \
+ \
+void nam##_free(nam*const r) { \
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer."); \
+	if (r->buf != NULL) { free(r->buf); r->buf = NULL; } \
+} \
+ \
+bool nam##_try_push(nam*const r, const typ item) { \
+	const size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed); \
+	if (tail - r->head_cache > r->mask) { \
+		r->head_cache = atomic_load_explicit(&r->head, memory_order_acquire); \
+		if (tail - r->head_cache > r->mask) { \
+			return false; \
+		} \
+	} \
+	r->buf[tail & r->mask] = item; \
+	atomic_store_explicit(&r->tail, tail + 1, memory_order_release); \
+	return true; \
+} \
+ \
+bool nam##_try_pop(nam*const r, typ*const item) { \
+	const size_t head = atomic_load_explicit(&r->head, memory_order_relaxed); \
+	if (head == r->tail_cache) { \
+		r->tail_cache = atomic_load_explicit(&r->tail, memory_order_acquire); \
+		if (head == r->tail_cache) { \
+			return false; \
+		} \
+	} \
+	*item = r->buf[head & r->mask]; \
+	atomic_store_explicit(&r->head, head + 1, memory_order_release); \
+	return true; \
+} \
+ \
+size_t nam##_push_n(nam*const r, const typ*const items, size_t n) { \
+	const size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed); \
+	const size_t cap = r->mask + 1; \
+	size_t room = cap - (tail - r->head_cache); \
+	size_t at, first; \
+	if (room < n) { \
+		r->head_cache = atomic_load_explicit(&r->head, memory_order_acquire); \
+		room = cap - (tail - r->head_cache); \
+	} \
+	if (n > room) { n = room; } \
+	if (n == 0) { return 0; } \
+	at = tail & r->mask; \
+	first = (cap - at < n) ? (cap - at) : n; \
+	memcpy(r->buf + at, items, sizeof(typ) * first); \
+	memcpy(r->buf, items + first, sizeof(typ) * (n - first)); \
+	atomic_store_explicit(&r->tail, tail + n, memory_order_release); \
+	return n; \
+} \
+ \
+size_t nam##_pop_n(nam*const r, typ*const items, size_t n) { \
+	const size_t head = atomic_load_explicit(&r->head, memory_order_relaxed); \
+	const size_t cap = r->mask + 1; \
+	size_t avail = r->tail_cache - head; \
+	size_t at, first; \
+	if (avail < n) { \
+		r->tail_cache = atomic_load_explicit(&r->tail, memory_order_acquire); \
+		avail = r->tail_cache - head; \
+	} \
+	if (n > avail) { n = avail; } \
+	if (n == 0) { return 0; } \
+	at = head & r->mask; \
+	first = (cap - at < n) ? (cap - at) : n; \
+	memcpy(items, r->buf + at, sizeof(typ) * first); \
+	memcpy(items + first, r->buf, sizeof(typ) * (n - first)); \
+	atomic_store_explicit(&r->head, head + n, memory_order_release); \
+	return n; \
+} \
+ \
+size_t nam##_size(nam*const r) { \
+	const size_t head = atomic_load_explicit(&r->head, memory_order_acquire); \
+	const size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire); \
+	return tail - head; \
+}
+
+#endif /* #ifndef __INCL_zringimp_h */
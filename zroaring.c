@@ -0,0 +1,1009 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zroaring.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+#include "zlist.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define ZROARING_MAGIC 0x5a524231UL /* "ZRB1" */
+#define _ZROARING_HEADER 8
+#define _ZROARING_DIRENT 16
+
+enum { _ZROARING_AND, _ZROARING_OR, _ZROARING_ANDNOT, _ZROARING_XOR };
+
+static uint32_t _zroaring_popcount(uint64_t w)
+{
+#ifdef __GNUC__
+	return (uint32_t)__builtin_popcountll(w);
+#else
+	w = w - ((w >> 1) & 0x5555555555555555ULL);
+	w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+	w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (uint32_t)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* w must not be 0 */
+static uint32_t _zroaring_ctz(uint64_t w)
+{
+#ifdef __GNUC__
+	return (uint32_t)__builtin_ctzll(w);
+#else
+	uint32_t n = 0;
+	while ((w & 1) == 0) { w >>= 1; n++; }
+	return n;
+#endif
+}
+
+#define _ZROARING_VALUES(c) ((uint16_t*)(c)->data)
+#define _ZROARING_WORDS(c) ((uint64_t*)(c)->data)
+#define _ZROARING_RUNS(c) ((uint16_t*)(c)->data) /* start, length-1, start, length-1, ... */
+
+static void* _zroaring_xmalloc(const size_t size)
+{
+	void* const p = malloc((size == 0) ? 1 : size);
+	runtime_assert(p != NULL, "memory exhaustion");
+	return p;
+}
+
+static bool _zroaring_little_endian(void)
+{
+	const uint16_t one = 1;
+	return *(const zbyte*)&one == 1;
+}
+
+/*** containers ***/
+
+static void _zroaring_c_free(zroaring_container* const c)
+{
+	if (c->owned && (c->data != NULL)) {
+		free(c->data);
+	}
+	c->data = NULL;
+}
+
+/* Returns the index of the first of the n values at a which is >= v. */
+static uint32_t _zroaring_lower16(const uint16_t* const a, const uint32_t n, const uint16_t v)
+{
+	uint32_t lo = 0, hi = n, mid;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (a[mid] < v) { lo = mid + 1; } else { hi = mid; }
+	}
+	return lo;
+}
+
+/* Returns 1 + the index of the last run which starts at or before v, or 0. */
+static uint32_t _zroaring_run_upper(const uint16_t* const runs, const uint32_t n, const uint16_t v)
+{
+	uint32_t lo = 0, hi = n, mid;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (runs[2 * mid] <= v) { lo = mid + 1; } else { hi = mid; }
+	}
+	return lo;
+}
+
+static bool _zroaring_c_contains(const zroaring_container* const c, const uint16_t v)
+{
+	uint32_t i;
+	switch (c->type) {
+	case ZROARING_ARRAY:
+		i = _zroaring_lower16(_ZROARING_VALUES(c), c->n, v);
+		return (i < c->n) && (_ZROARING_VALUES(c)[i] == v);
+	case ZROARING_BITMAP:
+		return (_ZROARING_WORDS(c)[v >> 6] >> (v & 63)) & 1;
+	default:
+		i = _zroaring_run_upper(_ZROARING_RUNS(c), c->n, v);
+		return (i > 0) && ((uint32_t)(v - _ZROARING_RUNS(c)[2 * (i - 1)]) <= _ZROARING_RUNS(c)[2 * (i - 1) + 1]);
+	}
+}
+
+/* Set bits lo up to but not including hi. */
+static void _zroaring_set_range(uint64_t* const w, const uint32_t lo, uint32_t hi)
+{
+	uint32_t fw, lw, i;
+	uint64_t first, last;
+	if (hi > 65536) { hi = 65536; }
+	if (lo >= hi) { return; }
+	fw = lo >> 6;
+	lw = (hi - 1) >> 6;
+	first = ~0ULL << (lo & 63);
+	last = ~0ULL >> (63 - ((hi - 1) & 63));
+	if (fw == lw) {
+		w[fw] |= first & last;
+	} else {
+		w[fw] |= first;
+		for (i = fw + 1; i < lw; i++) {
+			w[i] = ~0ULL;
+		}
+		w[lw] |= last;
+	}
+}
+
+/* Write the members of c as ZROARING_WORDS words of bits. */
+static void _zroaring_c_fill_words(const zroaring_container* const c, uint64_t* const w)
+{
+	const uint16_t* a;
+	uint32_t i;
+	switch (c->type) {
+	case ZROARING_BITMAP:
+		memcpy(w, c->data, sizeof(uint64_t) * ZROARING_WORDS);
+		return;
+	case ZROARING_ARRAY:
+		memset(w, 0, sizeof(uint64_t) * ZROARING_WORDS);
+		a = _ZROARING_VALUES(c);
+		for (i = 0; i < c->n; i++) {
+			w[a[i] >> 6] |= 1ULL << (a[i] & 63);
+		}
+		return;
+	default:
+		memset(w, 0, sizeof(uint64_t) * ZROARING_WORDS);
+		a = _ZROARING_RUNS(c);
+		for (i = 0; i < c->n; i++) {
+			_zroaring_set_range(w, a[2 * i], (uint32_t)a[2 * i] + a[2 * i + 1] + 1);
+		}
+		return;
+	}
+}
+
+static uint32_t _zroaring_words_to_values(const uint64_t* const w, uint16_t* const out)
+{
+	uint32_t i, n = 0;
+	uint64_t x;
+	for (i = 0; i < ZROARING_WORDS; i++) {
+		for (x = w[i]; x != 0; x &= x - 1) {
+			out[n++] = (uint16_t)(i * 64 + _zroaring_ctz(x));
+		}
+	}
+	return n;
+}
+
+/* Make c hold the card members in the bits words (a malloc()'d array of 
+   ZROARING_WORDS words, which c takes over), as an array if they fit. */
+static void _zroaring_c_from_words(zroaring_container* const c, uint64_t* const words, const uint32_t card)
+{
+	c->owned = 1;
+	c->card = card;
+	if (card <= ZROARING_ARRAY_MAX) {
+		c->type = ZROARING_ARRAY;
+		c->data = _zroaring_xmalloc(sizeof(uint16_t) * card);
+		c->n = _zroaring_words_to_values(words, (uint16_t*)c->data);
+		c->cap = card;
+		free(words);
+	} else {
+		c->type = ZROARING_BITMAP;
+		c->data = words;
+		c->n = ZROARING_WORDS;
+		c->cap = ZROARING_WORDS;
+	}
+}
+
+/* Turn a run container into an array or bitmap, which can be changed. */
+static void _zroaring_c_unrun(zroaring_container* const c)
+{
+	uint64_t* words;
+	if (c->type != ZROARING_RUN) { return; }
+	words = (uint64_t*)_zroaring_xmalloc(sizeof(uint64_t) * ZROARING_WORDS);
+	_zroaring_c_fill_words(c, words);
+	_zroaring_c_free(c);
+	_zroaring_c_from_words(c, words, c->card);
+}
+
+static bool _zroaring_c_add(zroaring_container* const c, const uint16_t v)
+{
+	uint64_t* words;
+	uint16_t* a;
+	uint32_t i;
+	if (_zroaring_c_contains(c, v)) { return false; }
+	_zroaring_c_unrun(c);
+	if (c->type == ZROARING_BITMAP) {
+		_ZROARING_WORDS(c)[v >> 6] |= 1ULL << (v & 63);
+		c->card++;
+	} else if (c->n < ZROARING_ARRAY_MAX) {
+		if (c->n == c->cap) {
+			c->cap = (c->cap < 4) ? 4 : (c->cap * 2 > ZROARING_ARRAY_MAX) ? ZROARING_ARRAY_MAX : c->cap * 2;
+			c->data = realloc(c->data, sizeof(uint16_t) * c->cap);
+			runtime_assert(c->data != NULL, "memory exhaustion");
+		}
+		a = _ZROARING_VALUES(c);
+		i = _zroaring_lower16(a, c->n, v);
+		memmove(a + i + 1, a + i, sizeof(uint16_t) * (c->n - i));
+		a[i] = v;
+		c->n++;
+		c->card++;
+	} else {
+		words = (uint64_t*)_zroaring_xmalloc(sizeof(uint64_t) * ZROARING_WORDS);
+		_zroaring_c_fill_words(c, words);
+		words[v >> 6] |= 1ULL << (v & 63);
+		_zroaring_c_free(c);
+		_zroaring_c_from_words(c, words, c->card + 1);
+	}
+	return true;
+}
+
+static bool _zroaring_c_remove(zroaring_container* const c, const uint16_t v)
+{
+	uint64_t* words;
+	uint16_t* a;
+	uint32_t i;
+	if (!_zroaring_c_contains(c, v)) { return false; }
+	_zroaring_c_unrun(c);
+	if (c->type == ZROARING_ARRAY) {
+		a = _ZROARING_VALUES(c);
+		i = _zroaring_lower16(a, c->n, v);
+		memmove(a + i, a + i + 1, sizeof(uint16_t) * (c->n - i - 1));
+		c->n--;
+		c->card--;
+	} else {
+		words = _ZROARING_WORDS(c);
+		words[v >> 6] &= ~(1ULL << (v & 63));
+		c->card--;
+		if (c->card <= ZROARING_ARRAY_MAX) {
+			c->data = NULL;
+			_zroaring_c_from_words(c, words, c->card);
+		}
+	}
+	return true;
+}
+
+/* Returns the number of members of c which are <= v. */
+static uint32_t _zroaring_c_rank(const zroaring_container* const c, const uint16_t v)
+{
+	const uint16_t* a;
+	const uint64_t* w;
+	uint32_t i, r = 0, end;
+	switch (c->type) {
+	case ZROARING_ARRAY:
+		a = _ZROARING_VALUES(c);
+		i = _zroaring_lower16(a, c->n, v);
+		return i + ((i < c->n) && (a[i] == v));
+	case ZROARING_BITMAP:
+		w = _ZROARING_WORDS(c);
+		for (i = 0; i < (uint32_t)(v >> 6); i++) {
+			r += _zroaring_popcount(w[i]);
+		}
+		return r + _zroaring_popcount(w[v >> 6] & (~0ULL >> (63 - (v & 63))));
+	default:
+		a = _ZROARING_RUNS(c);
+		for (i = 0; (i < c->n) && (a[2 * i] <= v); i++) {
+			end = (uint32_t)a[2 * i] + a[2 * i + 1];
+			r += ((end < v) ? end : v) - a[2 * i] + 1;
+		}
+		return r;
+	}
+}
+
+/* Returns the i'th smallest member of c; i must be < c->card. */
+static uint16_t _zroaring_c_select(const zroaring_container* const c, uint32_t i)
+{
+	const uint16_t* a;
+	const uint64_t* w;
+	uint32_t k, pc;
+	uint64_t x;
+	switch (c->type) {
+	case ZROARING_ARRAY:
+		return (i < c->n) ? _ZROARING_VALUES(c)[i] : 0;
+	case ZROARING_BITMAP:
+		w = _ZROARING_WORDS(c);
+		for (k = 0; k < ZROARING_WORDS; k++) {
+			pc = _zroaring_popcount(w[k]);
+			if (i < pc) {
+				for (x = w[k]; i > 0; i--) {
+					x &= x - 1;
+				}
+				return (uint16_t)(k * 64 + _zroaring_ctz(x));
+			}
+			i -= pc;
+		}
+		return 0;
+	default:
+		a = _ZROARING_RUNS(c);
+		for (k = 0; k < c->n; k++) {
+			if (i <= a[2 * k + 1]) {
+				return (uint16_t)(a[2 * k] + i);
+			}
+			i -= (uint32_t)a[2 * k + 1] + 1;
+		}
+		return 0;
+	}
+}
+
+static uint32_t _zroaring_c_count_runs(const zroaring_container* const c)
+{
+	const uint16_t* a;
+	const uint64_t* w;
+	uint32_t i, runs = 0;
+	uint64_t carry = 0;
+	switch (c->type) {
+	case ZROARING_ARRAY:
+		a = _ZROARING_VALUES(c);
+		for (i = 0; i < c->n; i++) {
+			runs += (i == 0) || (a[i] != (uint16_t)(a[i-1] + 1));
+		}
+		return runs;
+	case ZROARING_BITMAP:
+		/* a run starts at every set bit whose lower neighbour is clear */
+		w = _ZROARING_WORDS(c);
+		for (i = 0; i < ZROARING_WORDS; i++) {
+			runs += _zroaring_popcount(w[i] & ~((w[i] << 1) | carry));
+			carry = w[i] >> 63;
+		}
+		return runs;
+	default:
+		return c->n;
+	}
+}
+
+static void _zroaring_c_to_runs(zroaring_container* const c, const uint32_t nruns)
+{
+	uint16_t* values;
+	uint16_t* runs;
+	uint32_t i, k;
+	if (c->type == ZROARING_ARRAY) {
+		values = _ZROARING_VALUES(c);
+	} else {
+		values = (uint16_t*)_zroaring_xmalloc(sizeof(uint16_t) * c->card);
+		_zroaring_words_to_values(_ZROARING_WORDS(c), values);
+	}
+	runs = (uint16_t*)_zroaring_xmalloc(sizeof(uint16_t) * 2 * nruns);
+	for (i = 0, k = 0; i < c->card; i++) {
+		if ((i > 0) && (values[i] == (uint16_t)(values[i-1] + 1))) {
+			runs[2 * k - 1]++;
+		} else {
+			runs[2 * k] = values[i];
+			runs[2 * k + 1] = 0;
+			k++;
+		}
+	}
+	if (c->type != ZROARING_ARRAY) {
+		free(values);
+	}
+	_zroaring_c_free(c);
+	c->type = ZROARING_RUN;
+	c->data = runs;
+	c->n = nruns;
+	c->cap = nruns;
+	c->owned = 1;
+}
+
+static void _zroaring_c_copy(zroaring_container* const dst, const zroaring_container* const src)
+{
+	const size_t bytes = (src->type == ZROARING_BITMAP) ? sizeof(uint64_t) * ZROARING_WORDS : (src->type == ZROARING_RUN) ? sizeof(uint16_t) * 2 * src->n : sizeof(uint16_t) * src->n;
+	*dst = *src;
+	dst->data = _zroaring_xmalloc(bytes);
+	memcpy(dst->data, src->data, bytes);
+	dst->cap = src->n;
+	dst->owned = 1;
+}
+
+/*** operations on whole bitmap containers ***/
+
+#if defined(__AVX2__)
+#define _ZROARING_VEC_LOOP(a, b, out, op) \
+	for (i = 0; i < ZROARING_WORDS; i += 4) { \
+		const __m256i va = _mm256_loadu_si256((const __m256i*)((a) + i)); \
+		const __m256i vb = _mm256_loadu_si256((const __m256i*)((b) + i)); \
+		_mm256_storeu_si256((__m256i*)((out) + i), op); \
+		card += _zroaring_popcount((out)[i]) + _zroaring_popcount((out)[i+1]) + _zroaring_popcount((out)[i+2]) + _zroaring_popcount((out)[i+3]); \
+	}
+#define _ZROARING_V_AND _mm256_and_si256(va, vb)
+#define _ZROARING_V_OR _mm256_or_si256(va, vb)
+#define _ZROARING_V_ANDNOT _mm256_andnot_si256(vb, va)
+#define _ZROARING_V_XOR _mm256_xor_si256(va, vb)
+#elif defined(__SSE2__)
+#define _ZROARING_VEC_LOOP(a, b, out, op) \
+	for (i = 0; i < ZROARING_WORDS; i += 2) { \
+		const __m128i va = _mm_loadu_si128((const __m128i*)((a) + i)); \
+		const __m128i vb = _mm_loadu_si128((const __m128i*)((b) + i)); \
+		_mm_storeu_si128((__m128i*)((out) + i), op); \
+		card += _zroaring_popcount((out)[i]) + _zroaring_popcount((out)[i+1]); \
+	}
+#define _ZROARING_V_AND _mm_and_si128(va, vb)
+#define _ZROARING_V_OR _mm_or_si128(va, vb)
+#define _ZROARING_V_ANDNOT _mm_andnot_si128(vb, va)
+#define _ZROARING_V_XOR _mm_xor_si128(va, vb)
+#else
+#define _ZROARING_VEC_LOOP(a, b, out, op) \
+	for (i = 0; i < ZROARING_WORDS; i++) { \
+		const uint64_t va = (a)[i]; \
+		const uint64_t vb = (b)[i]; \
+		(out)[i] = op; \
+		card += _zroaring_popcount((out)[i]); \
+	}
+#define _ZROARING_V_AND (va & vb)
+#define _ZROARING_V_OR (va | vb)
+#define _ZROARING_V_ANDNOT (va & ~vb)
+#define _ZROARING_V_XOR (va ^ vb)
+#endif
+
+/* out = a op b, one container's worth of words; returns the popcount of out, 
+   counted in the same pass. */
+static uint32_t _zroaring_words_op(const int op, const uint64_t* const a, const uint64_t* const b, uint64_t* const out)
+{
+	uint32_t i, card = 0;
+	switch (op) {
+	case _ZROARING_AND: _ZROARING_VEC_LOOP(a, b, out, _ZROARING_V_AND) break;
+	case _ZROARING_OR: _ZROARING_VEC_LOOP(a, b, out, _ZROARING_V_OR) break;
+	case _ZROARING_ANDNOT: _ZROARING_VEC_LOOP(a, b, out, _ZROARING_V_ANDNOT) break;
+	default: _ZROARING_VEC_LOOP(a, b, out, _ZROARING_V_XOR) break;
+	}
+	return card;
+}
+
+/* Merge the sorted arrays a and b into out according to op; returns the 
+   number of values written. */
+static uint32_t _zroaring_values_op(const int op, const uint16_t* const a, const uint32_t na, const uint16_t* const b, const uint32_t nb, uint16_t* const out)
+{
+	uint32_t i = 0, j = 0, n = 0;
+	while ((i < na) && (j < nb)) {
+		if (a[i] < b[j]) {
+			if (op != _ZROARING_AND) { out[n++] = a[i]; }
+			i++;
+		} else if (b[j] < a[i]) {
+			if ((op == _ZROARING_OR) || (op == _ZROARING_XOR)) { out[n++] = b[j]; }
+			j++;
+		} else {
+			if ((op == _ZROARING_AND) || (op == _ZROARING_OR)) { out[n++] = a[i]; }
+			i++;
+			j++;
+		}
+	}
+	if (op != _ZROARING_AND) {
+		while (i < na) { out[n++] = a[i++]; }
+	}
+	if ((op == _ZROARING_OR) || (op == _ZROARING_XOR)) {
+		while (j < nb) { out[n++] = b[j++]; }
+	}
+	return n;
+}
+
+/* Returns c's members as words, either c's own or filled into tmp. */
+static const uint64_t* _zroaring_c_words(const zroaring_container* const c, uint64_t* const tmp)
+{
+	if (c->type == ZROARING_BITMAP) {
+		return _ZROARING_WORDS(c);
+	}
+	_zroaring_c_fill_words(c, tmp);
+	return tmp;
+}
+
+/* out = a op b for two containers with the same key.  out->card may be 0. */
+static void _zroaring_c_op(const int op, const zroaring_container* const a, const zroaring_container* const b, zroaring_container* const out)
+{
+	uint64_t tmpa[ZROARING_WORDS];
+	uint64_t tmpb[ZROARING_WORDS];
+	const zroaring_container* arr;
+	const zroaring_container* other;
+	uint64_t* words;
+	uint16_t* values;
+	uint32_t i, n;
+	out->key = a->key;
+	out->owned = 1;
+	if ((a->type == ZROARING_ARRAY) && (b->type == ZROARING_ARRAY)) {
+		values = (uint16_t*)_zroaring_xmalloc(sizeof(uint16_t) * (a->n + b->n));
+		n = _zroaring_values_op(op, _ZROARING_VALUES(a), a->n, _ZROARING_VALUES(b), b->n, values);
+		if (n <= ZROARING_ARRAY_MAX) {
+			out->type = ZROARING_ARRAY;
+			out->data = values;
+			out->n = n;
+			out->cap = a->n + b->n;
+			out->card = n;
+		} else {
+			words = (uint64_t*)_zroaring_xmalloc(sizeof(uint64_t) * ZROARING_WORDS);
+			memset(words, 0, sizeof(uint64_t) * ZROARING_WORDS);
+			for (i = 0; i < n; i++) {
+				words[values[i] >> 6] |= 1ULL << (values[i] & 63);
+			}
+			free(values);
+			_zroaring_c_from_words(out, words, n);
+		}
+		return;
+	}
+	if (((op == _ZROARING_AND) && ((a->type == ZROARING_ARRAY) || (b->type == ZROARING_ARRAY))) || ((op == _ZROARING_ANDNOT) && (a->type == ZROARING_ARRAY))) {
+		/* the result is a subset of an array: filter it */
+		arr = ((op == _ZROARING_ANDNOT) || (a->type == ZROARING_ARRAY)) ? a : b;
+		other = (arr == a) ? b : a;
+		values = (uint16_t*)_zroaring_xmalloc(sizeof(uint16_t) * arr->n);
+		for (i = 0, n = 0; i < arr->n; i++) {
+			if (_zroaring_c_contains(other, _ZROARING_VALUES(arr)[i]) == (op == _ZROARING_AND)) {
+				values[n++] = _ZROARING_VALUES(arr)[i];
+			}
+		}
+		out->type = ZROARING_ARRAY;
+		out->data = values;
+		out->n = n;
+		out->cap = arr->n;
+		out->card = n;
+		return;
+	}
+	words = (uint64_t*)_zroaring_xmalloc(sizeof(uint64_t) * ZROARING_WORDS);
+	n = _zroaring_words_op(op, _zroaring_c_words(a, tmpa), _zroaring_c_words(b, tmpb), words);
+	_zroaring_c_from_words(out, words, n);
+}
+
+/*** the set ***/
+
+void zroaring_init(zroaring* const r)
+{
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	r->len = 0;
+	r->cap = 0;
+	r->cs = NULL;
+	r->readonly = 0;
+}
+
+void zroaring_free(zroaring* const r)
+{
+	size_t i;
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	for (i = 0; i < r->len; i++) {
+		_zroaring_c_free(&r->cs[i]);
+	}
+	if (r->cs != NULL) {
+		free(r->cs);
+	}
+	zroaring_init(r);
+}
+
+/* Returns the index of the first container whose key is >= key. */
+static size_t _zroaring_find(const zroaring* const r, const uint16_t key)
+{
+	size_t lo = 0, hi = r->len, mid;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (r->cs[mid].key < key) { lo = mid + 1; } else { hi = mid; }
+	}
+	return lo;
+}
+
+/* Make room for a new container at index i and return it. */
+static zroaring_container* _zroaring_insert(zroaring* const r, const size_t i)
+{
+	if (r->len == r->cap) {
+		r->cap = _zlist_grow_cap(r->cap, r->len + 1, sizeof(zroaring_container));
+		r->cs = (zroaring_container*)realloc(r->cs, sizeof(zroaring_container) * r->cap);
+		runtime_assert(r->cs != NULL, "memory exhaustion");
+	}
+	memmove(r->cs + i + 1, r->cs + i, sizeof(zroaring_container) * (r->len - i));
+	r->len++;
+	memset(&r->cs[i], 0, sizeof(zroaring_container));
+	return &r->cs[i];
+}
+
+bool zroaring_add(zroaring* const r, const uint32_t x)
+{
+	const uint16_t key = (uint16_t)(x >> 16);
+	zroaring_container* c;
+	size_t i;
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	runtime_assert(!r->readonly, "This bitmap is a read-only view.");
+	i = _zroaring_find(r, key);
+	if ((i < r->len) && (r->cs[i].key == key)) {
+		return _zroaring_c_add(&r->cs[i], (uint16_t)x);
+	}
+	c = _zroaring_insert(r, i);
+	c->key = key;
+	c->type = ZROARING_ARRAY;
+	c->owned = 1;
+	c->cap = 4;
+	c->data = _zroaring_xmalloc(sizeof(uint16_t) * c->cap);
+	_ZROARING_VALUES(c)[0] = (uint16_t)x;
+	c->n = 1;
+	c->card = 1;
+	return true;
+}
+
+bool zroaring_remove(zroaring* const r, const uint32_t x)
+{
+	const uint16_t key = (uint16_t)(x >> 16);
+	size_t i;
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	runtime_assert(!r->readonly, "This bitmap is a read-only view.");
+	i = _zroaring_find(r, key);
+	if ((i == r->len) || (r->cs[i].key != key) || !_zroaring_c_remove(&r->cs[i], (uint16_t)x)) {
+		return false;
+	}
+	if (r->cs[i].card == 0) {
+		_zroaring_c_free(&r->cs[i]);
+		memmove(r->cs + i, r->cs + i + 1, sizeof(zroaring_container) * (r->len - i - 1));
+		r->len--;
+	}
+	return true;
+}
+
+bool zroaring_contains(const zroaring* const r, const uint32_t x)
+{
+	const uint16_t key = (uint16_t)(x >> 16);
+	size_t i;
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	i = _zroaring_find(r, key);
+	return (i < r->len) && (r->cs[i].key == key) && _zroaring_c_contains(&r->cs[i], (uint16_t)x);
+}
+
+uint64_t zroaring_cardinality(const zroaring* const r)
+{
+	uint64_t n = 0;
+	size_t i;
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	for (i = 0; i < r->len; i++) {
+		n += r->cs[i].card;
+	}
+	return n;
+}
+
+uint64_t zroaring_rank(const zroaring* const r, const uint32_t x)
+{
+	const uint16_t key = (uint16_t)(x >> 16);
+	uint64_t n = 0;
+	size_t i;
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	for (i = 0; (i < r->len) && (r->cs[i].key < key); i++) {
+		n += r->cs[i].card;
+	}
+	if ((i < r->len) && (r->cs[i].key == key)) {
+		n += _zroaring_c_rank(&r->cs[i], (uint16_t)x);
+	}
+	return n;
+}
+
+bool zroaring_select(const zroaring* const r, uint64_t i, uint32_t* const x)
+{
+	size_t k;
+	runtime_assert((r != NULL) && (x != NULL), "You are required to pass a non-NULL pointer.");
+	for (k = 0; k < r->len; k++) {
+		if (i < r->cs[k].card) {
+			*x = ((uint32_t)r->cs[k].key << 16) | _zroaring_c_select(&r->cs[k], (uint32_t)i);
+			return true;
+		}
+		i -= r->cs[k].card;
+	}
+	return false;
+}
+
+static void _zroaring_op(const int op, zroaring* const dst, const zroaring* const a, const zroaring* const b)
+{
+	size_t i = 0, j = 0;
+	zroaring_container* c;
+	runtime_assert((dst != NULL) && (a != NULL) && (b != NULL), "You are required to pass a non-NULL pointer.");
+	runtime_assert((dst != a) && (dst != b), "The result must be a different zroaring from the operands.");
+	runtime_assert(!dst->readonly, "This bitmap is a read-only view.");
+	while (dst->len > 0) {
+		_zroaring_c_free(&dst->cs[--dst->len]);
+	}
+	while ((i < a->len) || (j < b->len)) {
+		if ((j == b->len) || ((i < a->len) && (a->cs[i].key < b->cs[j].key))) {
+			if (op == _ZROARING_AND) {
+				if (j == b->len) { break; }
+				i++;
+				continue;
+			}
+			_zroaring_c_copy(_zroaring_insert(dst, dst->len), &a->cs[i++]);
+		} else if ((i == a->len) || (b->cs[j].key < a->cs[i].key)) {
+			if ((op == _ZROARING_AND) || (op == _ZROARING_ANDNOT)) {
+				if (i == a->len) { break; }
+				j++;
+				continue;
+			}
+			_zroaring_c_copy(_zroaring_insert(dst, dst->len), &b->cs[j++]);
+		} else {
+			c = _zroaring_insert(dst, dst->len);
+			_zroaring_c_op(op, &a->cs[i++], &b->cs[j++], c);
+			if (c->card == 0) {
+				_zroaring_c_free(c);
+				dst->len--;
+			}
+		}
+	}
+}
+
+void zroaring_and(zroaring* const dst, const zroaring* const a, const zroaring* const b)
+{
+	_zroaring_op(_ZROARING_AND, dst, a, b);
+}
+
+void zroaring_or(zroaring* const dst, const zroaring* const a, const zroaring* const b)
+{
+	_zroaring_op(_ZROARING_OR, dst, a, b);
+}
+
+void zroaring_andnot(zroaring* const dst, const zroaring* const a, const zroaring* const b)
+{
+	_zroaring_op(_ZROARING_ANDNOT, dst, a, b);
+}
+
+void zroaring_xor(zroaring* const dst, const zroaring* const a, const zroaring* const b)
+{
+	_zroaring_op(_ZROARING_XOR, dst, a, b);
+}
+
+uint64_t zroaring_and_cardinality(const zroaring* const a, const zroaring* const b)
+{
+	uint64_t tmpa[ZROARING_WORDS];
+	uint64_t tmpb[ZROARING_WORDS];
+	const uint64_t* wa;
+	const uint64_t* wb;
+	const zroaring_container* ca;
+	const zroaring_container* cb;
+	uint64_t n = 0;
+	size_t i = 0, j = 0;
+	uint32_t k;
+	runtime_assert((a != NULL) && (b != NULL), "You are required to pass a non-NULL pointer.");
+	while ((i < a->len) && (j < b->len)) {
+		ca = &a->cs[i];
+		cb = &b->cs[j];
+		if (ca->key < cb->key) { i++; continue; }
+		if (cb->key < ca->key) { j++; continue; }
+		if (cb->type == ZROARING_ARRAY) { ca = &b->cs[j]; cb = &a->cs[i]; }
+		if (ca->type == ZROARING_ARRAY) {
+			for (k = 0; k < ca->n; k++) {
+				n += _zroaring_c_contains(cb, _ZROARING_VALUES(ca)[k]);
+			}
+		} else {
+			wa = _zroaring_c_words(ca, tmpa);
+			wb = _zroaring_c_words(cb, tmpb);
+			for (k = 0; k < ZROARING_WORDS; k++) {
+				n += _zroaring_popcount(wa[k] & wb[k]);
+			}
+		}
+		i++;
+		j++;
+	}
+	return n;
+}
+
+void zroaring_run_optimize(zroaring* const r)
+{
+	zroaring_container* c;
+	uint32_t nruns;
+	size_t i, size;
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	runtime_assert(!r->readonly, "This bitmap is a read-only view.");
+	for (i = 0; i < r->len; i++) {
+		c = &r->cs[i];
+		if (c->type == ZROARING_RUN) { continue; }
+		nruns = _zroaring_c_count_runs(c);
+		size = (c->type == ZROARING_ARRAY) ? sizeof(uint16_t) * c->card : sizeof(uint64_t) * ZROARING_WORDS;
+		if (sizeof(uint16_t) * 2 * nruns < size) {
+			_zroaring_c_to_runs(c, nruns);
+		}
+	}
+}
+
+/*** iteration ***/
+
+static void _zroaring_iter_enter(zroaring_iter* const it)
+{
+	it->i = 0;
+	it->j = 0;
+	it->w = ((it->ci < it->r->len) && (it->r->cs[it->ci].type == ZROARING_BITMAP)) ? _ZROARING_WORDS(&it->r->cs[it->ci])[0] : 0;
+}
+
+void zroaring_iter_init(zroaring_iter* const it, const zroaring* const r)
+{
+	runtime_assert((it != NULL) && (r != NULL), "You are required to pass a non-NULL pointer.");
+	it->r = r;
+	it->ci = 0;
+	_zroaring_iter_enter(it);
+}
+
+bool zroaring_iter_next(zroaring_iter* const it, uint32_t* const x)
+{
+	const zroaring_container* c;
+	uint32_t high;
+	while (it->ci < it->r->len) {
+		c = &it->r->cs[it->ci];
+		high = (uint32_t)c->key << 16;
+		switch (c->type) {
+		case ZROARING_ARRAY:
+			if (it->i < c->n) {
+				*x = high | _ZROARING_VALUES(c)[it->i++];
+				return true;
+			}
+			break;
+		case ZROARING_BITMAP:
+			for (;;) {
+				if (it->w != 0) {
+					*x = high | (it->i * 64 + _zroaring_ctz(it->w));
+					it->w &= it->w - 1;
+					return true;
+				}
+				if (++it->i == ZROARING_WORDS) { break; }
+				it->w = _ZROARING_WORDS(c)[it->i];
+			}
+			break;
+		default:
+			while (it->i < c->n) {
+				if (it->j <= _ZROARING_RUNS(c)[2 * it->i + 1]) {
+					*x = high | (uint16_t)(_ZROARING_RUNS(c)[2 * it->i] + it->j++);
+					return true;
+				}
+				it->i++;
+				it->j = 0;
+			}
+			break;
+		}
+		it->ci++;
+		_zroaring_iter_enter(it);
+	}
+	return false;
+}
+
+/*** serialization ***/
+
+static size_t _zroaring_payload_size(const zroaring_container* const c)
+{
+	switch (c->type) {
+	case ZROARING_ARRAY: return sizeof(uint16_t) * c->n;
+	case ZROARING_BITMAP: return sizeof(uint64_t) * ZROARING_WORDS;
+	default: return sizeof(uint16_t) * 2 * c->n;
+	}
+}
+
+#define _ZROARING_ALIGN8(x) (((x) + 7) & ~(size_t)7)
+
+size_t zroaring_serialized_size(const zroaring* const r)
+{
+	size_t i, size;
+	runtime_assert(r != NULL, "You are required to pass a non-NULL pointer.");
+	size = _ZROARING_HEADER + _ZROARING_DIRENT * r->len;
+	for (i = 0; i < r->len; i++) {
+		size = _ZROARING_ALIGN8(size) + _zroaring_payload_size(&r->cs[i]);
+	}
+	return size;
+}
+
+void zroaring_serialize(const zroaring* const r, zbyte* const buf)
+{
+	const zroaring_container* c;
+	const uint16_t* v;
+	const uint64_t* w;
+	zbyte* p;
+	size_t i, k, off, end;
+	runtime_assert((r != NULL) && (buf != NULL), "You are required to pass a non-NULL pointer.");
+	uint32_encode(ZROARING_MAGIC, buf);
+	uint32_encode((unsigned long)r->len, buf + 4);
+	off = _ZROARING_HEADER + _ZROARING_DIRENT * r->len;
+	for (i = 0; i < r->len; i++) {
+		c = &r->cs[i];
+		end = _ZROARING_ALIGN8(off);
+		memset(buf + off, 0, end - off);
+		off = end;
+		runtime_assert(off <= 0xFFFFFFFFUL, "A serialized zroaring is limited to 4 GB.");
+		p = buf + _ZROARING_HEADER + _ZROARING_DIRENT * i;
+		uint32_encode(((unsigned long)c->key << 16) | c->type, p);
+		uint32_encode(c->card, p + 4);
+		uint32_encode(c->n, p + 8);
+		uint32_encode((unsigned long)off, p + 12);
+		p = buf + off;
+		if (_zroaring_little_endian()) {
+			memcpy(p, c->data, _zroaring_payload_size(c));
+		} else if (c->type == ZROARING_BITMAP) {
+			w = _ZROARING_WORDS(c);
+			for (k = 0; k < ZROARING_WORDS * 8; k++) {
+				p[k] = (zbyte)(w[k / 8] >> (8 * (k % 8)));
+			}
+		} else {
+			v = (const uint16_t*)c->data;
+			for (k = 0; k < _zroaring_payload_size(c); k++) {
+				p[k] = (zbyte)(v[k / 2] >> (8 * (k % 2)));
+			}
+		}
+		off += _zroaring_payload_size(c);
+	}
+}
+
+/* Returns true if c's contents agree with its type and card: array values 
+   strictly ascending, bitmap bits summing to card, runs in order, not 
+   overlapping, inside 0..65535 and summing to card. */
+static bool _zroaring_c_valid(const zroaring_container* const c)
+{
+	const uint16_t* a;
+	const uint64_t* w;
+	uint32_t i, sum = 0, end = 0;
+	switch (c->type) {
+	case ZROARING_ARRAY:
+		a = _ZROARING_VALUES(c);
+		for (i = 1; i < c->n; i++) {
+			if (a[i] <= a[i-1]) { return false; }
+		}
+		return true;
+	case ZROARING_BITMAP:
+		w = _ZROARING_WORDS(c);
+		for (i = 0; i < ZROARING_WORDS; i++) {
+			sum += _zroaring_popcount(w[i]);
+		}
+		return sum == c->card;
+	default:
+		a = _ZROARING_RUNS(c);
+		for (i = 0; i < c->n; i++) {
+			if ((i > 0) && (a[2 * i] <= end)) { return false; }
+			end = (uint32_t)a[2 * i] + a[2 * i + 1];
+			if (end > 0xFFFF) { return false; }
+			sum += (uint32_t)a[2 * i + 1] + 1;
+		}
+		return sum == c->card;
+	}
+}
+
+bool zroaring_view(zroaring* const r, const zbyte* const buf, const size_t len)
+{
+	const bool inplace = _zroaring_little_endian() && (((size_t)buf & 7) == 0);
+	zroaring_container* c;
+	const zbyte* e;
+	size_t n, i, k, off, bytes;
+	unsigned long kt;
+	runtime_assert((r != NULL) && ((buf != NULL) || (len == 0)), "You are required to pass a non-NULL pointer.");
+	zroaring_init(r);
+	if ((len < _ZROARING_HEADER) || (uint32_decode(buf) != ZROARING_MAGIC)) { return false; }
+	n = uint32_decode(buf + 4);
+	if ((n > 65536) || (_ZROARING_HEADER + _ZROARING_DIRENT * n > len)) { return false; }
+	r->cs = (zroaring_container*)_zroaring_xmalloc(sizeof(zroaring_container) * n);
+	r->cap = n;
+	for (i = 0; i < n; i++) {
+		e = buf + _ZROARING_HEADER + _ZROARING_DIRENT * i;
+		c = &r->cs[i];
+		kt = uint32_decode(e);
+		c->key = (uint16_t)(kt >> 16);
+		c->type = (uint8_t)(kt & 0xFFFF);
+		c->card = (uint32_t)uint32_decode(e + 4);
+		c->n = (uint32_t)uint32_decode(e + 8);
+		c->cap = c->n;
+		off = uint32_decode(e + 12);
+		if (((i > 0) && (c->key <= r->cs[i-1].key)) || ((kt & 0xFFFF) > ZROARING_RUN) || (c->card == 0) || (c->card > 65536)) { break; }
+		if ((c->type == ZROARING_ARRAY) && ((c->n != c->card) || (c->n > ZROARING_ARRAY_MAX))) { break; }
+		if ((c->type == ZROARING_BITMAP) && ((c->n != ZROARING_WORDS) || (c->card <= ZROARING_ARRAY_MAX))) { break; }
+		if ((c->type == ZROARING_RUN) && ((c->n == 0) || (c->n > 32768))) { break; }
+		if (c->type == 0) { break; }
+		bytes = _zroaring_payload_size(c);
+		if (((off & 7) != 0) || (off > len) || (bytes > len - off)) { break; }
+		if (inplace) {
+			c->data = (void*)(buf + off);
+			c->owned = 0;
+		} else {
+			c->data = _zroaring_xmalloc(bytes);
+			c->owned = 1;
+			if (c->type == ZROARING_BITMAP) {
+				for (k = 0; k < ZROARING_WORDS; k++) {
+					_ZROARING_WORDS(c)[k] = 0;
+				}
+				for (k = 0; k < bytes; k++) {
+					_ZROARING_WORDS(c)[k / 8] |= (uint64_t)buf[off + k] << (8 * (k % 8));
+				}
+			} else {
+				for (k = 0; k < bytes / 2; k++) {
+					((uint16_t*)c->data)[k] = (uint16_t)(buf[off + 2 * k] | (buf[off + 2 * k + 1] << 8));
+				}
+			}
+		}
+		r->len++;
+		if (!_zroaring_c_valid(c)) { break; }
+	}
+	if (i < n) {
+		zroaring_free(r);
+		return false;
+	}
+	r->readonly = 1;
+	return true;
+}
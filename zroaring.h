@@ -0,0 +1,182 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zroaring_h
+#define __INCL_zroaring_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "zutil.h"
+
+/**
+ * A zroaring is a compressed set of 32-bit unsigned integers, after the 
+ * "Roaring" bitmaps of Chambi, Lemire et al.  The integers are grouped by 
+ * their high 16 bits, and the low 16 bits of each group live in a 
+ * "container" of one of three kinds, whichever is smallest:
+ *
+ *   - an array: a sorted array of up to ZROARING_ARRAY_MAX 16-bit values;
+ *   - a bitmap: 65536 bits, for groups with more members than that;
+ *   - runs: a sorted array of (start, length - 1) pairs of 16-bit values, for 
+ *     groups which are mostly long stretches of consecutive integers.
+ *
+ * Adding and removing switch between arrays and bitmaps automatically.  Run 
+ * containers are only made by zroaring_run_optimize(); changing a run 
+ * container turns it back into an array or a bitmap.
+ *
+ * The set operations combine two bitmap containers 128 bits at a time with 
+ * SSE2 (256 with AVX2), and count the result in the same pass, so 
+ * intersecting two dense sets costs a few instructions per 64 integers.
+ *
+ * A zroaring can also be a read-only view of a serialized bitmap, made with 
+ * zroaring_view(), whose containers point straight into the serialized bytes 
+ * -- e.g. into a file you have mmap()'d -- without copying them.
+ */
+
+#define ZROARING_ARRAY 1
+#define ZROARING_BITMAP 2
+#define ZROARING_RUN 3
+
+#define ZROARING_ARRAY_MAX 4096
+#define ZROARING_WORDS 1024 /* 64-bit words in a bitmap container */
+
+typedef struct {
+	uint16_t key; /* the high 16 bits shared by all members */
+	uint8_t type;
+	uint8_t owned; /* false if data points into someone else's (serialized) memory */
+	uint32_t card; /* number of members */
+	uint32_t n; /* array: values, runs: pairs, bitmap: ZROARING_WORDS */
+	uint32_t cap; /* how many values or pairs data has room for */
+	void* data;
+} zroaring_container;
+
+typedef struct {
+	size_t len;
+	size_t cap;
+	zroaring_container* cs; /* in ascending order of key */
+	bool readonly;
+} zroaring;
+
+#define ZROARING_INITIALIZER { 0, 0, NULL, 0 }
+
+void zroaring_init(zroaring* r);
+
+/**
+ * Free the memory.  For a view this frees only the directory, not the 
+ * serialized bytes.  Okay to call this on an already-freed zroaring.
+ */
+void zroaring_free(zroaring* r);
+
+/**
+ * Add x to the set.  Returns true if it wasn't there already.
+ */
+bool zroaring_add(zroaring* r, uint32_t x);
+
+/**
+ * Remove x from the set.  Returns true if it was there.
+ */
+bool zroaring_remove(zroaring* r, uint32_t x);
+
+bool zroaring_contains(const zroaring* r, uint32_t x);
+
+/**
+ * Returns the number of members.
+ */
+uint64_t zroaring_cardinality(const zroaring* r);
+
+/**
+ * Returns the number of members which are <= x.
+ */
+uint64_t zroaring_rank(const zroaring* r, uint32_t x);
+
+/**
+ * Store the i'th smallest member (counting from 0) in *x and return true, or 
+ * return false if there are no more than i members.
+ */
+bool zroaring_select(const zroaring* r, uint64_t i, uint32_t* x);
+
+/**
+ * Make dst the intersection, union, difference (a minus b) or symmetric 
+ * difference of a and b.  dst must be initialized, must not be a view, and 
+ * must not be the same zroaring as a or b; its old contents are discarded.
+ */
+void zroaring_and(zroaring* dst, const zroaring* a, const zroaring* b);
+void zroaring_or(zroaring* dst, const zroaring* a, const zroaring* b);
+void zroaring_andnot(zroaring* dst, const zroaring* a, const zroaring* b);
+void zroaring_xor(zroaring* dst, const zroaring* a, const zroaring* b);
+
+/**
+ * Returns the size of the intersection of a and b without building it.
+ */
+uint64_t zroaring_and_cardinality(const zroaring* a, const zroaring* b);
+
+/**
+ * Convert each container to runs if that is smaller.  Call this once a set 
+ * has been built, before serializing it or using it a lot.
+ */
+void zroaring_run_optimize(zroaring* r);
+
+/**
+ * Iterate over the members in ascending order:
+ *
+ * zroaring_iter it;
+ * uint32_t x;
+ * zroaring_iter_init(&it, &r);
+ * while (zroaring_iter_next(&it, &x)) {
+ * 	...
+ * }
+ *
+ * The set must not change during the iteration.
+ */
+typedef struct {
+	const zroaring* r;
+	size_t ci; /* container */
+	uint32_t i; /* array index, run index, or bitmap word index */
+	uint32_t j; /* offset within the current run */
+	uint64_t w; /* unvisited bits of the current bitmap word */
+} zroaring_iter;
+
+void zroaring_iter_init(zroaring_iter* it, const zroaring* r);
+bool zroaring_iter_next(zroaring_iter* it, uint32_t* x);
+
+/**
+ * The serialized form is a header and a directory of containers, in 
+ * big-endian (see uint32_encode() in zutil.h), followed by the contents of the 
+ * containers as little-endian 16- and 64-bit integers, each starting at a 
+ * multiple of 8 bytes.  So on a little-endian machine, with the serialized 
+ * bytes at an address which is a multiple of 8 (as the start of an mmap()'d 
+ * file is), a view can use the contents in place.
+ *
+ * zroaring_serialized_size() returns the number of bytes zroaring_serialize() 
+ * will write to buf.
+ */
+size_t zroaring_serialized_size(const zroaring* r);
+void zroaring_serialize(const zroaring* r, zbyte* buf);
+
+/**
+ * Make r a read-only view of the len serialized bytes at buf, which must stay 
+ * around and unchanged until r is freed.  r need not be initialized.  Only 
+ * the directory is allocated; on a big-endian machine, or if buf isn't 8-byte 
+ * aligned, the container contents are copied as well.
+ *
+ * Returns false if buf doesn't hold a well-formed serialized bitmap: the 
+ * magic number, the directory and every container are checked, including 
+ * that keys and array values are strictly ascending, that runs are in order, 
+ * don't overlap and don't pass 65535, that each container's stored 
+ * cardinality matches its contents, and that array containers hold at most 
+ * ZROARING_ARRAY_MAX members and bitmap containers more.  This reads every 
+ * byte of buf once.
+ */
+bool zroaring_view(zroaring* r, const zbyte* buf, size_t len);
+
+#endif /* #ifndef __INCL_zroaring_h */
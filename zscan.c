@@ -0,0 +1,195 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#include "zscan.h"
+
+#include "moreassert.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define _ZSCAN_VEC 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define _ZSCAN_VEC 16
+#endif
+
+#ifdef _ZSCAN_VEC
+
+/* Returns a mask with one bit per byte of the _ZSCAN_VEC bytes at p, where the 
+   bits for a width-byte element are all set iff it equals the element that 
+   was broadcast into needle. */
+#if _ZSCAN_VEC == 32
+typedef __m256i _zscan_vec;
+#define _ZSCAN_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define _ZSCAN_MOVEMASK(v) ((unsigned long long)(unsigned)_mm256_movemask_epi8(v))
+static _zscan_vec _zscan_splat(const unsigned long long x, const size_t width) {
+	switch (width) {
+	case 1: return _mm256_set1_epi8((char)x);
+	case 2: return _mm256_set1_epi16((short)x);
+	case 4: return _mm256_set1_epi32((int)x);
+	default: return _mm256_set1_epi64x((long long)x);
+	}
+}
+static _zscan_vec _zscan_cmpeq(const _zscan_vec a, const _zscan_vec b, const size_t width) {
+	switch (width) {
+	case 1: return _mm256_cmpeq_epi8(a, b);
+	case 2: return _mm256_cmpeq_epi16(a, b);
+	case 4: return _mm256_cmpeq_epi32(a, b);
+	default: return _mm256_cmpeq_epi64(a, b);
+	}
+}
+#else
+typedef __m128i _zscan_vec;
+#define _ZSCAN_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define _ZSCAN_MOVEMASK(v) ((unsigned long long)(unsigned)_mm_movemask_epi8(v))
+static _zscan_vec _zscan_splat(const unsigned long long x, const size_t width) {
+	switch (width) {
+	case 1: return _mm_set1_epi8((char)x);
+	case 2: return _mm_set1_epi16((short)x);
+	case 4: return _mm_set1_epi32((int)x);
+	default: return _mm_set1_epi64x((long long)x);
+	}
+}
+static _zscan_vec _zscan_cmpeq(const _zscan_vec a, const _zscan_vec b, const size_t width) {
+	_zscan_vec e;
+	switch (width) {
+	case 1: return _mm_cmpeq_epi8(a, b);
+	case 2: return _mm_cmpeq_epi16(a, b);
+	case 4: return _mm_cmpeq_epi32(a, b);
+	default:
+		/* SSE2 has no 64-bit compare: both 32-bit halves have to match. */
+		e = _mm_cmpeq_epi32(a, b);
+		return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+}
+#endif
+
+static unsigned long long _zscan_bits(const void* const item, const size_t width)
+{
+	unsigned char b1;
+	unsigned short b2;
+	unsigned int b4;
+	unsigned long long b8;
+	switch (width) {
+	case 1: memcpy(&b1, item, 1); return b1;
+	case 2: memcpy(&b2, item, 2); return b2;
+	case 4: memcpy(&b4, item, 4); return b4;
+	default: memcpy(&b8, item, 8); return b8;
+	}
+}
+
+static size_t _zscan_popcount(unsigned long long m)
+{
+#ifdef __GNUC__
+	return (size_t)__builtin_popcountll(m);
+#else
+	size_t n = 0;
+	while (m != 0) { m &= m - 1; n++; }
+	return n;
+#endif
+}
+
+static size_t _zscan_ctz(unsigned long long m)
+{
+#ifdef __GNUC__
+	return (size_t)__builtin_ctzll(m);
+#else
+	size_t n = 0;
+	while ((m & 1) == 0) { m >>= 1; n++; }
+	return n;
+#endif
+}
+
+/* These are called with a constant width so that the compiler can fold the 
+   switches in the helpers above out of the loop. */
+static inline size_t _zscan_find_simd(const unsigned char* const bs, const size_t len, const void* const item, const size_t width, size_t* const scanned)
+{
+	const size_t per = _ZSCAN_VEC / width;
+	const _zscan_vec needle = _zscan_splat(_zscan_bits(item, width), width);
+	unsigned long long m;
+	size_t i;
+	for (i = 0; i + per <= len; i += per) {
+		m = _ZSCAN_MOVEMASK(_zscan_cmpeq(_ZSCAN_LOAD(bs + i * width), needle, width));
+		if (m != 0) {
+			*scanned = i;
+			return i + _zscan_ctz(m) / width;
+		}
+	}
+	*scanned = i;
+	return len;
+}
+
+static inline size_t _zscan_count_simd(const unsigned char* const bs, const size_t len, const void* const item, const size_t width, size_t* const scanned)
+{
+	const size_t per = _ZSCAN_VEC / width;
+	const _zscan_vec needle = _zscan_splat(_zscan_bits(item, width), width);
+	size_t bytes = 0;
+	size_t i;
+	for (i = 0; i + per <= len; i += per) {
+		bytes += _zscan_popcount(_ZSCAN_MOVEMASK(_zscan_cmpeq(_ZSCAN_LOAD(bs + i * width), needle, width)));
+	}
+	*scanned = i;
+	return bytes / width;
+}
+
+#endif /* #ifdef _ZSCAN_VEC */
+
+size_t zscan_find(const void* const arr, const size_t len, const void* const item, const size_t width)
+{
+	const unsigned char* const bs = (const unsigned char*)arr;
+	size_t i = 0;
+	size_t r = len;
+	runtime_assert((arr != NULL) || (len == 0), "You are required to pass a non-NULL array.");
+	runtime_assert(width > 0, "Elements must be at least one byte wide.");
+#ifdef _ZSCAN_VEC
+	switch (width) {
+	case 1: r = _zscan_find_simd(bs, len, item, 1, &i); break;
+	case 2: r = _zscan_find_simd(bs, len, item, 2, &i); break;
+	case 4: r = _zscan_find_simd(bs, len, item, 4, &i); break;
+	case 8: r = _zscan_find_simd(bs, len, item, 8, &i); break;
+	}
+	if (r < len) {
+		return r;
+	}
+#endif
+	for (; i < len; i++) {
+		if (memcmp(bs + i * width, item, width) == 0) {
+			return i;
+		}
+	}
+	return len;
+}
+
+size_t zscan_count(const void* const arr, const size_t len, const void* const item, const size_t width)
+{
+	const unsigned char* const bs = (const unsigned char*)arr;
+	size_t i = 0;
+	size_t n = 0;
+	runtime_assert((arr != NULL) || (len == 0), "You are required to pass a non-NULL array.");
+	runtime_assert(width > 0, "Elements must be at least one byte wide.");
+#ifdef _ZSCAN_VEC
+	switch (width) {
+	case 1: n = _zscan_count_simd(bs, len, item, 1, &i); break;
+	case 2: n = _zscan_count_simd(bs, len, item, 2, &i); break;
+	case 4: n = _zscan_count_simd(bs, len, item, 4, &i); break;
+	case 8: n = _zscan_count_simd(bs, len, item, 8, &i); break;
+	}
+#endif
+	for (; i < len; i++) {
+		if (memcmp(bs + i * width, item, width) == 0) {
+			n++;
+		}
+	}
+	return n;
+}
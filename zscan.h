@@ -0,0 +1,35 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+#ifndef __INCL_zscan_h
+#define __INCL_zscan_h
+
+#include <stddef.h>
+
+/**
+ * Linear scans for an element in an array of len elements, each of which is 
+ * width bytes wide.  Elements are compared bit-for-bit with the width bytes at 
+ * item, so these are meant for integers and pointers -- not for floating point 
+ * numbers (where 0.0 == -0.0 but NaN != NaN) or for structs with padding.
+ *
+ * When width is 1, 2, 4 or 8 the comparisons are done 16 bytes at a time with 
+ * SSE2, or 32 bytes at a time if the library was compiled with AVX2 enabled 
+ * (e.g. with -mavx2).  Any other width, or a machine without SSE2, gets a 
+ * plain loop.
+ *
+ * zscan_find() returns the index of the first element equal to item, or len if 
+ * there isn't one.  zscan_count() returns the number of elements equal to item.
+ */
+size_t zscan_find(const void* arr, size_t len, const void* item, size_t width);
+size_t zscan_count(const void* arr, size_t len, const void* item, size_t width);
+
+#endif /* #ifndef __INCL_zscan_h */
@@ -0,0 +1,230 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zsort.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+
+/* Up to this many elements get a sorting network. */
+#define ZSORT_NETWORK_MAX 16
+/* Below this many elements insertion sort beats radix sort. */
+#define ZSORT_RADIX_MIN 64
+/* Don't give a thread less than this many elements. */
+#define ZSORT_MIN_PER_THREAD 65536
+
+/* Run fn(jobs + i*jobsize) for i in 0 .. njobs-1, on njobs threads (one of 
+   which is the calling thread), and wait for all of them. */
+static void _zsort_run(void* (*fn)(void*), unsigned char* const jobs, const size_t jobsize, const size_t njobs)
+{
+	pthread_t* threads;
+	size_t i;
+	if (njobs == 1) {
+		fn(jobs);
+		return;
+	}
+	threads = (pthread_t*)malloc(sizeof(pthread_t) * njobs);
+	runtime_assert(threads != NULL, "memory exhaustion");
+	for (i = 1; i < njobs; i++) {
+		runtime_assert(pthread_create(&threads[i], NULL, fn, jobs + i * jobsize) == 0, "failed to create a thread");
+	}
+	fn(jobs);
+	for (i = 1; i < njobs; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+}
+
+/* Keys are compared as unsigned T after XORing them with flip, which is the 
+   sign bit for signed types and 0 for unsigned ones.
+
+   The network is Knuth's merge exchange (Batcher's odd-even merge, TAOCP 
+   5.2.2 Algorithm M), which works for any n; the compare-exchanges are 
+   written with conditional moves rather than branches. */
+#define _ZSORT_DEFINE(T) \
+static void _zsort_network_##T(T* const a, const size_t n, const T flip) { \
+	size_t t, p, q, r, d, i; \
+	T x, y; \
+	bool sw; \
+	if (n < 2) { return; } \
+	for (t = 0; ((size_t)1 << t) < n; t++) { } \
+	for (p = (size_t)1 << (t - 1); p > 0; p >>= 1) { \
+		q = (size_t)1 << (t - 1); \
+		r = 0; \
+		d = p; \
+		for (;;) { \
+			for (i = 0; i + d < n; i++) { \
+				if ((i & p) == r) { \
+					x = a[i]; \
+					y = a[i + d]; \
+					sw = (T)(y ^ flip) < (T)(x ^ flip); \
+					a[i] = sw ? y : x; \
+					a[i + d] = sw ? x : y; \
+				} \
+			} \
+			if (q == p) { break; } \
+			d = q - p; \
+			q >>= 1; \
+			r = p; \
+		} \
+	} \
+} \
+ \
+static void _zsort_insertion_##T(T* const a, const size_t n, const T flip) { \
+	size_t i, j; \
+	T x; \
+	for (i = 1; i < n; i++) { \
+		x = a[i]; \
+		for (j = i; (j > 0) && ((T)(x ^ flip) < (T)(a[j-1] ^ flip)); j--) { \
+			a[j] = a[j-1]; \
+		} \
+		a[j] = x; \
+	} \
+} \
+ \
+typedef struct { \
+	const T* src; \
+	T* dst; \
+	size_t lo; \
+	size_t hi; \
+	T flip; \
+	unsigned shift; \
+	int phase; /* 0: count all digits, 1: count one digit, 2: scatter */ \
+	size_t counts[sizeof(T)][256]; \
+	size_t offs[256]; \
+} _zsort_job_##T; \
+ \
+static void* _zsort_work_##T(void* arg) { \
+	_zsort_job_##T* const j = (_zsort_job_##T*)arg; \
+	size_t i, d; \
+	T x; \
+	if (j->phase == 0) { \
+		memset(j->counts, 0, sizeof(j->counts)); \
+		for (i = j->lo; i < j->hi; i++) { \
+			x = j->src[i] ^ j->flip; \
+			for (d = 0; d < sizeof(T); d++) { \
+				j->counts[d][(x >> (8 * d)) & 0xFF]++; \
+			} \
+		} \
+	} else if (j->phase == 1) { \
+		memset(j->counts[0], 0, sizeof(j->counts[0])); \
+		for (i = j->lo; i < j->hi; i++) { \
+			j->counts[0][((j->src[i] ^ j->flip) >> j->shift) & 0xFF]++; \
+		} \
+	} else { \
+		for (i = j->lo; i < j->hi; i++) { \
+			x = j->src[i]; \
+			j->dst[j->offs[((x ^ j->flip) >> j->shift) & 0xFF]++] = x; \
+		} \
+	} \
+	return NULL; \
+} \
+ \
+static void _zsort_radix_##T(T* const a, const size_t n, const T flip, size_t nthreads) { \
+	_zsort_job_##T* jobs; \
+	T* tmp; \
+	T* src; \
+	T* dst; \
+	T* swap; \
+	size_t t, d, b, pos, total, cd; \
+	bool first = 1; \
+	if (n <= ZSORT_NETWORK_MAX) { _zsort_network_##T(a, n, flip); return; } \
+	if (n < ZSORT_RADIX_MIN) { _zsort_insertion_##T(a, n, flip); return; } \
+	if (nthreads > n / ZSORT_MIN_PER_THREAD) { nthreads = n / ZSORT_MIN_PER_THREAD; } \
+	if (nthreads == 0) { nthreads = 1; } \
+	tmp = (T*)malloc(sizeof(T) * n); \
+	jobs = (_zsort_job_##T*)malloc(sizeof(_zsort_job_##T) * nthreads); \
+	runtime_assert((tmp != NULL) && (jobs != NULL), "memory exhaustion"); \
+	for (t = 0; t < nthreads; t++) { \
+		jobs[t].lo = n / nthreads * t; \
+		jobs[t].hi = (t + 1 == nthreads) ? n : n / nthreads * (t + 1); \
+		jobs[t].flip = flip; \
+		jobs[t].src = a; \
+		jobs[t].phase = 0; \
+	} \
+	_zsort_run(_zsort_work_##T, (unsigned char*)jobs, sizeof(_zsort_job_##T), nthreads); \
+	src = a; \
+	dst = tmp; \
+	for (d = 0; d < sizeof(T); d++) { \
+		/* skip the digit if every key has the same value there */ \
+		for (b = 0; b < 256; b++) { \
+			for (t = 0, total = 0; t < nthreads; t++) { total += jobs[t].counts[d][b]; } \
+			if (total != 0) { break; } \
+		} \
+		if (total == n) { continue; } \
+		/* with several blocks, the counts from the first pass are only good \
+		   for the original order; a single block's histogram doesn't depend \
+		   on the order */ \
+		cd = (first || nthreads == 1) ? d : 0; \
+		if (!first && nthreads > 1) { \
+			for (t = 0; t < nthreads; t++) { \
+				jobs[t].src = src; \
+				jobs[t].shift = 8 * d; \
+				jobs[t].phase = 1; \
+			} \
+			_zsort_run(_zsort_work_##T, (unsigned char*)jobs, sizeof(_zsort_job_##T), nthreads); \
+		} \
+		for (b = 0, pos = 0; b < 256; b++) { \
+			for (t = 0; t < nthreads; t++) { \
+				jobs[t].offs[b] = pos; \
+				pos += jobs[t].counts[cd][b]; \
+			} \
+		} \
+		for (t = 0; t < nthreads; t++) { \
+			jobs[t].src = src; \
+			jobs[t].dst = dst; \
+			jobs[t].shift = 8 * d; \
+			jobs[t].phase = 2; \
+		} \
+		_zsort_run(_zsort_work_##T, (unsigned char*)jobs, sizeof(_zsort_job_##T), nthreads); \
+		swap = src; src = dst; dst = swap; \
+		first = 0; \
+	} \
+	if (src != a) { \
+		memcpy(a, src, sizeof(T) * n); \
+	} \
+	free(jobs); \
+	free(tmp); \
+}
+
+_ZSORT_DEFINE(uint8_t)
+_ZSORT_DEFINE(uint16_t)
+_ZSORT_DEFINE(uint32_t)
+_ZSORT_DEFINE(uint64_t)
+
+void zsort_radix(void* const arr, const size_t n, const size_t width, const bool is_signed, const size_t nthreads)
+{
+	runtime_assert((arr != NULL) || (n == 0), "You are required to pass a non-NULL array.");
+	runtime_assert(n <= Z_SIZE_T_MAX / 8, "memory exhaustion");
+	switch (width) {
+	case 1:
+		_zsort_radix_uint8_t((uint8_t*)arr, n, is_signed ? (uint8_t)0x80 : 0, nthreads);
+		break;
+	case 2:
+		_zsort_radix_uint16_t((uint16_t*)arr, n, is_signed ? (uint16_t)0x8000 : 0, nthreads);
+		break;
+	case 4:
+		_zsort_radix_uint32_t((uint32_t*)arr, n, is_signed ? (uint32_t)0x80000000UL : 0, nthreads);
+		break;
+	case 8:
+		_zsort_radix_uint64_t((uint64_t*)arr, n, is_signed ? (uint64_t)0x8000000000000000ULL : 0, nthreads);
+		break;
+	default:
+		runtime_assert(0, "zsort_radix() sorts 1, 2, 4 or 8 byte integers.");
+	}
+}
@@ -0,0 +1,43 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zsort_h
+#define __INCL_zsort_h
+
+#include <stddef.h>
+
+#include "zutil.h"
+
+/**
+ * Sort an array of n integers, each of which is width bytes wide (1, 2, 4 or 
+ * 8), in ascending order.  is_signed says whether to compare them as signed 
+ * (two's complement) or unsigned integers.
+ *
+ * This is an LSD radix sort on 8-bit digits: one pass over the array counts 
+ * every digit of every key, and then each digit which isn't the same in all of 
+ * the keys gets one stable scatter pass into a scratch array of n elements.  
+ * So sorting keys which only use the low 16 bits of a 64-bit integer takes two 
+ * scatter passes, not eight.  It never calls a comparison function and takes 
+ * time proportional to n.
+ *
+ * If nthreads is greater than 1, the counting and scattering are split 
+ * between that many threads (fewer for small arrays), each of which handles a 
+ * contiguous block of the array.  Since the blocks' share of each digit 
+ * changes as the keys move, every scatter pass after the first is then 
+ * preceded by a pass which recounts that digit.  Arrays too short for radix
+ * sort to pay off are sorted with an insertion sort, or, up to 16 elements,
+ * with a branch-free sorting network.
+ */
+void zsort_radix(void* arr, size_t n, size_t width, bool is_signed, size_t nthreads);
+
+#endif /* #ifndef __INCL_zsort_h */
@@ -0,0 +1,366 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "zstrbuf.h"
+
+#include "moreassert.h"
+#include "morelimits.h"
+#include "zint.h"
+
+DEFINE_ZLIST(char, zstrbuf)
+
+/* Make room for n more chars and the terminating NUL, and return where they 
+   go.  Growing goes through resize() so that the capacity grows 
+   geometrically; it is out of line, so that the usual case, when there is 
+   room already, is a compare. */
+static void _zstrbuf_grow(zstrbuf*const b, const size_t n) {
+	const size_t len = b->len;
+	runtime_assert(n < Z_SIZE_T_MAX - len, "memory exhaustion");
+	zstrbuf_resize(b, len + n + 1);
+	b->len = len;
+}
+
+static inline char* _zstrbuf_room(zstrbuf*const b, const size_t n) {
+	if ((b->arr == NULL) || (b->cap - b->len <= n)) {
+		_zstrbuf_grow(b, n);
+	}
+	return b->arr + b->len;
+}
+
+void zstrbuf_append_str(zstrbuf*const b, const char*const s) {
+	size_t n;
+	char* p;
+	runtime_assert((b != NULL) && (s != NULL), "You are required to pass non-NULL pointers.");
+	n = strlen(s);
+	p = _zstrbuf_room(b, n);
+	memcpy(p, s, n + 1);
+	b->len += n;
+}
+
+const char* zstrbuf_cstr(zstrbuf*const b) {
+	runtime_assert(b != NULL, "You are required to pass a non-NULL pointer.");
+	*_zstrbuf_room(b, 0) = '\0';
+	return b->arr;
+}
+
+/* Octal is rare enough to do a digit at a time, backwards from end. */
+static char* _zprintf_oct(char* end, unsigned long long v) {
+	do {
+		*--end = (char)('0' + (v & 7));
+		v >>= 3;
+	} while (v != 0);
+	return end;
+}
+
+typedef struct {
+	bool left;
+	bool zero;
+	bool plus;
+	bool space;
+	bool alt;
+	size_t width;
+	int prec; /* -1 if none was given */
+} _zprintf_spec;
+
+/* Write prefix, then zeros '0's, then body, padded to the width. */
+static void _zprintf_emit(zstrbuf*const b, const _zprintf_spec*const sp, const char*const prefix, const size_t prefixlen, size_t zeros, const char*const body, const size_t bodylen) {
+	size_t total, pad;
+	char* p;
+	runtime_assert(bodylen < Z_SIZE_T_MAX - prefixlen - zeros, "memory exhaustion");
+	total = prefixlen + zeros + bodylen;
+	pad = (sp->width > total) ? (sp->width - total) : 0;
+	p = _zstrbuf_room(b, total + pad);
+	b->len += total + pad;
+	if (sp->zero && !sp->left) {
+		zeros += pad;
+		pad = 0;
+	}
+	if ((pad > 0) && !sp->left) {
+		memset(p, ' ', pad);
+		p += pad;
+	}
+	if (prefixlen > 0) {
+		memcpy(p, prefix, prefixlen);
+		p += prefixlen;
+	}
+	if (zeros > 0) {
+		memset(p, '0', zeros);
+		p += zeros;
+	}
+	memcpy(p, body, bodylen);
+	p += bodylen;
+	if ((pad > 0) && sp->left) {
+		memset(p, ' ', pad);
+		p += pad;
+	}
+	*p = '\0';
+}
+
+/* The integer conversions: the sign or base prefix, the precision's leading 
+   zeros, and then the digits. */
+static void _zprintf_int(zstrbuf*const b, _zprintf_spec*const sp, const char conv, unsigned long long v, const bool neg) {
+	char buf[3 * sizeof(unsigned long long) + 1];
+	const char* digits = buf;
+	const char* prefix = "";
+	size_t prefixlen = 0, ndigits, zeros = 0;
+
+	if ((sp->prec == 0) && (v == 0)) {
+		ndigits = 0;
+	} else if ((conv == 'd') || (conv == 'i') || (conv == 'u')) {
+		ndigits = zint_format_ullong(v, buf);
+	} else if (conv == 'o') {
+		digits = _zprintf_oct(buf + sizeof(buf), v);
+		ndigits = (size_t)(buf + sizeof(buf) - digits);
+	} else {
+		ndigits = zint_format_hex_ullong(v, buf, conv == 'X');
+	}
+	if ((sp->prec >= 0) && ((size_t)sp->prec > ndigits)) {
+		zeros = (size_t)sp->prec - ndigits;
+	}
+	if (neg) {
+		prefix = "-";
+		prefixlen = 1;
+	} else if ((conv == 'd') || (conv == 'i')) {
+		if (sp->plus) {
+			prefix = "+";
+			prefixlen = 1;
+		} else if (sp->space) {
+			prefix = " ";
+			prefixlen = 1;
+		}
+	} else if (sp->alt && (conv == 'o')) {
+		if ((zeros == 0) && ((ndigits == 0) || (digits[0] != '0'))) {
+			zeros = 1;
+		}
+	} else if (sp->alt && (v != 0) && ((conv == 'x') || (conv == 'X') || (conv == 'p'))) {
+		prefix = (conv == 'X') ? "0X" : "0x";
+		prefixlen = 2;
+	}
+	if (sp->prec >= 0) {
+		sp->zero = false;
+	}
+	_zprintf_emit(b, sp, prefix, prefixlen, zeros, digits, ndigits);
+}
+
+/* The floating point conversions are left to snprintf(), with the flags, 
+   width and precision passed along. */
+static void _zprintf_float(zstrbuf*const b, const _zprintf_spec*const sp, const char conv, const bool islong, const double d, const long double ld) {
+	char fmt[12];
+	char* f = fmt;
+	char* p;
+	size_t room;
+	int n;
+	runtime_assert(sp->width <= INT_MAX, "zprintf(): the width is too big.");
+	*f++ = '%';
+	if (sp->left) { *f++ = '-'; }
+	if (sp->zero) { *f++ = '0'; }
+	if (sp->plus) { *f++ = '+'; }
+	if (sp->space) { *f++ = ' '; }
+	if (sp->alt) { *f++ = '#'; }
+	*f++ = '*';
+	*f++ = '.';
+	*f++ = '*';
+	if (islong) { *f++ = 'L'; }
+	*f++ = conv;
+	*f = '\0';
+	p = _zstrbuf_room(b, 32);
+	room = b->cap - b->len;
+	n = islong ? snprintf(p, room, fmt, (int)sp->width, sp->prec, ld) : snprintf(p, room, fmt, (int)sp->width, sp->prec, d);
+	runtime_assert(n >= 0, "zprintf(): snprintf() failed.");
+	if ((size_t)n >= room) {
+		p = _zstrbuf_room(b, (size_t)n);
+		room = b->cap - b->len;
+		n = islong ? snprintf(p, room, fmt, (int)sp->width, sp->prec, ld) : snprintf(p, room, fmt, (int)sp->width, sp->prec, d);
+	}
+	b->len += (size_t)n;
+}
+
+size_t zprintf(zstrbuf*const b, const char*const fmt, ...) {
+	va_list ap;
+	size_t n;
+	va_start(ap, fmt);
+	n = zvprintf(b, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+size_t zvprintf(zstrbuf*const b, const char*const fmt, va_list ap) {
+	const char* f = fmt;
+	const char* pct;
+	const char* s;
+	_zprintf_spec sp;
+	size_t start, n;
+	unsigned long long u;
+	long long i;
+	char length, c;
+	int w;
+	char* p;
+
+	runtime_assert((b != NULL) && (fmt != NULL), "You are required to pass non-NULL pointers.");
+	start = b->len;
+	*_zstrbuf_room(b, 0) = '\0';
+	for (;;) {
+		/* Format strings are short, so one pass looking for both is faster 
+		   than strchr() and then strlen(). */
+		for (pct = f; (*pct != '%') && (*pct != '\0'); pct++) { }
+		n = (size_t)(pct - f);
+		if (n > 0) {
+			p = _zstrbuf_room(b, n);
+			memcpy(p, f, n);
+			p[n] = '\0';
+			b->len += n;
+		}
+		if (*pct == '\0') {
+			return b->len - start;
+		}
+		f = pct + 1;
+
+		sp.left = sp.zero = sp.plus = sp.space = sp.alt = false;
+		sp.width = 0;
+		sp.prec = -1;
+		for (;; f++) {
+			if (*f == '-') { sp.left = true; }
+			else if (*f == '0') { sp.zero = true; }
+			else if (*f == '+') { sp.plus = true; }
+			else if (*f == ' ') { sp.space = true; }
+			else if (*f == '#') { sp.alt = true; }
+			else { break; }
+		}
+		if (*f == '*') {
+			w = va_arg(ap, int);
+			if (w < 0) {
+				sp.left = true;
+				sp.width = (size_t)0 - (size_t)w;
+			} else {
+				sp.width = (size_t)w;
+			}
+			f++;
+		} else {
+			while ((*f >= '0') && (*f <= '9')) {
+				runtime_assert(sp.width < INT_MAX / 10, "zprintf(): the width is too big.");
+				sp.width = sp.width * 10 + (size_t)(*f++ - '0');
+			}
+		}
+		if (*f == '.') {
+			f++;
+			if (*f == '*') {
+				w = va_arg(ap, int);
+				sp.prec = (w < 0) ? -1 : w;
+				f++;
+			} else {
+				sp.prec = 0;
+				while ((*f >= '0') && (*f <= '9')) {
+					runtime_assert(sp.prec < INT_MAX / 10, "zprintf(): the precision is too big.");
+					sp.prec = sp.prec * 10 + (*f++ - '0');
+				}
+			}
+		}
+		/* 'H' is hh, 'q' is ll */
+		length = '\0';
+		if ((f[0] == 'h') && (f[1] == 'h')) { length = 'H'; f += 2; }
+		else if ((f[0] == 'l') && (f[1] == 'l')) { length = 'q'; f += 2; }
+		else if ((*f == 'h') || (*f == 'l') || (*f == 'z') || (*f == 'j') || (*f == 't') || (*f == 'L')) { length = *f++; }
+
+		c = *f++;
+		switch (c) {
+		case 'd':
+		case 'i':
+			switch (length) {
+			case 'H': i = (signed char)va_arg(ap, int); break;
+			case 'h': i = (short)va_arg(ap, int); break;
+			case 'l': i = va_arg(ap, long); break;
+			case 'q': i = va_arg(ap, long long); break;
+			case 'z': i = va_arg(ap, ptrdiff_t); break;
+			case 'j': i = (long long)va_arg(ap, intmax_t); break;
+			case 't': i = va_arg(ap, ptrdiff_t); break;
+			default: i = va_arg(ap, int); break;
+			}
+			u = (i < 0) ? (0ULL - (unsigned long long)i) : (unsigned long long)i;
+			_zprintf_int(b, &sp, c, u, i < 0);
+			break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			switch (length) {
+			case 'H': u = (unsigned char)va_arg(ap, unsigned); break;
+			case 'h': u = (unsigned short)va_arg(ap, unsigned); break;
+			case 'l': u = va_arg(ap, unsigned long); break;
+			case 'q': u = va_arg(ap, unsigned long long); break;
+			case 'z': u = va_arg(ap, size_t); break;
+			case 'j': u = (unsigned long long)va_arg(ap, uintmax_t); break;
+			case 't': u = (unsigned long long)(size_t)va_arg(ap, ptrdiff_t); break;
+			default: u = va_arg(ap, unsigned); break;
+			}
+			_zprintf_int(b, &sp, c, u, false);
+			break;
+		case 'p':
+			u = (unsigned long long)(uintptr_t)va_arg(ap, void*);
+			if (u == 0) {
+				sp.zero = false;
+				_zprintf_emit(b, &sp, "", 0, 0, "(nil)", 5);
+			} else {
+				sp.alt = true;
+				_zprintf_int(b, &sp, c, u, false);
+			}
+			break;
+		case 'c':
+			runtime_assert(length == '\0', "zprintf() doesn't do wide characters.");
+			c = (char)va_arg(ap, int);
+			sp.zero = false;
+			_zprintf_emit(b, &sp, "", 0, 0, &c, 1);
+			break;
+		case 's':
+			runtime_assert(length == '\0', "zprintf() doesn't do wide characters.");
+			s = va_arg(ap, const char*);
+			if (s == NULL) {
+				s = "(null)";
+			}
+			if (sp.prec >= 0) {
+				const char*const nul = (const char*)memchr(s, '\0', (size_t)sp.prec);
+				n = (nul == NULL) ? (size_t)sp.prec : (size_t)(nul - s);
+			} else {
+				n = strlen(s);
+			}
+			sp.zero = false;
+			_zprintf_emit(b, &sp, "", 0, 0, s, n);
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (length == 'L') {
+				_zprintf_float(b, &sp, c, true, 0.0, va_arg(ap, long double));
+			} else {
+				_zprintf_float(b, &sp, c, false, va_arg(ap, double), 0.0L);
+			}
+			break;
+		case '%':
+			p = _zstrbuf_room(b, 1);
+			p[0] = '%';
+			p[1] = '\0';
+			b->len++;
+			break;
+		default:
+			verbose_abort2("zprintf() doesn't understand this format: ", fmt);
+		}
+	}
+}
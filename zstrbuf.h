@@ -0,0 +1,73 @@
+/**
+ * copyright 2004 Bryce "Zooko" Wilcox-O'Hearn
+ * mailto:zooko@zooko.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software to deal in this software without restriction (including the
+ * rights to use, modify, distribute, sublicense, and/or sell copies) provided
+ * that the above copyright notice and this permission notice is included in
+ * all copies or substantial portions of this software. THIS SOFTWARE IS
+ * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
+ */
+
+
+#ifndef __INCL_zstrbuf_h
+#define __INCL_zstrbuf_h
+
+#include <stdarg.h>
+#include <stddef.h>
+
+#include "zlist.h"
+
+/**
+ * A zstrbuf is a growable string, for building log lines, text protocol 
+ * messages and the like without guessing at the size of a fixed buffer.  It 
+ * is a zlist of char (see zlist.h), so b.len, b.arr, and the zlist functions 
+ * -- zstrbuf_append() for one char, zstrbuf_extend() for several, 
+ * zstrbuf_clear(), zstrbuf_reserve(), zstrbuf_free() -- work on it as on 
+ * any list.  Initialize one with ZLIST_INITIALIZER.  clear() keeps the 
+ * memory, so a zstrbuf which is reused for one message after another stops 
+ * allocating once it has grown to fit the biggest of them.
+ *
+ * The functions below keep the chars NUL-terminated (at b.arr[b.len], not 
+ * counted in b.len); the zlist functions don't, so use zstrbuf_cstr() after 
+ * those.
+ */
+DECLARE_ZLIST(char, zstrbuf)
+
+/**
+ * Append the NUL-terminated string s.
+ */
+void zstrbuf_append_str(zstrbuf* b, const char* s);
+
+/**
+ * Returns b's chars as a NUL-terminated string, which is good until b is 
+ * next changed.
+ */
+const char* zstrbuf_cstr(zstrbuf* b);
+
+#ifdef __GNUC__
+#define _ZSTRBUF_PRINTF(f, a) __attribute__((format(printf, f, a)))
+#else
+#define _ZSTRBUF_PRINTF(f, a)
+#endif
+
+/**
+ * zprintf() is printf() which appends to a zstrbuf, growing it as needed 
+ * rather than truncating, and returns the number of chars appended.  It is 
+ * faster than snprintf() because it does less: it looks at no locale, takes 
+ * no stdio lock, and converts integers with the zint functions (see 
+ * zint.h).  It doesn't allocate, other than to grow b.
+ *
+ * It takes the conversions d i u o x X c s p %, the flags - + space # 0, 
+ * widths and precisions (including *), and the length modifiers hh h l ll z 
+ * j t, and gives the same output as glibc.  The floating point conversions 
+ * (f F e E g G a A, with or without L) are handed to snprintf(), so they are 
+ * no faster than it and do follow the locale's decimal point.  Wide 
+ * characters and %n aren't supported; they, and anything else it doesn't 
+ * understand, fail a runtime_assert.
+ */
+size_t zprintf(zstrbuf* b, const char* fmt, ...) _ZSTRBUF_PRINTF(2, 3);
+size_t zvprintf(zstrbuf* b, const char* fmt, va_list ap);
+
+#endif /* #ifndef __INCL_zstrbuf_h */
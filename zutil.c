@@ -10,11 +10,19 @@
  * PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.
  */
 
+#include <pthread.h>
+#include <string.h>
+
 #include "zutil.h"
 
 #include "moreassert.h"
 #include "morelimits.h"
 
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#define _ZCRC32C_HW 1
+#include <nmmintrin.h>
+#endif
+
 #undef uint32_decode
 unsigned long uint32_decode(const zbyte* const bs)
 {
@@ -63,6 +71,60 @@ void uint64_encode(const unsigned long long llu, zbyte* const bs)
 	bs[0] = (llu / (1LLU << 56)) % (1U << 8);
 }
 
+#ifndef _ZCRC32C_HW
+/* _zcrc32c_table[k][b] is the CRC of byte b followed by k zero bytes, so that 
+   eight bytes can be folded in with eight independent lookups. */
+static unsigned long _zcrc32c_table[8][256];
+static pthread_once_t _zcrc32c_once = PTHREAD_ONCE_INIT;
+
+static void _zcrc32c_init(void)
+{
+	unsigned long c;
+	unsigned b, k;
+	for (b = 0; b < 256; b++) {
+		c = b;
+		for (k = 0; k < 8; k++) {
+			c = (c & 1) ? ((c >> 1) ^ 0x82f63b78UL) : (c >> 1);
+		}
+		_zcrc32c_table[0][b] = c;
+	}
+	for (b = 0; b < 256; b++) {
+		for (k = 1; k < 8; k++) {
+			c = _zcrc32c_table[k-1][b];
+			_zcrc32c_table[k][b] = (c >> 8) ^ _zcrc32c_table[0][c & 0xff];
+		}
+	}
+}
+#endif
+
+unsigned long zcrc32c(const unsigned long crc, const void* const p, size_t len)
+{
+	const zbyte* bs = (const zbyte*)p;
+	unsigned long long c = (~crc) & 0xffffffffUL;
+	unsigned long long w;
+	runtime_assert((p != NULL) || (len == 0), "You are required to pass a non-NULL pointer.");
+#ifdef _ZCRC32C_HW
+	for (; len >= 8; len -= 8, bs += 8) {
+		memcpy(&w, bs, 8);
+		c = _mm_crc32_u64(c, w);
+	}
+	for (; len > 0; len--, bs++) {
+		c = _mm_crc32_u8((unsigned)c, *bs);
+	}
+#else
+	pthread_once(&_zcrc32c_once, _zcrc32c_init);
+	for (; len >= 8; len -= 8, bs += 8) {
+		/* bytes in little-endian order whatever the machine's */
+		w = c ^ ((unsigned long long)bs[0] | ((unsigned long long)bs[1] << 8) | ((unsigned long long)bs[2] << 16) | ((unsigned long long)bs[3] << 24));
+		c = _zcrc32c_table[7][w & 0xff] ^ _zcrc32c_table[6][(w >> 8) & 0xff] ^ _zcrc32c_table[5][(w >> 16) & 0xff] ^ _zcrc32c_table[4][(w >> 24) & 0xff] ^ _zcrc32c_table[3][bs[4]] ^ _zcrc32c_table[2][bs[5]] ^ _zcrc32c_table[1][bs[6]] ^ _zcrc32c_table[0][bs[7]];
+	}
+	for (; len > 0; len--, bs++) {
+		c = (c >> 8) ^ _zcrc32c_table[0][(c ^ *bs) & 0xff];
+	}
+#endif
+	return (unsigned long)(~c & 0xffffffffUL);
+}
+
 #undef divceil
 unsigned int divceil(unsigned int n, unsigned int d)
 {
@@ -87,6 +149,16 @@ unsigned long LDIVCEIL(unsigned long n, unsigned long d)
 	return n/d+((n%d)!=0);
 }
 
+size_t pow2ceil(const size_t n)
+{
+	size_t c = 1;
+	while (c < n) {
+		runtime_assert(c <= Z_SIZE_T_MAX / 2, "memory exhaustion");
+		c *= 2;
+	}
+	return c;
+}
+
 #undef add_would_overflow_char
 int add_would_overflow_char(char x, char y) {
 	return MACRO_ADD_WOULD_OVERFLOW_CHAR(x, y);
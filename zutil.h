@@ -74,6 +74,14 @@ void uint32_encode(unsigned long lu, zbyte* bs);
  */
 void uint64_encode(unsigned long long llu, zbyte* bs);
 
+/**
+ * Returns the CRC-32C (Castagnoli) checksum of the len bytes at p, continuing 
+ * from crc, which is 0 to start with; so zcrc32c(zcrc32c(0, a, n), b, m) is 
+ * the checksum of a followed by b.  Uses the SSE4.2 crc32 instruction when 
+ * compiled for it, and otherwise tables, eight bytes at a time.
+ */
+unsigned long zcrc32c(unsigned long crc, const void* p, size_t len);
+
 /*
 Returns ceil(x/y): the smallest integer which is greater than or equal to x/y.
 
@@ -90,6 +98,12 @@ unsigned long ldivceil(unsigned long n, unsigned long d);
 unsigned int DIVCEIL(unsigned int n, unsigned int d);
 unsigned long LDIVCEIL(unsigned long n, unsigned long d);
 
+/*
+Returns the smallest power of two which is >= n (and >= 1).  Aborts with 
+"memory exhaustion" if that doesn't fit in a size_t.
+*/
+size_t pow2ceil(size_t n);
+
 /*
 Returns true iff the value (x+y) cannot be stored in a char.
  */